@@ -84,7 +84,7 @@ private:
         std::stringstream ss;
         ss << "[" << name_ << "] "
            << levelToString(msg.level) << " "
-           << msg.message;
+           << msg.getMessage();
         return ss.str();
     }
 };
@@ -108,12 +108,12 @@ public:
         if (formatter_) {
             // 使用自定义格式化函数
             LogMessage enhancedMsg = msg;
-            enhancedMsg.message = prefix_ + formatter_(msg);
+            enhancedMsg.setMessage(prefix_ + formatter_(msg));
             wrapped_->write(enhancedMsg);
         } else {
             // 使用默认格式化
             LogMessage enhancedMsg = msg;
-            enhancedMsg.message = prefix_ + msg.message;
+            enhancedMsg.setMessage(prefix_ + msg.getMessage());
             wrapped_->write(enhancedMsg);
         }
     }
@@ -156,7 +156,7 @@ void customDecoratorExample() {
         std::move(baseOutput),
         "[CUSTOM] ",
         [](const LogMessage& msg) -> std::string {
-            return "[" + levelToString(msg.level) + "] " + msg.message + " (自定义格式化)";
+            return "[" + levelToString(msg.level) + "] " + msg.getMessage() + " (自定义格式化)";
         }
     );
     
@@ -42,7 +42,7 @@ void basicDecoratorExample() {
     
     // 测试装饰器链
     LogMessage msg(LogLevel::INFO, "这是一条测试消息");
-    std::cout << "\n原始消息: " << msg.message << std::endl;
+    std::cout << "\n原始消息: " << msg.getMessage() << std::endl;
     
     std::cout << "\n通过装饰器链输出:" << std::endl;
     colorDecorator->write(msg);
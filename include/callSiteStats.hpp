@@ -0,0 +1,237 @@
+/**
+ * @file callSiteStats.hpp
+ * @brief 调用点输出统计
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 按调用点（文件:行号）统计已入队的消息条数、字节数和丢弃条数，用于定位刷屏的日志语句。
+ *          计数写入各线程私有的计数块，只有拥有者线程写、不需要原子读改写；
+ *          读取时把所有线程的计数块与已退出线程的汇总相加
+ * @see LogCallSite, LogManager
+ * @since 1.1.0
+ */
+
+#pragma once
+
+#include "logTypes.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace async_log {
+
+/**
+ * @brief 调用点统计表
+ * @details 每个LogCallSite在构造时登记一次，得到一个稠密下标；同一文件、行号和函数的调用点共用一个下标。
+ *          统计中的丢弃包括因内存预算或队列已满而丢弃的消息，以及被调用点限流抑制的消息（在输出抑制汇总行时计入）。
+ *          只有携带调用点的日志宏（如LOG_INFO_FUNC、LOG_INFO_IF、LOG_FIRST_N）参与统计
+ * @note 此实现是线程安全的，全局唯一实例永不析构，保证线程退出时仍可归并计数
+ * @since 1.1.0
+ */
+class CallSiteStats {
+public:
+    static constexpr size_t CHUNK_SIZE = 256;     ///< 每块容纳的调用点数量
+    static constexpr size_t MAX_CHUNKS = 256;     ///< 最大块数量，即最多65536个调用点
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;  ///< 统计表已满时分配的下标，记录时被忽略
+
+    /**
+     * @brief 一个调用点的统计快照
+     * @since 1.1.0
+     */
+    struct Entry {
+        uint32_t index = INVALID_INDEX;   ///< 调用点下标
+        StringId fileId = 0;              ///< 驻留的源文件名ID
+        StringId functionId = 0;          ///< 驻留的函数名ID
+        int line = 0;                     ///< 源文件行号
+        uint64_t messages = 0;            ///< 已入队的消息条数
+        uint64_t bytes = 0;               ///< 已入队的消息文本字节数
+        uint64_t drops = 0;               ///< 丢弃或被限流抑制的消息条数
+
+        /**
+         * @brief 获取"文件:行号"形式的位置
+         * @return 调用点位置
+         * @since 1.1.0
+         */
+        std::string location() const;
+    };
+
+private:
+    /**
+     * @brief 一个调用点在一个线程中的计数
+     * @details 只由拥有者线程以load+store方式递增，读取方用relaxed加载，计数不会撕裂
+     * @since 1.1.0
+     */
+    struct Counters {
+        std::atomic<uint64_t> messages{0};   ///< 消息条数
+        std::atomic<uint64_t> bytes{0};      ///< 字节数
+        std::atomic<uint64_t> drops{0};      ///< 丢弃条数
+    };
+
+    /**
+     * @brief 一个线程的计数块
+     * @since 1.1.0
+     */
+    struct ThreadCounters {
+        std::array<std::atomic<Counters*>, MAX_CHUNKS> chunks{};   ///< 按需分配的计数分块
+    };
+
+    /**
+     * @brief 调用点的身份信息
+     * @since 1.1.0
+     */
+    struct Site {
+        StringId fileId;       ///< 驻留的源文件名ID
+        StringId functionId;   ///< 驻留的函数名ID
+        int line;              ///< 源文件行号
+    };
+
+    struct ThreadHolder;   ///< 线程局部计数块的持有者，线程退出时归并计数
+
+    std::vector<Site> sites_;                                     ///< 已登记的调用点，按下标存放
+    std::map<std::tuple<StringId, int, StringId>, uint32_t> index_;   ///< 调用点到下标的索引
+    std::vector<ThreadCounters*> threads_;                        ///< 存活线程的计数块
+    std::vector<Entry> retired_;                                  ///< 已退出线程的计数汇总，按下标存放
+    mutable std::mutex mutex_;                                    ///< 保护以上所有成员
+
+public:
+    /**
+     * @brief 获取全局统计表实例
+     * @return 统计表引用
+     * @note 此函数是线程安全的
+     * @since 1.1.0
+     */
+    static CallSiteStats& getInstance();
+
+    /**
+     * @brief 构造函数
+     * @since 1.1.0
+     */
+    CallSiteStats() = default;
+
+    // 禁用拷贝构造和赋值
+    CallSiteStats(const CallSiteStats&) = delete;
+    CallSiteStats& operator=(const CallSiteStats&) = delete;
+
+    /**
+     * @brief 登记调用点
+     * @param[in] fileId 驻留的源文件名ID
+     * @param[in] line 源文件行号
+     * @param[in] functionId 驻留的函数名ID
+     * @return 调用点下标，统计表已满时返回INVALID_INDEX
+     * @note 此操作是线程安全的，同一调用点总是得到同一个下标
+     * @since 1.1.0
+     */
+    uint32_t registerSite(StringId fileId, int line, StringId functionId);
+
+    /**
+     * @brief 记录一条已入队的消息
+     * @param[in] index 调用点下标
+     * @param[in] bytes 消息文本字节数
+     * @note 只写当前线程的计数块，不需要加锁
+     * @since 1.1.0
+     */
+    void recordEmitted(uint32_t index, size_t bytes);
+
+    /**
+     * @brief 记录丢弃的消息
+     * @param[in] index 调用点下标
+     * @param[in] count 丢弃条数
+     * @note 只写当前线程的计数块，不需要加锁
+     * @since 1.1.0
+     */
+    void recordDropped(uint32_t index, uint64_t count = 1);
+
+    /**
+     * @brief 获取所有调用点的累计统计
+     * @return 按下标排列的统计，下标与Entry::index一致
+     * @note 此操作是线程安全的，正在递增的计数可能稍有滞后
+     * @since 1.1.0
+     */
+    std::vector<Entry> snapshot() const;
+
+    /**
+     * @brief 获取累计字节数最多的调用点
+     * @param[in] count 最多返回的数量
+     * @return 按字节数、消息条数降序排列的统计，不含没有任何计数的调用点
+     * @since 1.1.0
+     */
+    std::vector<Entry> topTalkers(size_t count) const;
+
+    /**
+     * @brief 计算两次快照之间的增量
+     * @param[in] current 较新的快照
+     * @param[in] previous 较早的快照，可以比current短
+     * @return 按下标排列的增量
+     * @since 1.1.0
+     */
+    static std::vector<Entry> delta(const std::vector<Entry>& current, const std::vector<Entry>& previous);
+
+    /**
+     * @brief 从统计中选出字节数最多的调用点
+     * @param[in] entries 统计或增量
+     * @param[in] count 最多返回的数量
+     * @return 按字节数、消息条数降序排列的统计，不含没有任何计数的调用点
+     * @since 1.1.0
+     */
+    static std::vector<Entry> top(std::vector<Entry> entries, size_t count);
+
+    /**
+     * @brief 获取已登记的调用点数量
+     * @return 调用点数量
+     * @since 1.1.0
+     */
+    size_t getSiteCount() const;
+
+    /**
+     * @brief 在fork前锁住统计表
+     * @details 保证fork时没有其他线程正在登记调用点或线程，子进程中的统计表处于一致状态
+     * @see unlockAfterFork
+     * @since 1.1.0
+     */
+    void lockForFork();
+
+    /**
+     * @brief 释放lockForFork()持有的锁
+     * @note 在父进程和子进程中都由调用fork的线程调用
+     * @since 1.1.0
+     */
+    void unlockAfterFork();
+
+private:
+    /**
+     * @brief 获取当前线程中某个调用点的计数
+     * @param[in] index 调用点下标
+     * @return 计数，下标无效时返回nullptr
+     * @since 1.1.0
+     */
+    Counters* localCounters(uint32_t index);
+
+    /**
+     * @brief 登记一个线程的计数块
+     * @param[in] counters 计数块
+     * @since 1.1.0
+     */
+    void attachThread(ThreadCounters* counters);
+
+    /**
+     * @brief 把退出线程的计数并入汇总并释放计数块
+     * @param[in] counters 计数块
+     * @since 1.1.0
+     */
+    void retireThread(ThreadCounters* counters);
+
+    /**
+     * @brief 把一个计数块累加到按下标排列的统计中
+     * @param[in] counters 计数块
+     * @param[in,out] entries 统计
+     * @since 1.1.0
+     */
+    static void accumulate(const ThreadCounters& counters, std::vector<Entry>& entries);
+};
+
+} // namespace async_log
@@ -0,0 +1,116 @@
+/**
+ * @file errorBacklog.hpp
+ * @brief 错误回溯缓存
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 每个线程把低级别日志暂存在一个有界环形缓存中，只有该线程记录错误时才把缓存的日志
+ *          按原顺序写在错误之前，否则被新日志覆盖后静默丢弃。这样既能在故障时看到完整的调试上下文，
+ *          平时又只有WARN级别的I/O开销
+ * @see LogManager, LogConfig::errorBacklogSize
+ * @since 1.1.0
+ */
+
+#pragma once
+
+#include "logTypes.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace async_log {
+
+/**
+ * @brief 错误回溯环形缓存
+ * @details 槽位在容量确定后一次性分配，之后写入只是对已有消息重新赋值，字符串复用上一轮的容量
+ * @note 此类不是线程安全的，每个线程持有自己的实例
+ * @since 1.1.0
+ */
+class ErrorBacklog {
+private:
+    std::vector<LogMessage> slots_;   ///< 消息槽位
+    size_t head_;                     ///< 下一次写入的槽位
+    size_t count_;                    ///< 当前缓存的消息数量
+    uint64_t overwritten_;            ///< 被新消息覆盖而丢弃的消息总数
+
+public:
+    /**
+     * @brief 构造函数
+     * @since 1.1.0
+     */
+    ErrorBacklog();
+
+    /**
+     * @brief 设置容量
+     * @details 容量变化时丢弃已缓存的消息
+     * @param[in] capacity 最多缓存的消息数量，0表示不缓存
+     * @since 1.1.0
+     */
+    void setCapacity(size_t capacity);
+
+    /**
+     * @brief 获取容量
+     * @return 最多缓存的消息数量
+     * @since 1.1.0
+     */
+    size_t getCapacity() const;
+
+    /**
+     * @brief 获取当前缓存的消息数量
+     * @return 消息数量
+     * @since 1.1.0
+     */
+    size_t size() const;
+
+    /**
+     * @brief 获取被覆盖而丢弃的消息总数
+     * @return 丢弃的消息数量
+     * @since 1.1.0
+     */
+    uint64_t getOverwrittenCount() const;
+
+    /**
+     * @brief 缓存一条消息
+     * @details 缓存已满时覆盖最早的消息
+     * @param[in] fill 填充回调，必须完整覆盖消息的所有字段
+     * @since 1.1.0
+     */
+    template<typename Fill>
+    void push(Fill&& fill) {
+        if (slots_.empty()) {
+            return;
+        }
+
+        fill(slots_[head_]);
+        head_ = (head_ + 1) % slots_.size();
+
+        if (count_ < slots_.size()) {
+            count_++;
+        } else {
+            overwritten_++;
+        }
+    }
+
+    /**
+     * @brief 按写入顺序取出所有缓存的消息
+     * @param[in] visit 对每条消息调用的回调，参数为消息的引用
+     * @since 1.1.0
+     */
+    template<typename Visit>
+    void drain(Visit&& visit) {
+        size_t capacity = slots_.size();
+        size_t index = (head_ + capacity - count_) % (capacity == 0 ? 1 : capacity);
+
+        for (; count_ > 0; --count_) {
+            visit(slots_[index]);
+            index = (index + 1) % capacity;
+        }
+    }
+
+    /**
+     * @brief 丢弃所有缓存的消息
+     * @since 1.1.0
+     */
+    void clear();
+};
+
+} // namespace async_log
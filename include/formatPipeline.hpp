@@ -0,0 +1,215 @@
+/**
+ * @file formatPipeline.hpp
+ * @brief 并行格式化流水线
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 把日志的格式化与写出拆成两级：消费者把消息按批次编号后交给格式化线程池并行格式化，
+ *          格式化完成的批次进入重排缓冲，由唯一的提交者严格按批次编号写出。
+ *          格式化开销较大（装饰器、上下文展开）而输出较快时，单个工作线程不再是瓶颈，输出顺序保持不变
+ * @see LogDispatcher, LogConfig::formatThreads
+ * @since 1.1.0
+ */
+
+#pragma once
+
+#include "logTypes.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace async_log {
+
+class MemoryBudget;
+
+/**
+ * @brief 格式化批次
+ * @details 消息槽位和文本缓冲区在批次回收后复用，预热后不再产生分配；两者都从创建批次时的内存资源分配
+ * @since 1.1.0
+ */
+struct FormatBatch {
+    uint64_t sequence = 0;                  ///< 批次编号，决定写出顺序
+    size_t count = 0;                       ///< 有效消息数量
+    std::pmr::vector<LogMessage> messages;  ///< 消息槽位，前count个有效
+    std::vector<size_t> targets;            ///< 所有消息的目标输出下标，按消息顺序首尾相接
+    std::vector<size_t> targetEnds;         ///< 每条消息的目标下标在targets中的结束位置
+    std::pmr::vector<std::pmr::string> texts;   ///< 按输出下标存放的格式化文本，与槽位使用同一个内存资源
+    std::vector<uint8_t> fallback;          ///< 按输出下标标记不支持预格式化、需逐条write()的输出
+    size_t charged = 0;                     ///< 已登记到内存预算的字节数，写出后归还
+
+    /**
+     * @brief 构造函数
+     * @param[in] resource 消息槽位和格式化文本的内存来源
+     * @since 1.1.0
+     */
+    explicit FormatBatch(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    /**
+     * @brief 清空批次以便复用
+     * @details 只重置计数，保留消息和文本的容量
+     * @since 1.1.0
+     */
+    void clear();
+};
+
+/**
+ * @brief 并行格式化流水线
+ * @details 线程数为0时流水线关闭，append()返回false，调用者按原来的方式串行写出。
+ *          同一时刻只有一个提交者，提交者写完一个批次后继续写出重排缓冲中紧随其后的批次，
+ *          因此输出看到的顺序与批次编号一致
+ * @note 此实现是线程安全的
+ * @since 1.1.0
+ */
+class FormatPipeline {
+public:
+    using Stage = std::function<void(FormatBatch&)>;   ///< 处理一个批次的回调
+
+    static constexpr size_t BATCH_LIMIT = 512;         ///< 单个批次最多容纳的消息数量，满后自动提交
+    static constexpr size_t IN_FLIGHT_PER_THREAD = 4;  ///< 每个格式化线程允许的在途批次数量，超过后提交方等待
+
+private:
+    Stage format_;                                  ///< 格式化阶段，在格式化线程中并行调用
+    Stage commit_;                                  ///< 写出阶段，同一时刻只在一个线程中调用
+
+    std::unique_ptr<FormatBatch> open_;             ///< 正在填充的批次
+    bool enabled_;                                  ///< 是否接收消息
+    std::vector<std::thread> threads_;              ///< 格式化线程
+    mutable std::mutex stageMutex_;                 ///< 保护以上三个成员，调整线程数时一直持有
+
+    std::deque<std::unique_ptr<FormatBatch>> queue_;            ///< 等待格式化的批次
+    std::map<uint64_t, std::unique_ptr<FormatBatch>> ready_;    ///< 重排缓冲：已格式化、等待按编号写出的批次
+    std::vector<std::unique_ptr<FormatBatch>> freeList_;        ///< 已写出、可复用的批次
+    uint64_t nextSubmit_;                           ///< 下一个提交的批次编号
+    uint64_t nextCommit_;                           ///< 下一个写出的批次编号
+    bool committing_;                               ///< 是否有线程正在写出
+    bool stopping_;                                 ///< 格式化线程是否应退出
+    size_t maxInFlight_;                            ///< 允许的在途批次数量
+    std::atomic<MemoryBudget*> budget_;             ///< 登记在途批次内存的预算，为空表示不登记
+    std::atomic<std::pmr::memory_resource*> resource_;  ///< 新批次的内存来源
+    mutable std::mutex mutex_;                      ///< 保护队列、重排缓冲和编号
+    std::condition_variable workCondition_;         ///< 有批次等待格式化
+    std::condition_variable doneCondition_;         ///< 有批次写出完成
+
+public:
+    /**
+     * @brief 构造函数
+     * @details 构造后流水线处于关闭状态
+     * @param[in] format 格式化阶段，可能在多个线程中同时调用；抛出异常时该批次所有输出改为逐条写出
+     * @param[in] commit 写出阶段，按批次编号依次调用
+     * @since 1.1.0
+     */
+    FormatPipeline(Stage format, Stage commit);
+
+    /**
+     * @brief 析构函数
+     * @details 写出所有已接收的消息后停止格式化线程
+     * @since 1.1.0
+     */
+    ~FormatPipeline();
+
+    // 禁用拷贝构造和赋值
+    FormatPipeline(const FormatPipeline&) = delete;
+    FormatPipeline& operator=(const FormatPipeline&) = delete;
+
+    /**
+     * @brief 设置格式化线程数
+     * @details 先写出所有已接收的消息再调整线程。调整期间append()会等待，
+     *          因此关闭后串行写出的消息不会越过流水线中尚未写出的消息
+     * @param[in] threads 线程数，0表示关闭流水线
+     * @since 1.1.0
+     */
+    void setThreadCount(size_t threads);
+
+    /**
+     * @brief 获取格式化线程数
+     * @return 线程数，0表示流水线已关闭
+     * @since 1.1.0
+     */
+    size_t getThreadCount() const;
+
+    /**
+     * @brief 设置登记在途批次内存的预算
+     * @details 消息复制进批次时登记其大小，格式化完成后再登记格式化文本的大小，批次写出后一并归还。
+     *          登记不会失败，超出上限时由生产者一侧的溢出策略处理
+     * @param[in] budget 内存预算，nullptr表示不登记；必须比流水线存活更久
+     * @since 1.1.0
+     */
+    void setMemoryBudget(MemoryBudget* budget);
+
+    /**
+     * @brief 设置批次的内存来源
+     * @details 只影响此后创建的批次；来源不同的空闲批次在下次取用时释放，不再复用
+     * @param[in] resource 内存资源，必须是线程安全的资源，并且比流水线存活更久
+     * @since 1.1.0
+     */
+    void setMemoryResource(std::pmr::memory_resource* resource);
+
+    /**
+     * @brief 把一条消息加入当前批次
+     * @param[in] msg 日志消息，会被复制
+     * @param[in] targets 消息的目标输出下标
+     * @return true表示已接收，false表示流水线已关闭，调用者应自行写出
+     * @since 1.1.0
+     */
+    bool append(const LogMessage& msg, const std::vector<size_t>& targets);
+
+    /**
+     * @brief 把当前批次交给格式化线程
+     * @details 在途批次过多时等待，为消费者提供背压
+     * @since 1.1.0
+     */
+    void submit();
+
+    /**
+     * @brief 提交当前批次并等待所有已接收的消息写出
+     * @since 1.1.0
+     */
+    void drain();
+
+    /**
+     * @brief 在fork前锁住流水线
+     * @details 调用前应先drain()，保证格式化线程都在等待新批次
+     * @see unlockAfterFork
+     * @since 1.1.0
+     */
+    void lockForFork();
+
+    /**
+     * @brief 释放lockForFork()持有的锁
+     * @note 子进程中没有格式化线程，解锁后应丢弃此对象（不析构）并重新创建
+     * @since 1.1.0
+     */
+    void unlockAfterFork();
+
+private:
+    /**
+     * @brief 提交当前批次
+     * @note 调用者必须持有stageMutex_
+     * @since 1.1.0
+     */
+    void submitLocked();
+
+    /**
+     * @brief 等待所有已提交的批次写出
+     * @since 1.1.0
+     */
+    void waitIdle();
+
+    /**
+     * @brief 格式化线程主循环
+     * @details 取出批次格式化后放入重排缓冲；没有其他提交者时，依次写出编号连续的批次
+     * @since 1.1.0
+     */
+    void formatterLoop();
+};
+
+} // namespace async_log
@@ -4,7 +4,10 @@
  * @author Gamma
  * @date 2025-08-25 11:25:00
  * @version 1.0.0
- * @details 实现了一个线程安全的无锁队列，支持多生产者多消费者场景
+ * @details 实现了一个线程安全的无锁队列，支持多生产者多消费者场景。
+ *          队列算法、容量和等待策略都是模板策略：算法可选无界链表、有界MPMC环形队列、有界MPSC环形队列、票号环形队列和无界分段队列，
+ *          容量可在编译期或运行期确定，等待策略决定队列已满或为空时如何重试。
+ *          AnyQueue对所有组合提供统一的运行期接口，LogManager据此按配置选择实现
  * @note 此实现使用原子操作保证线程安全，适用于高性能日志系统
  * @see LogManager, LogMessage
  * @since 1.0.0
@@ -12,10 +15,17 @@
 
 #pragma once
 
+#include "logTypes.hpp"
 #include <atomic>
 #include <memory>
+#include <memory_resource>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <cstddef>
+#include <cstdint>
 
 namespace async_log {
 
@@ -29,14 +39,14 @@ template<typename T>
 struct QueueNode {
     T data;                              ///< 节点数据
     std::atomic<QueueNode*> next;        ///< 指向下一个节点的原子指针
-    
+
     /**
      * @brief 构造函数
      * @param[in] item 要存储的数据
      * @since 1.0.0
      */
     explicit QueueNode(const T& item) : data(item), next(nullptr) {}
-    
+
     /**
      * @brief 移动构造函数
      * @param[in] item 要移动的数据
@@ -45,57 +55,953 @@ struct QueueNode {
     explicit QueueNode(T&& item) : data(std::move(item)), next(nullptr) {}
 };
 
+// =============================================================================
+// 容量策略
+// =============================================================================
+
 /**
- * @brief 无锁队列模板类
- * @details 实现了基于链表的无锁队列，支持多生产者多消费者
- * @note 此实现是线程安全的，但要求类型T支持拷贝构造和移动构造
- * @tparam T 队列中存储的数据类型
- * @since 1.0.0
+ * @brief 编译期容量策略
+ * @details 容量是编译期常量，环形队列的取模运算可以被编译器完全展开
+ * @tparam N 槽位数量，必须是不小于2的2的幂
+ * @since 1.1.0
  */
-template<typename T>
-class LockFreeQueue {
+template<size_t N>
+struct FixedCapacity {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "FixedCapacity requires a power of two >= 2");
+
+    /**
+     * @brief 构造函数
+     * @param[in] requested 忽略，容量由模板参数决定
+     * @since 1.1.0
+     */
+    explicit FixedCapacity(size_t requested = N) {
+        (void)requested;
+    }
+
+    /**
+     * @brief 获取容量
+     * @return 槽位数量
+     * @since 1.1.0
+     */
+    static constexpr size_t value() {
+        return N;
+    }
+};
+
+/**
+ * @brief 运行期容量策略
+ * @details 容量在构造时确定，向上取整为2的幂
+ * @since 1.1.0
+ */
+class RuntimeCapacity {
+private:
+    size_t capacity_;   ///< 槽位数量（2的幂）
+
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;   ///< 未指定时的默认容量
+
+    /**
+     * @brief 构造函数
+     * @param[in] requested 期望的槽位数量，向上取整为2的幂，最小为2
+     * @since 1.1.0
+     */
+    explicit RuntimeCapacity(size_t requested = DEFAULT_CAPACITY)
+        : capacity_(roundUpToPowerOfTwo(requested)) {
+    }
+
+    /**
+     * @brief 获取容量
+     * @return 槽位数量
+     * @since 1.1.0
+     */
+    size_t value() const {
+        return capacity_;
+    }
+
+    /**
+     * @brief 向上取整为2的幂
+     * @param[in] value 输入值
+     * @return 不小于value且不小于2的最小2的幂
+     * @since 1.1.0
+     */
+    static size_t roundUpToPowerOfTwo(size_t value) {
+        size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+};
+
+// =============================================================================
+// 等待策略
+// =============================================================================
+
+/**
+ * @brief 不等待策略
+ * @details 队列已满或为空时立即返回失败，由调用者自行处理（如LogManager的溢出策略和条件变量）
+ * @since 1.1.0
+ */
+struct NoWait {
+    static constexpr QueueWaitStrategy kind = QueueWaitStrategy::NONE;   ///< 对应的配置值
+
+    /**
+     * @brief 执行一次尝试
+     * @param[in] attempt 尝试回调，返回true表示成功
+     * @return 尝试的结果
+     * @since 1.1.0
+     */
+    template<typename Attempt>
+    static bool retry(Attempt&& attempt) {
+        return attempt();
+    }
+};
+
+/**
+ * @brief 忙等策略
+ * @details 在返回失败前忙等重试SPIN_LIMIT次，适合消费者独占CPU核心、追求最低延迟的部署
+ * @since 1.1.0
+ */
+struct SpinWait {
+    static constexpr QueueWaitStrategy kind = QueueWaitStrategy::SPIN;   ///< 对应的配置值
+    static constexpr int SPIN_LIMIT = 256;                              ///< 忙等重试次数
+
+    /**
+     * @brief 提示CPU当前处于忙等循环
+     * @since 1.1.0
+     */
+    static void relax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    /**
+     * @brief 重试直到成功或达到忙等上限
+     * @param[in] attempt 尝试回调，返回true表示成功
+     * @return true表示成功
+     * @since 1.1.0
+     */
+    template<typename Attempt>
+    static bool retry(Attempt&& attempt) {
+        for (int i = 0; i < SPIN_LIMIT; ++i) {
+            if (attempt()) {
+                return true;
+            }
+            relax();
+        }
+        return attempt();
+    }
+};
+
+/**
+ * @brief 先忙等再让出CPU的策略
+ * @details 先忙等SPIN_LIMIT次，再以std::this_thread::yield()重试YIELD_LIMIT次，
+ *          线程数多于CPU核心时比纯忙等更友好
+ * @since 1.1.0
+ */
+struct YieldWait {
+    static constexpr QueueWaitStrategy kind = QueueWaitStrategy::YIELD;  ///< 对应的配置值
+    static constexpr int SPIN_LIMIT = 64;                               ///< 忙等重试次数
+    static constexpr int YIELD_LIMIT = 64;                              ///< 让出CPU后的重试次数
+
+    /**
+     * @brief 重试直到成功或达到重试上限
+     * @param[in] attempt 尝试回调，返回true表示成功
+     * @return true表示成功
+     * @since 1.1.0
+     */
+    template<typename Attempt>
+    static bool retry(Attempt&& attempt) {
+        for (int i = 0; i < SPIN_LIMIT; ++i) {
+            if (attempt()) {
+                return true;
+            }
+            SpinWait::relax();
+        }
+        for (int i = 0; i < YIELD_LIMIT; ++i) {
+            if (attempt()) {
+                return true;
+            }
+            std::this_thread::yield();
+        }
+        return attempt();
+    }
+};
+
+// =============================================================================
+// 队列算法
+// =============================================================================
+
+/**
+ * @brief 无界链表存储
+ * @details 基于链表的多生产者多消费者队列，每个元素一个节点。
+ *          节点从构造时指定的std::pmr::memory_resource分配，生产者会并发分配、消费者会释放，
+ *          因此该资源必须是线程安全的（如std::pmr::synchronized_pool_resource）
+ * @tparam T 元素类型
+ * @tparam Capacity 容量策略，链表无界，忽略
+ * @since 1.1.0
+ */
+template<typename T, typename Capacity>
+class LinkedStorage {
 private:
+    using NodeAllocator = std::pmr::polymorphic_allocator<QueueNode<T>>;
+
     std::atomic<QueueNode<T>*> head_;    ///< 队列头指针
     std::atomic<QueueNode<T>*> tail_;    ///< 队列尾指针
     std::atomic<size_t> size_;           ///< 队列大小
-    
+    std::pmr::memory_resource* resource_; ///< 节点内存来源
+
 public:
+    static constexpr size_t ITEM_OVERHEAD = sizeof(QueueNode<T>);   ///< 每个元素额外占用的字节数
+
     /**
      * @brief 构造函数
+     * @param[in] capacity 忽略
+     * @param[in] resource 节点内存来源
+     * @since 1.1.0
+     */
+    LinkedStorage(Capacity capacity, std::pmr::memory_resource* resource);
+
+    /**
+     * @brief 析构函数
+     * @since 1.1.0
+     */
+    ~LinkedStorage();
+
+    LinkedStorage(const LinkedStorage&) = delete;
+    LinkedStorage& operator=(const LinkedStorage&) = delete;
+    LinkedStorage(LinkedStorage&& other) noexcept;
+    LinkedStorage& operator=(LinkedStorage&& other) noexcept;
+
+    /**
+     * @brief 分配节点、填充后链接到队尾
+     * @param[in] fill 填充回调，参数为节点中元素的引用
+     * @return 总是true
+     * @since 1.1.0
+     */
+    template<typename Fill>
+    bool tryEmplace(Fill&& fill);
+
+    /**
+     * @brief 分配并填充一串节点后一次链接到队尾
+     * @param[in] count 元素数量
+     * @param[in] fill 填充回调，参数为元素引用、批内下标和本批实际入队数量
+     * @return 入队数量，总是等于count
+     * @since 1.1.0
+     */
+    template<typename Fill>
+    size_t tryEmplaceBatch(size_t count, Fill&& fill);
+
+    /**
+     * @brief 从队头取出元素
+     * @param[out] item 存储取出的元素
+     * @return true表示成功，false表示队列为空或队头节点尚未链接完成
+     * @since 1.1.0
+     */
+    bool tryPop(T& item);
+
+    /**
+     * @brief 检查队列是否为空
+     * @return true表示为空
+     * @since 1.1.0
+     */
+    bool empty() const;
+
+    /**
+     * @brief 获取队列大小
+     * @return 元素数量，并发情况下为近似值
+     * @since 1.1.0
+     */
+    size_t getSize() const;
+
+    /**
+     * @brief 获取容量
+     * @return 0，表示无界
+     * @since 1.1.0
+     */
+    size_t getCapacity() const;
+
+    /**
+     * @brief 获取预先分配的字节数
+     * @return 0，节点按元素分配
+     * @since 1.1.0
+     */
+    size_t getFootprint() const;
+
+    /**
+     * @brief 获取节点内存来源
+     * @return 内存资源
+     * @since 1.1.0
+     */
+    std::pmr::memory_resource* getMemoryResource() const;
+
+private:
+    /**
+     * @brief 清理资源
      * @since 1.0.0
      */
-    LockFreeQueue();
-    
+    void cleanup();
+
+    /**
+     * @brief 从内存资源分配并构造节点
+     * @param[in] item 节点数据
+     * @return 指向新节点的指针
+     * @since 1.1.0
+     */
+    template<typename U>
+    QueueNode<T>* createNode(U&& item);
+
+    /**
+     * @brief 析构节点并归还内存
+     * @param[in] node 要销毁的节点
+     * @since 1.1.0
+     */
+    void destroyNode(QueueNode<T>* node);
+};
+
+/**
+ * @brief 有界环形存储
+ * @details 每个槽位带有一个序号：序号等于入队位置时槽位空闲，等于入队位置+1时槽位已发布可供消费。
+ *          生产者以CAS占用入队位置；多消费者时出队位置同样以CAS竞争，单消费者时只需普通的读写
+ * @note 序号算法参考Dmitry Vyukov的有界MPMC队列。SingleConsumer为true时同一时刻只能有一个线程出队
+ * @tparam T 元素类型，必须可默认构造
+ * @tparam Capacity 容量策略
+ * @tparam SingleConsumer 是否只有一个消费者
+ * @since 1.1.0
+ */
+template<typename T, typename Capacity, bool SingleConsumer>
+class RingStorage {
+private:
+    /**
+     * @brief 槽位结构
+     * @since 1.1.0
+     */
+    struct Slot {
+        std::atomic<size_t> sequence;   ///< 槽位序号
+        T value;                        ///< 元素
+    };
+
+    using SlotAllocator = std::pmr::polymorphic_allocator<Slot>;
+
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    Capacity capacity_;                                         ///< 槽位数量
+    Slot* slots_;                                               ///< 槽位数组
+    std::pmr::memory_resource* resource_;                       ///< 槽位数组的内存来源
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueuePos_;   ///< 下一个入队位置
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> dequeuePos_;   ///< 下一个出队位置
+
+public:
+    static constexpr size_t ITEM_OVERHEAD = 0;   ///< 槽位预先分配，元素不额外占用内存
+
+    /**
+     * @brief 构造函数
+     * @param[in] capacity 槽位数量
+     * @param[in] resource 槽位数组的内存来源
+     * @since 1.1.0
+     */
+    RingStorage(Capacity capacity, std::pmr::memory_resource* resource);
+
+    /**
+     * @brief 析构函数
+     * @since 1.1.0
+     */
+    ~RingStorage();
+
+    // 禁用拷贝和移动：槽位地址在生命周期内必须稳定
+    RingStorage(const RingStorage&) = delete;
+    RingStorage& operator=(const RingStorage&) = delete;
+
+    /**
+     * @brief 尝试占用一个空闲槽位并填充
+     * @param[in] fill 填充回调，参数为槽位中元素的引用
+     * @return true表示成功发布，false表示队列已满
+     * @since 1.1.0
+     */
+    template<typename Fill>
+    bool tryEmplace(Fill&& fill);
+
+    /**
+     * @brief 一次占用多个连续的空闲槽位并填充
+     * @param[in] count 期望的元素数量
+     * @param[in] fill 填充回调，参数为元素引用、批内下标和本批实际入队数量
+     * @return 入队数量，空闲槽位不足时只占用开头连续空闲的部分，0表示队列已满
+     * @since 1.1.0
+     */
+    template<typename Fill>
+    size_t tryEmplaceBatch(size_t count, Fill&& fill);
+
+    /**
+     * @brief 从队头取出元素
+     * @param[out] item 存储取出的元素
+     * @return true表示成功，false表示队列为空或队头槽位尚未发布
+     * @since 1.1.0
+     */
+    bool tryPop(T& item);
+
+    /**
+     * @brief 检查队列是否为空
+     * @return true表示没有已占用的槽位
+     * @since 1.1.0
+     */
+    bool empty() const;
+
+    /**
+     * @brief 获取已占用的槽位数量
+     * @return 槽位数量，并发情况下为近似值
+     * @since 1.1.0
+     */
+    size_t getSize() const;
+
+    /**
+     * @brief 获取容量
+     * @return 槽位数量
+     * @since 1.1.0
+     */
+    size_t getCapacity() const;
+
+    /**
+     * @brief 获取槽位数组占用的字节数
+     * @return 字节数（不含元素内部的动态内存）
+     * @since 1.1.0
+     */
+    size_t getFootprint() const;
+
+    /**
+     * @brief 获取槽位数组的内存来源
+     * @return 内存资源
+     * @since 1.1.0
+     */
+    std::pmr::memory_resource* getMemoryResource() const;
+};
+
+/**
+ * @brief 有界票号环形存储
+ * @details 生产者以一次fetch_add领取票号，再以一次CAS占用票号对应的槽位，任何情况下都不因竞争重试，
+ *          最坏延迟与生产者数量无关。槽位仍被上一轮占用（队列已满）时，生产者放弃票号并在槽位上登记，
+ *          消费者按票号顺序出队，遇到被放弃的票号时直接跳过，形成的空洞由消费者处理
+ * @note 只支持单个消费者。被放弃的票号同样占用一个位置，getSize()在空洞被跳过前偏大
+ * @tparam T 元素类型，必须可默认构造
+ * @tparam Capacity 容量策略
+ * @since 1.1.0
+ */
+template<typename T, typename Capacity>
+class TicketRingStorage {
+private:
+    // 槽位状态 = 票号 * 4 + 阶段
+    static constexpr size_t FREE = 0;        ///< 空闲，等待该票号的生产者
+    static constexpr size_t BUSY = 1;        ///< 生产者正在填充
+    static constexpr size_t PUBLISHED = 2;   ///< 已发布，等待消费
+
+    /**
+     * @brief 槽位结构
+     * @since 1.1.0
+     */
+    struct Slot {
+        std::atomic<size_t> state;       ///< 槽位状态
+        std::atomic<size_t> abandoned;   ///< 在此槽位上放弃的最大票号+1，0表示没有
+        T value;                         ///< 元素
+    };
+
+    using SlotAllocator = std::pmr::polymorphic_allocator<Slot>;
+
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    Capacity capacity_;                                         ///< 槽位数量
+    Slot* slots_;                                               ///< 槽位数组
+    std::pmr::memory_resource* resource_;                       ///< 槽位数组的内存来源
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueuePos_;   ///< 下一个发放的票号
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> dequeuePos_;   ///< 下一个出队的票号，只由消费者写
+
+public:
+    static constexpr size_t ITEM_OVERHEAD = 0;   ///< 槽位预先分配，元素不额外占用内存
+
+    /**
+     * @brief 构造函数
+     * @param[in] capacity 槽位数量
+     * @param[in] resource 槽位数组的内存来源
+     * @since 1.1.0
+     */
+    TicketRingStorage(Capacity capacity, std::pmr::memory_resource* resource);
+
+    /**
+     * @brief 析构函数
+     * @since 1.1.0
+     */
+    ~TicketRingStorage();
+
+    // 禁用拷贝和移动：槽位地址在生命周期内必须稳定
+    TicketRingStorage(const TicketRingStorage&) = delete;
+    TicketRingStorage& operator=(const TicketRingStorage&) = delete;
+
+    /**
+     * @brief 领取票号并填充对应的槽位
+     * @details 先粗略检查队列是否已满，已满时不领取票号，避免持续溢出时制造大量空洞
+     * @param[in] fill 填充回调，参数为槽位中元素的引用
+     * @return true表示成功发布，false表示队列已满
+     * @since 1.1.0
+     */
+    template<typename Fill>
+    bool tryEmplace(Fill&& fill);
+
+    /**
+     * @brief 以一次fetch_add领取多个连续票号并填充
+     * @details 逐个占用票号对应的槽位，第一个占用失败的票号及其后的票号都放弃
+     * @param[in] count 期望的元素数量
+     * @param[in] fill 填充回调，参数为元素引用、批内下标和本批实际入队数量
+     * @return 入队数量，0表示队列已满
+     * @since 1.1.0
+     */
+    template<typename Fill>
+    size_t tryEmplaceBatch(size_t count, Fill&& fill);
+
+    /**
+     * @brief 按票号顺序取出元素，跳过被放弃的票号
+     * @param[out] item 存储取出的元素
+     * @return true表示成功，false表示队列为空或下一个票号的生产者尚未完成
+     * @since 1.1.0
+     */
+    bool tryPop(T& item);
+
+    /**
+     * @brief 检查队列是否为空
+     * @return true表示没有未出队的票号
+     * @since 1.1.0
+     */
+    bool empty() const;
+
+    /**
+     * @brief 获取未出队的票号数量
+     * @return 票号数量，包含尚未跳过的空洞，并发情况下为近似值
+     * @since 1.1.0
+     */
+    size_t getSize() const;
+
+    /**
+     * @brief 获取容量
+     * @return 槽位数量
+     * @since 1.1.0
+     */
+    size_t getCapacity() const;
+
+    /**
+     * @brief 获取槽位数组占用的字节数
+     * @return 字节数（不含元素内部的动态内存）
+     * @since 1.1.0
+     */
+    size_t getFootprint() const;
+
+    /**
+     * @brief 获取槽位数组的内存来源
+     * @return 内存资源
+     * @since 1.1.0
+     */
+    std::pmr::memory_resource* getMemoryResource() const;
+
+private:
+    /**
+     * @brief 在槽位上登记被放弃的票号
+     * @details 只在队列已满时调用；只有同一槽位上更小的票号同时登记时才会重试
+     * @param[in] slot 票号对应的槽位
+     * @param[in] ticket 被放弃的票号
+     * @since 1.1.0
+     */
+    static void markAbandoned(Slot& slot, size_t ticket);
+};
+
+/**
+ * @brief 无界分段存储
+ * @details 槽位按段整块分配，每段segmentSize个槽位。生产者以一次fetch_add领取票号，票号除以段大小即段号，
+ *          通过固定大小的段目录找到对应的段；走到新段的第一个生产者负责登记新段。
+ *          消费者按票号顺序出队，取空一段后把它从目录中摘下放回池中，池满才释放，
+ *          突发流量过后再次突发时不需要重新分配。入队不为单个元素分配内存，也没有固定环形队列的容量上限
+ * @note 只支持单个消费者。生产者只通过目录访问自己票号所在的段，不会读取已被回收的段。
+ *       未出队的段数接近目录大小时入队失败，相当于DIRECTORY_SIZE * segmentSize条消息的上限
+ * @tparam T 元素类型，必须可默认构造
+ * @tparam Capacity 容量策略，决定每段的槽位数量
+ * @since 1.1.0
+ */
+template<typename T, typename Capacity>
+class SegmentedStorage {
+private:
+    /**
+     * @brief 槽位结构
+     * @since 1.1.0
+     */
+    struct Slot {
+        std::atomic<size_t> ticket;   ///< 已发布的票号+1，段复用时无需重置
+        T value;                      ///< 元素
+    };
+
+    /**
+     * @brief 段结构
+     * @since 1.1.0
+     */
+    struct Segment {
+        Segment* next;   ///< 在池或退回栈中时指向下一个段
+        Slot* slots;     ///< 槽位数组
+    };
+
+    /**
+     * @brief 段目录项
+     * @details 登记时先写入段指针再写入段号，摘下时先清除段号再清除段指针
+     * @since 1.1.0
+     */
+    struct DirectoryEntry {
+        std::atomic<size_t> id;             ///< 当前登记的段号，NO_SEGMENT表示没有
+        std::atomic<Segment*> segment;      ///< 当前登记的段
+    };
+
+    using SlotAllocator = std::pmr::polymorphic_allocator<Slot>;
+    using SegmentAllocator = std::pmr::polymorphic_allocator<Segment>;
+    using EntryAllocator = std::pmr::polymorphic_allocator<DirectoryEntry>;
+
+    static constexpr size_t DIRECTORY_SIZE = 4096;      ///< 段目录大小，即同时存在的最大段数
+    static constexpr size_t POOL_LIMIT = 8;             ///< 池中最多保留的空闲段数量
+    static constexpr size_t NO_SEGMENT = SIZE_MAX;      ///< 目录项未登记段时的段号
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    Capacity segmentSize_;                                      ///< 每段的槽位数量
+    size_t segmentShift_;                                       ///< 票号右移该位数得到段号
+    DirectoryEntry* directory_;                                 ///< 段目录，按段号取模索引
+    std::pmr::memory_resource* resource_;                       ///< 段和目录的内存来源
+    std::pmr::vector<Segment*> pool_;                           ///< 空闲段，只由消费者访问
+    Segment* head_;                                             ///< 消费者当前所在的段
+    size_t headId_;                                             ///< head_的段号
+    alignas(CACHE_LINE_SIZE) std::atomic<Segment*> spare_;      ///< 消费者预先交给生产者的空闲段
+    alignas(CACHE_LINE_SIZE) std::atomic<Segment*> returned_;   ///< 生产者登记失败后退回的段
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueuePos_;   ///< 下一个发放的票号
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> dequeuePos_;   ///< 下一个出队的票号，只由消费者写
+    std::atomic<size_t> segmentCount_;                          ///< 已分配的段数量，含池中和备用的空闲段
+
+public:
+    static constexpr size_t ITEM_OVERHEAD = 0;   ///< 槽位随段整体计入getFootprint()，元素不再单独计入
+
+    /**
+     * @brief 构造函数
+     * @details 预先分配并登记第一个段
+     * @param[in] segmentSize 每段的槽位数量
+     * @param[in] resource 段和目录的内存来源
+     * @since 1.1.0
+     */
+    SegmentedStorage(Capacity segmentSize, std::pmr::memory_resource* resource);
+
     /**
      * @brief 析构函数
+     * @since 1.1.0
+     */
+    ~SegmentedStorage();
+
+    // 禁用拷贝和移动：生产者持有段和目录的地址
+    SegmentedStorage(const SegmentedStorage&) = delete;
+    SegmentedStorage& operator=(const SegmentedStorage&) = delete;
+
+    /**
+     * @brief 领取票号并填充对应的槽位
+     * @param[in] fill 填充回调，参数为槽位中元素的引用
+     * @return true表示成功发布，false表示段目录已满
+     * @since 1.1.0
+     */
+    template<typename Fill>
+    bool tryEmplace(Fill&& fill);
+
+    /**
+     * @brief 以一次fetch_add领取多个连续票号并填充
+     * @param[in] count 期望的元素数量，超过一段时只入队一段
+     * @param[in] fill 填充回调，参数为元素引用、批内下标和本批实际入队数量
+     * @return 入队数量，0表示段目录已满
+     * @since 1.1.0
+     */
+    template<typename Fill>
+    size_t tryEmplaceBatch(size_t count, Fill&& fill);
+
+    /**
+     * @brief 按票号顺序取出元素
+     * @details 取空一段后把它放回池中，并给生产者备好下一个空闲段
+     * @param[out] item 存储取出的元素
+     * @return true表示成功，false表示队列为空或下一个票号的生产者尚未完成
+     * @since 1.1.0
+     */
+    bool tryPop(T& item);
+
+    /**
+     * @brief 检查队列是否为空
+     * @return true表示没有未出队的票号
+     * @since 1.1.0
+     */
+    bool empty() const;
+
+    /**
+     * @brief 获取未出队的票号数量
+     * @return 票号数量，并发情况下为近似值
+     * @since 1.1.0
+     */
+    size_t getSize() const;
+
+    /**
+     * @brief 获取容量
+     * @return 0，表示无界
+     * @since 1.1.0
+     */
+    size_t getCapacity() const;
+
+    /**
+     * @brief 获取每段的槽位数量
+     * @return 槽位数量
+     * @since 1.1.0
+     */
+    size_t getSegmentSize() const;
+
+    /**
+     * @brief 获取已分配的字节数
+     * @details 段按需分配，取空后放回池中或释放，返回值随之变化；生产者分配新段时同样会改变
+     * @return 段目录和当前所有段（含池中和备用的空闲段）占用的字节数（不含元素内部的动态内存）
+     * @since 1.1.0
+     */
+    size_t getFootprint() const;
+
+    /**
+     * @brief 获取段和目录的内存来源
+     * @return 内存资源
+     * @since 1.1.0
+     */
+    std::pmr::memory_resource* getMemoryResource() const;
+
+private:
+    /**
+     * @brief 查找段号对应的段，必要时登记新段
+     * @details 目录项仍被更早的段占用或其他生产者正在登记时让出CPU重试
+     * @param[in] id 段号，调用者持有该段中的票号
+     * @return 段指针
+     * @since 1.1.0
+     */
+    Segment* segmentFor(size_t id);
+
+    /**
+     * @brief 检查领取指定数量的票号是否会超出段目录
+     * @param[in] count 票号数量
+     * @return true表示段目录已满
+     * @since 1.1.0
+     */
+    bool isDirectoryFull(size_t count) const;
+
+    /**
+     * @brief 取得一个空闲段，优先使用消费者备好的段
+     * @return 段指针
+     * @since 1.1.0
+     */
+    Segment* takeSpare();
+
+    /**
+     * @brief 把登记失败的段退回给消费者
+     * @param[in] segment 段指针
+     * @since 1.1.0
+     */
+    void giveBack(Segment* segment);
+
+    /**
+     * @brief 摘下已取空的段并回收
+     * @param[in] segment 段指针
+     * @param[in] id 段号
+     * @since 1.1.0
+     */
+    void retire(Segment* segment, size_t id);
+
+    /**
+     * @brief 把段放回池中，池满时释放
+     * @param[in] segment 段指针
+     * @since 1.1.0
+     */
+    void recycle(Segment* segment);
+
+    /**
+     * @brief 分配一个段
+     * @return 段指针
+     * @since 1.1.0
+     */
+    Segment* createSegment();
+
+    /**
+     * @brief 释放一个段
+     * @param[in] segment 段指针
+     * @since 1.1.0
+     */
+    void destroySegment(Segment* segment);
+};
+
+/**
+ * @brief 无界链表算法
+ * @since 1.1.0
+ */
+struct LinkedAlgorithm {
+    static constexpr QueueAlgorithm kind = QueueAlgorithm::LINKED;   ///< 对应的配置值
+
+    template<typename T, typename Capacity>
+    using Storage = LinkedStorage<T, Capacity>;
+};
+
+/**
+ * @brief 有界多生产者多消费者环形队列算法
+ * @since 1.1.0
+ */
+struct BoundedMpmcAlgorithm {
+    static constexpr QueueAlgorithm kind = QueueAlgorithm::BOUNDED_MPMC;   ///< 对应的配置值
+
+    template<typename T, typename Capacity>
+    using Storage = RingStorage<T, Capacity, false>;
+};
+
+/**
+ * @brief 有界多生产者单消费者环形队列算法
+ * @since 1.1.0
+ */
+struct MpscRingAlgorithm {
+    static constexpr QueueAlgorithm kind = QueueAlgorithm::MPSC_RING;   ///< 对应的配置值
+
+    template<typename T, typename Capacity>
+    using Storage = RingStorage<T, Capacity, true>;
+};
+
+/**
+ * @brief 有界多生产者单消费者票号环形队列算法
+ * @since 1.1.0
+ */
+struct TicketRingAlgorithm {
+    static constexpr QueueAlgorithm kind = QueueAlgorithm::TICKET_RING;   ///< 对应的配置值
+
+    template<typename T, typename Capacity>
+    using Storage = TicketRingStorage<T, Capacity>;
+};
+
+/**
+ * @brief 无界多生产者单消费者分段队列算法
+ * @since 1.1.0
+ */
+struct SegmentedAlgorithm {
+    static constexpr QueueAlgorithm kind = QueueAlgorithm::SEGMENTED;   ///< 对应的配置值
+
+    template<typename T, typename Capacity>
+    using Storage = SegmentedStorage<T, Capacity>;
+};
+
+// =============================================================================
+// 队列
+// =============================================================================
+
+/**
+ * @brief 无锁队列模板类
+ * @details 由算法、容量和等待策略组合而成，所有组合提供相同的入队、出队和批量接口。
+ *          默认组合即原来的无界链表队列；有界算法在队列已满时入队失败，由等待策略决定失败前重试多久
+ * @note 此实现是线程安全的，但要求类型T支持拷贝构造和移动构造，有界算法还要求T可默认构造。
+ *       MpscRingAlgorithm、TicketRingAlgorithm和SegmentedAlgorithm同一时刻只能有一个线程出队
+ * @tparam T 队列中存储的数据类型
+ * @tparam Algorithm 算法策略：LinkedAlgorithm、BoundedMpmcAlgorithm、MpscRingAlgorithm、TicketRingAlgorithm或SegmentedAlgorithm
+ * @tparam Capacity 容量策略：FixedCapacity<N>或RuntimeCapacity，分段算法用作每段的槽位数，链表算法忽略
+ * @tparam Wait 等待策略：NoWait、SpinWait或YieldWait
+ * @since 1.0.0
+ */
+template<typename T, typename Algorithm = LinkedAlgorithm, typename Capacity = RuntimeCapacity,
+         typename Wait = NoWait>
+class LockFreeQueue {
+private:
+    using Storage = typename Algorithm::template Storage<T, Capacity>;
+
+    Storage storage_;   ///< 算法策略提供的存储
+
+public:
+    using value_type = T;                ///< 元素类型
+    using algorithm_type = Algorithm;    ///< 算法策略
+    using wait_type = Wait;              ///< 等待策略
+
+    static constexpr size_t ITEM_OVERHEAD = Storage::ITEM_OVERHEAD;   ///< 每个元素额外占用的字节数
+
+    /**
+     * @brief 构造函数
+     * @param[in] resource 节点或槽位数组的内存来源，默认为全局默认资源
      * @since 1.0.0
      */
-    ~LockFreeQueue();
-    
+    explicit LockFreeQueue(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : storage_(Capacity(), resource) {
+    }
+
+    /**
+     * @brief 指定容量的构造函数
+     * @param[in] capacity 有界算法的期望槽位数量或分段算法每段的槽位数量，向上取整为2的幂；编译期容量和链表算法忽略此参数
+     * @param[in] resource 节点或槽位数组的内存来源
+     * @since 1.1.0
+     */
+    LockFreeQueue(size_t capacity, std::pmr::memory_resource* resource)
+        : storage_(Capacity(capacity), resource) {
+    }
+
     // 禁用拷贝构造和赋值
     LockFreeQueue(const LockFreeQueue&) = delete;
     LockFreeQueue& operator=(const LockFreeQueue&) = delete;
-    
-    // 允许移动构造和赋值
-    LockFreeQueue(LockFreeQueue&&) noexcept;
-    LockFreeQueue& operator=(LockFreeQueue&&) noexcept;
-    
+
+    // 链表算法允许移动构造和赋值，环形算法的槽位地址必须稳定，不可移动
+    LockFreeQueue(LockFreeQueue&&) = default;
+    LockFreeQueue& operator=(LockFreeQueue&&) = default;
+
     /**
      * @brief 向队列尾部添加元素
      * @param[in] item 要添加的元素
+     * @return true表示成功，false表示有界队列已满
      * @note 此操作是线程安全的
      * @since 1.0.0
      */
-    void push(const T& item);
-    
+    bool push(const T& item) {
+        return emplace([&item](T& slot) { slot = item; });
+    }
+
     /**
      * @brief 向队列尾部添加元素（移动语义）
-     * @param[in] item 要移动的元素
+     * @param[in] item 要移动的元素，入队失败时保持不变
+     * @return true表示成功，false表示有界队列已满
      * @note 此操作是线程安全的
      * @since 1.0.0
      */
-    void push(T&& item);
-    
+    bool push(T&& item) {
+        return emplace([&item](T& slot) { slot = std::move(item); });
+    }
+
+    /**
+     * @brief 占用队尾位置后就地填充元素
+     * @details 回调只在确定入队后调用一次，适合需要在入队时才分配的字段（如序号）
+     * @param[in] fill 填充回调，参数为队列中元素的引用
+     * @return true表示成功，false表示有界队列已满
+     * @note 此操作是线程安全的
+     * @tparam Fill 回调类型，签名为void(T&)
+     * @since 1.1.0
+     */
+    template<typename Fill>
+    bool emplace(Fill&& fill) {
+        return Wait::retry([&] { return storage_.tryEmplace(fill); });
+    }
+
+    /**
+     * @brief 一次入队多个元素
+     * @details 链表算法一次链接整串节点，环形算法一次占用一段连续槽位，每批只有一次共享位置上的原子操作。
+     *          有界队列空闲槽位不足时只入队开头的一部分，等待策略只作用于整批都无法入队的情况
+     * @param[in] count 期望的元素数量
+     * @param[in] fill 填充回调，签名为void(T& item, size_t index, size_t claimed)，
+     *                 按下标顺序对实际入队的每个元素调用一次，claimed为本批实际入队数量
+     * @return 实际入队数量，只会是开头连续的一部分
+     * @note 此操作是线程安全的
+     * @tparam Fill 回调类型
+     * @since 1.1.0
+     */
+    template<typename Fill>
+    size_t emplaceBatch(size_t count, Fill&& fill) {
+        size_t claimed = 0;
+        if (count > 0) {
+            Wait::retry([&] { return (claimed = storage_.tryEmplaceBatch(count, fill)) > 0; });
+        }
+        return claimed;
+    }
+
     /**
      * @brief 从队列头部取出元素
      * @param[out] item 存储取出的元素
@@ -103,93 +1009,421 @@ public:
      * @note 此操作是线程安全的
      * @since 1.0.0
      */
-    bool pop(T& item);
-    
+    bool pop(T& item) {
+        return Wait::retry([&] { return storage_.tryPop(item); });
+    }
+
     /**
      * @brief 检查队列是否为空
      * @return true表示队列为空，false表示队列非空
      * @note 此操作是线程安全的
      * @since 1.0.0
      */
-    bool empty() const;
-    
+    bool empty() const {
+        return storage_.empty();
+    }
+
     /**
      * @brief 获取队列大小
      * @return 队列中元素的数量
      * @note 此操作是线程安全的，但返回的值可能不是精确的
      * @since 1.0.0
      */
-    size_t getSize() const;
-    
+    size_t getSize() const {
+        return storage_.getSize();
+    }
+
+    /**
+     * @brief 获取容量
+     * @return 有界算法的槽位数量，0表示无界
+     * @since 1.1.0
+     */
+    size_t getCapacity() const {
+        return storage_.getCapacity();
+    }
+
+    /**
+     * @brief 获取每段的槽位数量
+     * @return 分段算法每段的槽位数量，其他算法为0
+     * @since 1.1.0
+     */
+    size_t getSegmentSize() const {
+        if constexpr (Algorithm::kind == QueueAlgorithm::SEGMENTED) {
+            return storage_.getSegmentSize();
+        } else {
+            return 0;
+        }
+    }
+
+    /**
+     * @brief 获取预先分配的字节数
+     * @return 有界算法的槽位数组字节数，分段算法的段目录和当前所有段的字节数，链表算法为0
+     * @since 1.1.0
+     */
+    size_t getFootprint() const {
+        return storage_.getFootprint();
+    }
+
     /**
      * @brief 批量添加元素
      * @param[in] items 要添加的元素向量
+     * @return 成功添加的数量，有界队列已满时停止
      * @note 此操作是线程安全的
      * @since 1.0.0
      */
-    void pushBatch(const std::vector<T>& items);
-    
+    size_t pushBatch(const std::vector<T>& items) {
+        size_t count = 0;
+        for (const auto& item : items) {
+            if (!push(item)) {
+                break;
+            }
+            count++;
+        }
+        return count;
+    }
+
     /**
      * @brief 批量取出元素
-     * @param[out] items 存储取出的元素
+     * @details 等待策略只作用于第一个元素，之后取空即返回
+     * @param[out] items 存储取出的元素，可以使用任意分配器（如std::pmr::vector）
      * @param[in] maxCount 最大取出数量
      * @return 实际取出的元素数量
      * @note 此操作是线程安全的
+     * @tparam Alloc 目标向量的分配器类型
      * @since 1.0.0
      */
-    size_t popBatch(std::vector<T>& items, size_t maxCount);
-    
+    template<typename Alloc>
+    size_t popBatch(std::vector<T, Alloc>& items, size_t maxCount) {
+        items.clear();
+        items.reserve(maxCount);
+
+        T item;
+        if (maxCount == 0 || !pop(item)) {
+            return 0;
+        }
+        items.push_back(std::move(item));
+
+        while (items.size() < maxCount && storage_.tryPop(item)) {
+            items.push_back(std::move(item));
+        }
+
+        return items.size();
+    }
+
     /**
      * @brief 清空队列
      * @note 此操作是线程安全的
      * @since 1.0.0
      */
-    void clear();
-    
-private:
+    void clear() {
+        T item;
+        while (storage_.tryPop(item)) {
+            // 清空所有元素
+        }
+    }
+
     /**
-     * @brief 清理资源
-     * @since 1.0.0
+     * @brief 获取节点内存来源
+     * @return 构造时指定的内存资源
+     * @since 1.1.0
      */
-    void cleanup();
-    
+    std::pmr::memory_resource* getMemoryResource() const {
+        return storage_.getMemoryResource();
+    }
+};
+
+// =============================================================================
+// 运行期选择
+// =============================================================================
+
+/**
+ * @brief 类型擦除的队列接口
+ * @details 为任意算法、容量和等待策略的组合提供统一的运行期接口，供按配置选择队列的调用者使用
+ * @note 线程安全性与被包装的队列相同
+ * @tparam T 元素类型
+ * @since 1.1.0
+ */
+template<typename T>
+class AnyQueue {
+public:
+    using Filler = void (*)(void* context, T& item);   ///< 就地填充回调
+    using BatchFiller = void (*)(void* context, T& item, size_t index, size_t claimed);   ///< 批量就地填充回调
+
+    virtual ~AnyQueue() = default;
+
     /**
-     * @brief 创建哨兵节点
-     * @return 指向哨兵节点的指针
-     * @since 1.0.0
+     * @brief 占用队尾位置后就地填充元素
+     * @param[in] fill 填充回调，只在确定入队后调用一次
+     * @return true表示成功，false表示有界队列已满
+     * @tparam Fill 回调类型，签名为void(T&)
+     * @since 1.1.0
+     */
+    template<typename Fill>
+    bool emplace(Fill&& fill) {
+        using Callback = std::remove_reference_t<Fill>;
+        return emplaceWith([](void* context, T& item) { (*static_cast<Callback*>(context))(item); },
+                           const_cast<void*>(static_cast<const void*>(&fill)));
+    }
+
+    /**
+     * @brief 以函数指针形式就地填充元素
+     * @param[in] filler 填充回调
+     * @param[in] context 传给回调的上下文
+     * @return true表示成功，false表示有界队列已满
+     * @since 1.1.0
+     */
+    virtual bool emplaceWith(Filler filler, void* context) = 0;
+
+    /**
+     * @brief 一次入队多个元素
+     * @param[in] count 期望的元素数量
+     * @param[in] fill 填充回调，签名为void(T& item, size_t index, size_t claimed)
+     * @return 实际入队数量，只会是开头连续的一部分
+     * @tparam Fill 回调类型
+     * @see LockFreeQueue::emplaceBatch
+     * @since 1.1.0
+     */
+    template<typename Fill>
+    size_t emplaceBatch(size_t count, Fill&& fill) {
+        using Callback = std::remove_reference_t<Fill>;
+        return emplaceBatchWith(count,
+                                [](void* context, T& item, size_t index, size_t claimed) {
+                                    (*static_cast<Callback*>(context))(item, index, claimed);
+                                },
+                                const_cast<void*>(static_cast<const void*>(&fill)));
+    }
+
+    /**
+     * @brief 以函数指针形式一次入队多个元素
+     * @param[in] count 期望的元素数量
+     * @param[in] filler 填充回调
+     * @param[in] context 传给回调的上下文
+     * @return 实际入队数量
+     * @since 1.1.0
+     */
+    virtual size_t emplaceBatchWith(size_t count, BatchFiller filler, void* context) = 0;
+
+    /**
+     * @brief 向队列尾部添加元素（移动语义）
+     * @param[in] item 要移动的元素，入队失败时保持不变
+     * @return true表示成功，false表示有界队列已满
+     * @since 1.1.0
+     */
+    virtual bool push(T&& item) = 0;
+
+    /**
+     * @brief 从队列头部取出元素
+     * @param[out] item 存储取出的元素
+     * @return true表示成功，false表示队列为空
+     * @since 1.1.0
+     */
+    virtual bool pop(T& item) = 0;
+
+    /**
+     * @brief 批量取出元素
+     * @param[out] items 存储取出的元素
+     * @param[in] maxCount 最大取出数量
+     * @return 实际取出的元素数量
+     * @since 1.1.0
+     */
+    virtual size_t popBatch(std::pmr::vector<T>& items, size_t maxCount) = 0;
+
+    /**
+     * @brief 检查队列是否为空
+     * @return true表示为空
+     * @since 1.1.0
+     */
+    virtual bool empty() const = 0;
+
+    /**
+     * @brief 获取队列大小
+     * @return 元素数量，并发情况下为近似值
+     * @since 1.1.0
+     */
+    virtual size_t getSize() const = 0;
+
+    /**
+     * @brief 获取容量
+     * @return 槽位数量，0表示无界
+     * @since 1.1.0
+     */
+    virtual size_t getCapacity() const = 0;
+
+    /**
+     * @brief 获取每段的槽位数量
+     * @return 分段算法每段的槽位数量，其他算法为0
+     * @since 1.1.0
+     */
+    virtual size_t getSegmentSize() const = 0;
+
+    /**
+     * @brief 获取预先分配的字节数
+     * @details 分段算法随段的分配和释放变化，其他算法创建后不变
+     * @return 字节数
+     * @since 1.1.0
+     */
+    virtual size_t getFootprint() const = 0;
+
+    /**
+     * @brief 获取每个元素额外占用的字节数
+     * @return 链表算法为节点大小，分段算法和有界算法为0
+     * @since 1.1.0
+     */
+    virtual size_t getItemOverhead() const = 0;
+
+    /**
+     * @brief 获取内存来源
+     * @return 内存资源
+     * @since 1.1.0
+     */
+    virtual std::pmr::memory_resource* getMemoryResource() const = 0;
+
+    /**
+     * @brief 获取队列算法
+     * @return 算法
+     * @since 1.1.0
+     */
+    virtual QueueAlgorithm getAlgorithm() const = 0;
+
+    /**
+     * @brief 获取等待策略
+     * @return 等待策略
+     * @since 1.1.0
+     */
+    virtual QueueWaitStrategy getWaitStrategy() const = 0;
+};
+
+/**
+ * @brief 把具体队列包装为AnyQueue
+ * @tparam Queue LockFreeQueue的某个实例化
+ * @since 1.1.0
+ */
+template<typename Queue>
+class QueueAdapter final : public AnyQueue<typename Queue::value_type> {
+private:
+    using T = typename Queue::value_type;
+    using Filler = typename AnyQueue<T>::Filler;
+    using BatchFiller = typename AnyQueue<T>::BatchFiller;
+
+    Queue queue_;   ///< 被包装的队列
+
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] capacity 期望的槽位数量
+     * @param[in] resource 内存来源
+     * @since 1.1.0
      */
-    QueueNode<T>* createSentinel();
+    QueueAdapter(size_t capacity, std::pmr::memory_resource* resource) : queue_(capacity, resource) {
+    }
+
+    bool emplaceWith(Filler filler, void* context) override {
+        return queue_.emplace([filler, context](T& item) { filler(context, item); });
+    }
+
+    size_t emplaceBatchWith(size_t count, BatchFiller filler, void* context) override {
+        return queue_.emplaceBatch(count, [filler, context](T& item, size_t index, size_t claimed) {
+            filler(context, item, index, claimed);
+        });
+    }
+
+    bool push(T&& item) override {
+        return queue_.push(std::move(item));
+    }
+
+    bool pop(T& item) override {
+        return queue_.pop(item);
+    }
+
+    size_t popBatch(std::pmr::vector<T>& items, size_t maxCount) override {
+        return queue_.popBatch(items, maxCount);
+    }
+
+    bool empty() const override {
+        return queue_.empty();
+    }
+
+    size_t getSize() const override {
+        return queue_.getSize();
+    }
+
+    size_t getCapacity() const override {
+        return queue_.getCapacity();
+    }
+
+    size_t getSegmentSize() const override {
+        return queue_.getSegmentSize();
+    }
+
+    size_t getFootprint() const override {
+        return queue_.getFootprint();
+    }
+
+    size_t getItemOverhead() const override {
+        return Queue::ITEM_OVERHEAD;
+    }
+
+    std::pmr::memory_resource* getMemoryResource() const override {
+        return queue_.getMemoryResource();
+    }
+
+    QueueAlgorithm getAlgorithm() const override {
+        return Queue::algorithm_type::kind;
+    }
+
+    QueueWaitStrategy getWaitStrategy() const override {
+        return Queue::wait_type::kind;
+    }
 };
 
-// 模板类实现
+/**
+ * @brief 按运行期选择的算法和等待策略创建队列
+ * @param[in] algorithm 队列算法
+ * @param[in] wait 等待策略
+ * @param[in] capacity 有界算法的期望槽位数量或分段算法每段的槽位数量，向上取整为2的幂
+ * @param[in] resource 内存来源
+ * @return 新建的队列
+ * @tparam T 元素类型
+ * @since 1.1.0
+ */
 template<typename T>
-LockFreeQueue<T>::LockFreeQueue() : head_(nullptr), tail_(nullptr), size_(0) {
+std::unique_ptr<AnyQueue<T>> makeQueue(QueueAlgorithm algorithm, QueueWaitStrategy wait, size_t capacity,
+                                       std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+// 模板类实现
+template<typename T, typename Capacity>
+LinkedStorage<T, Capacity>::LinkedStorage(Capacity capacity, std::pmr::memory_resource* resource)
+    : head_(nullptr), tail_(nullptr), size_(0), resource_(resource) {
+    (void)capacity;
     // 创建哨兵节点
-    QueueNode<T>* sentinel = createSentinel();
+    QueueNode<T>* sentinel = createNode(T{});
     head_.store(sentinel);
     tail_.store(sentinel);
 }
 
-template<typename T>
-LockFreeQueue<T>::~LockFreeQueue() {
+template<typename T, typename Capacity>
+LinkedStorage<T, Capacity>::~LinkedStorage() {
     cleanup();
 }
 
-template<typename T>
-LockFreeQueue<T>::LockFreeQueue(LockFreeQueue&& other) noexcept 
-    : head_(other.head_.load()), tail_(other.tail_.load()), size_(other.size_.load()) {
+template<typename T, typename Capacity>
+LinkedStorage<T, Capacity>::LinkedStorage(LinkedStorage&& other) noexcept
+    : head_(other.head_.load()), tail_(other.tail_.load()), size_(other.size_.load()),
+      resource_(other.resource_) {
     other.head_.store(nullptr);
     other.tail_.store(nullptr);
     other.size_.store(0);
 }
 
-template<typename T>
-LockFreeQueue<T>& LockFreeQueue<T>::operator=(LockFreeQueue&& other) noexcept {
+template<typename T, typename Capacity>
+LinkedStorage<T, Capacity>& LinkedStorage<T, Capacity>::operator=(LinkedStorage&& other) noexcept {
     if (this != &other) {
         cleanup();
         head_.store(other.head_.load());
         tail_.store(other.tail_.load());
         size_.store(other.size_.load());
+        // 节点必须归还给分配它们的资源，因此资源随节点一起转移
+        resource_ = other.resource_;
         other.head_.store(nullptr);
         other.tail_.store(nullptr);
         other.size_.store(0);
@@ -197,126 +1431,776 @@ LockFreeQueue<T>& LockFreeQueue<T>::operator=(LockFreeQueue&& other) noexcept {
     return *this;
 }
 
-template<typename T>
-void LockFreeQueue<T>::push(const T& item) {
-    QueueNode<T>* newNode = new QueueNode<T>(item);
-    
+template<typename T, typename Capacity>
+template<typename Fill>
+bool LinkedStorage<T, Capacity>::tryEmplace(Fill&& fill) {
+    QueueNode<T>* newNode = createNode(T{});
+    fill(newNode->data);
+
     QueueNode<T>* oldTail = tail_.load();
     QueueNode<T>* expected = oldTail;
-    
+
     // 尝试更新尾指针
     while (!tail_.compare_exchange_weak(expected, newNode)) {
         oldTail = expected;
         expected = oldTail;
     }
-    
+
     // 更新前一个节点的next指针
     oldTail->next.store(newNode);
     size_.fetch_add(1);
+    return true;
 }
 
-template<typename T>
-void LockFreeQueue<T>::push(T&& item) {
-    QueueNode<T>* newNode = new QueueNode<T>(std::move(item));
-    
+template<typename T, typename Capacity>
+template<typename Fill>
+size_t LinkedStorage<T, Capacity>::tryEmplaceBatch(size_t count, Fill&& fill) {
+    // 先在本线程内串好整条链，再一次挂到队尾
+    QueueNode<T>* first = createNode(T{});
+    fill(first->data, 0, count);
+    QueueNode<T>* last = first;
+    for (size_t i = 1; i < count; ++i) {
+        QueueNode<T>* node = createNode(T{});
+        fill(node->data, i, count);
+        last->next.store(node, std::memory_order_relaxed);
+        last = node;
+    }
+
     QueueNode<T>* oldTail = tail_.load();
     QueueNode<T>* expected = oldTail;
-    
+
     // 尝试更新尾指针
-    while (!tail_.compare_exchange_weak(expected, newNode)) {
+    while (!tail_.compare_exchange_weak(expected, last)) {
         oldTail = expected;
         expected = oldTail;
     }
-    
-    // 更新前一个节点的next指针
-    oldTail->next.store(newNode);
-    size_.fetch_add(1);
+
+    // 链接整串节点，消费者沿next读到last为止
+    oldTail->next.store(first);
+    size_.fetch_add(count);
+    return count;
 }
 
-template<typename T>
-bool LockFreeQueue<T>::pop(T& item) {
+template<typename T, typename Capacity>
+bool LinkedStorage<T, Capacity>::tryPop(T& item) {
     QueueNode<T>* oldHead = head_.load();
     QueueNode<T>* oldTail = tail_.load();
-    
+
     // 检查队列是否为空
     if (oldHead == oldTail) {
         return false;
     }
-    
+
     QueueNode<T>* next = oldHead->next.load();
     if (next == nullptr) {
         return false;
     }
-    
+
     // 尝试更新头指针
     if (head_.compare_exchange_strong(oldHead, next)) {
         item = std::move(next->data);
-        delete oldHead;
+        destroyNode(oldHead);
         size_.fetch_sub(1);
         return true;
     }
-    
+
     return false;
 }
 
-template<typename T>
-bool LockFreeQueue<T>::empty() const {
+template<typename T, typename Capacity>
+bool LinkedStorage<T, Capacity>::empty() const {
     return head_.load() == tail_.load();
 }
 
-template<typename T>
-size_t LockFreeQueue<T>::getSize() const {
+template<typename T, typename Capacity>
+size_t LinkedStorage<T, Capacity>::getSize() const {
     return size_.load();
 }
 
-template<typename T>
-void LockFreeQueue<T>::pushBatch(const std::vector<T>& items) {
-    for (const auto& item : items) {
-        push(item);
-    }
+template<typename T, typename Capacity>
+size_t LinkedStorage<T, Capacity>::getCapacity() const {
+    return 0;
 }
 
-template<typename T>
-size_t LockFreeQueue<T>::popBatch(std::vector<T>& items, size_t maxCount) {
-    items.clear();
-    items.reserve(maxCount);
-    
-    size_t count = 0;
-    T item;
-    
-    while (count < maxCount && pop(item)) {
-        items.push_back(std::move(item));
-        count++;
-    }
-    
-    return count;
+template<typename T, typename Capacity>
+size_t LinkedStorage<T, Capacity>::getFootprint() const {
+    return 0;
 }
 
-template<typename T>
-void LockFreeQueue<T>::clear() {
-    T item;
-    while (pop(item)) {
-        // 清空所有元素
-    }
+template<typename T, typename Capacity>
+std::pmr::memory_resource* LinkedStorage<T, Capacity>::getMemoryResource() const {
+    return resource_;
 }
 
-template<typename T>
-void LockFreeQueue<T>::cleanup() {
+template<typename T, typename Capacity>
+void LinkedStorage<T, Capacity>::cleanup() {
     T item;
-    while (pop(item)) {
+    while (tryPop(item)) {
         // 清理所有元素
     }
-    
+
     // 删除哨兵节点
     QueueNode<T>* sentinel = head_.load();
     if (sentinel) {
-        delete sentinel;
+        destroyNode(sentinel);
+    }
+}
+
+template<typename T, typename Capacity>
+template<typename U>
+QueueNode<T>* LinkedStorage<T, Capacity>::createNode(U&& item) {
+    NodeAllocator allocator(resource_);
+    QueueNode<T>* node = allocator.allocate(1);
+    try {
+        ::new (static_cast<void*>(node)) QueueNode<T>(std::forward<U>(item));
+    } catch (...) {
+        allocator.deallocate(node, 1);
+        throw;
+    }
+    return node;
+}
+
+template<typename T, typename Capacity>
+void LinkedStorage<T, Capacity>::destroyNode(QueueNode<T>* node) {
+    NodeAllocator allocator(resource_);
+    node->~QueueNode<T>();
+    allocator.deallocate(node, 1);
+}
+
+template<typename T, typename Capacity, bool SingleConsumer>
+RingStorage<T, Capacity, SingleConsumer>::RingStorage(Capacity capacity, std::pmr::memory_resource* resource)
+    : capacity_(capacity), slots_(nullptr), resource_(resource), enqueuePos_(0), dequeuePos_(0) {
+    SlotAllocator allocator(resource_);
+    slots_ = allocator.allocate(capacity_.value());
+
+    for (size_t i = 0; i < capacity_.value(); ++i) {
+        Slot* slot = ::new (static_cast<void*>(&slots_[i])) Slot();
+        slot->sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template<typename T, typename Capacity, bool SingleConsumer>
+RingStorage<T, Capacity, SingleConsumer>::~RingStorage() {
+    for (size_t i = 0; i < capacity_.value(); ++i) {
+        slots_[i].~Slot();
+    }
+
+    SlotAllocator allocator(resource_);
+    allocator.deallocate(slots_, capacity_.value());
+}
+
+template<typename T, typename Capacity, bool SingleConsumer>
+template<typename Fill>
+bool RingStorage<T, Capacity, SingleConsumer>::tryEmplace(Fill&& fill) {
+    const size_t mask = capacity_.value() - 1;
+    size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+
+    for (;;) {
+        Slot& slot = slots_[pos & mask];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+        if (diff == 0) {
+            // 槽位空闲，尝试占用
+            if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                fill(slot.value);
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            // 槽位仍被上一轮占用，队列已满
+            return false;
+        } else {
+            pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template<typename T, typename Capacity, bool SingleConsumer>
+template<typename Fill>
+size_t RingStorage<T, Capacity, SingleConsumer>::tryEmplaceBatch(size_t count, Fill&& fill) {
+    const size_t mask = capacity_.value() - 1;
+    count = count < capacity_.value() ? count : capacity_.value();
+    size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+
+    for (;;) {
+        // 统计从pos开始连续空闲的槽位；空闲槽位只会被持有对应位置的生产者改写，占用位置后仍然空闲
+        size_t free = 0;
+        while (free < count) {
+            size_t sequence = slots_[(pos + free) & mask].sequence.load(std::memory_order_acquire);
+            if (sequence != pos + free) {
+                break;
+            }
+            free++;
+        }
+
+        if (free == 0) {
+            size_t sequence = slots_[pos & mask].sequence.load(std::memory_order_acquire);
+            if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos) < 0) {
+                // 槽位仍被上一轮占用，队列已满
+                return 0;
+            }
+            pos = enqueuePos_.load(std::memory_order_relaxed);
+            continue;
+        }
+
+        if (enqueuePos_.compare_exchange_weak(pos, pos + free, std::memory_order_relaxed)) {
+            for (size_t i = 0; i < free; ++i) {
+                Slot& slot = slots_[(pos + i) & mask];
+                fill(slot.value, i, free);
+                slot.sequence.store(pos + i + 1, std::memory_order_release);
+            }
+            return free;
+        }
+    }
+}
+
+template<typename T, typename Capacity, bool SingleConsumer>
+bool RingStorage<T, Capacity, SingleConsumer>::tryPop(T& item) {
+    const size_t mask = capacity_.value() - 1;
+
+    if constexpr (SingleConsumer) {
+        // 出队位置只有本线程写，不需要CAS
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[pos & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+            return false;
+        }
+
+        item = std::move(slot.value);
+        slot.sequence.store(pos + mask + 1, std::memory_order_release);
+        dequeuePos_.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    } else {
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+
+        for (;;) {
+            Slot& slot = slots_[pos & mask];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+
+            if (diff == 0) {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    item = std::move(slot.value);
+                    // 归还槽位给下一轮生产者
+                    slot.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // 槽位尚未发布，队列为空
+                return false;
+            } else {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+template<typename T, typename Capacity, bool SingleConsumer>
+bool RingStorage<T, Capacity, SingleConsumer>::empty() const {
+    return getSize() == 0;
+}
+
+template<typename T, typename Capacity, bool SingleConsumer>
+size_t RingStorage<T, Capacity, SingleConsumer>::getSize() const {
+    size_t enqueued = enqueuePos_.load(std::memory_order_relaxed);
+    size_t dequeued = dequeuePos_.load(std::memory_order_relaxed);
+    return enqueued > dequeued ? enqueued - dequeued : 0;
+}
+
+template<typename T, typename Capacity, bool SingleConsumer>
+size_t RingStorage<T, Capacity, SingleConsumer>::getCapacity() const {
+    return capacity_.value();
+}
+
+template<typename T, typename Capacity, bool SingleConsumer>
+size_t RingStorage<T, Capacity, SingleConsumer>::getFootprint() const {
+    return capacity_.value() * sizeof(Slot);
+}
+
+template<typename T, typename Capacity, bool SingleConsumer>
+std::pmr::memory_resource* RingStorage<T, Capacity, SingleConsumer>::getMemoryResource() const {
+    return resource_;
+}
+
+template<typename T, typename Capacity>
+TicketRingStorage<T, Capacity>::TicketRingStorage(Capacity capacity, std::pmr::memory_resource* resource)
+    : capacity_(capacity), slots_(nullptr), resource_(resource), enqueuePos_(0), dequeuePos_(0) {
+    SlotAllocator allocator(resource_);
+    slots_ = allocator.allocate(capacity_.value());
+
+    for (size_t i = 0; i < capacity_.value(); ++i) {
+        Slot* slot = ::new (static_cast<void*>(&slots_[i])) Slot();
+        slot->state.store(i * 4 + FREE, std::memory_order_relaxed);
+        slot->abandoned.store(0, std::memory_order_relaxed);
+    }
+}
+
+template<typename T, typename Capacity>
+TicketRingStorage<T, Capacity>::~TicketRingStorage() {
+    for (size_t i = 0; i < capacity_.value(); ++i) {
+        slots_[i].~Slot();
+    }
+
+    SlotAllocator allocator(resource_);
+    allocator.deallocate(slots_, capacity_.value());
+}
+
+template<typename T, typename Capacity>
+template<typename Fill>
+bool TicketRingStorage<T, Capacity>::tryEmplace(Fill&& fill) {
+    const size_t mask = capacity_.value() - 1;
+
+    // 下一个票号的槽位仍属于上一轮时队列已满，不领取票号
+    size_t next = enqueuePos_.load(std::memory_order_relaxed);
+    if (slots_[next & mask].state.load(std::memory_order_relaxed) / 4 < next) {
+        return false;
+    }
+
+    size_t ticket = enqueuePos_.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots_[ticket & mask];
+
+    // 只尝试一次：失败说明槽位仍被上一轮占用，或消费者已经跳过了这个票号
+    size_t expected = ticket * 4 + FREE;
+    if (!slot.state.compare_exchange_strong(expected, ticket * 4 + BUSY, std::memory_order_acquire)) {
+        markAbandoned(slot, ticket);
+        return false;
+    }
+
+    fill(slot.value);
+    slot.state.store(ticket * 4 + PUBLISHED, std::memory_order_release);
+    return true;
+}
+
+template<typename T, typename Capacity>
+template<typename Fill>
+size_t TicketRingStorage<T, Capacity>::tryEmplaceBatch(size_t count, Fill&& fill) {
+    const size_t mask = capacity_.value() - 1;
+    count = count < capacity_.value() ? count : capacity_.value();
+
+    // 消费者按顺序释放槽位，整批最后一个票号的槽位空闲时前面的通常也已空闲
+    size_t next = enqueuePos_.load(std::memory_order_relaxed);
+    if (slots_[next & mask].state.load(std::memory_order_relaxed) / 4 < next) {
+        return 0;
+    }
+    size_t lastTicket = next + count - 1;
+    while (count > 1 && slots_[lastTicket & mask].state.load(std::memory_order_relaxed) / 4 < lastTicket) {
+        count--;
+        lastTicket--;
+    }
+
+    size_t ticket = enqueuePos_.fetch_add(count, std::memory_order_relaxed);
+
+    size_t claimed = 0;
+    while (claimed < count) {
+        size_t expected = (ticket + claimed) * 4 + FREE;
+        if (!slots_[(ticket + claimed) & mask].state.compare_exchange_strong(
+                expected, (ticket + claimed) * 4 + BUSY, std::memory_order_acquire)) {
+            break;
+        }
+        claimed++;
+    }
+
+    // 保持只入队开头一部分的语义：第一个失败的票号之后的票号一并放弃
+    for (size_t i = claimed; i < count; ++i) {
+        markAbandoned(slots_[(ticket + i) & mask], ticket + i);
+    }
+
+    for (size_t i = 0; i < claimed; ++i) {
+        Slot& slot = slots_[(ticket + i) & mask];
+        fill(slot.value, i, claimed);
+        slot.state.store((ticket + i) * 4 + PUBLISHED, std::memory_order_release);
+    }
+    return claimed;
+}
+
+template<typename T, typename Capacity>
+bool TicketRingStorage<T, Capacity>::tryPop(T& item) {
+    const size_t mask = capacity_.value() - 1;
+    size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+
+    for (;;) {
+        Slot& slot = slots_[pos & mask];
+        size_t state = slot.state.load(std::memory_order_acquire);
+
+        if (state == pos * 4 + PUBLISHED) {
+            item = std::move(slot.value);
+            slot.state.store((pos + mask + 1) * 4 + FREE, std::memory_order_release);
+            dequeuePos_.store(pos + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        // 本槽位上有不早于pos的票号被放弃：pos的生产者要么已放弃，要么尚未占用槽位，
+        // 抢先把槽位交给下一轮，后者的CAS会失败并放弃（此时队列刚刚溢出过）
+        if (state != pos * 4 + FREE || slot.abandoned.load(std::memory_order_acquire) <= pos) {
+            return false;
+        }
+
+        size_t expected = state;
+        if (!slot.state.compare_exchange_strong(expected, (pos + mask + 1) * 4 + FREE,
+                                                std::memory_order_acq_rel)) {
+            // 生产者抢先占用了槽位，等它发布
+            return false;
+        }
+
+        pos++;
+        dequeuePos_.store(pos, std::memory_order_relaxed);
+    }
+}
+
+template<typename T, typename Capacity>
+bool TicketRingStorage<T, Capacity>::empty() const {
+    return getSize() == 0;
+}
+
+template<typename T, typename Capacity>
+size_t TicketRingStorage<T, Capacity>::getSize() const {
+    size_t enqueued = enqueuePos_.load(std::memory_order_relaxed);
+    size_t dequeued = dequeuePos_.load(std::memory_order_relaxed);
+    return enqueued > dequeued ? enqueued - dequeued : 0;
+}
+
+template<typename T, typename Capacity>
+size_t TicketRingStorage<T, Capacity>::getCapacity() const {
+    return capacity_.value();
+}
+
+template<typename T, typename Capacity>
+size_t TicketRingStorage<T, Capacity>::getFootprint() const {
+    return capacity_.value() * sizeof(Slot);
+}
+
+template<typename T, typename Capacity>
+std::pmr::memory_resource* TicketRingStorage<T, Capacity>::getMemoryResource() const {
+    return resource_;
+}
+
+template<typename T, typename Capacity>
+void TicketRingStorage<T, Capacity>::markAbandoned(Slot& slot, size_t ticket) {
+    size_t current = slot.abandoned.load(std::memory_order_relaxed);
+    while (current <= ticket &&
+           !slot.abandoned.compare_exchange_weak(current, ticket + 1, std::memory_order_release)) {
+        // current已更新为最新值
+    }
+}
+
+template<typename T, typename Capacity>
+SegmentedStorage<T, Capacity>::SegmentedStorage(Capacity segmentSize, std::pmr::memory_resource* resource)
+    : segmentSize_(segmentSize), segmentShift_(0), directory_(nullptr), resource_(resource), pool_(resource),
+      head_(nullptr), headId_(NO_SEGMENT), spare_(nullptr), returned_(nullptr), enqueuePos_(0), dequeuePos_(0),
+      segmentCount_(0) {
+    while ((size_t(1) << segmentShift_) < segmentSize_.value()) {
+        segmentShift_++;
+    }
+
+    EntryAllocator allocator(resource_);
+    directory_ = allocator.allocate(DIRECTORY_SIZE);
+    for (size_t i = 0; i < DIRECTORY_SIZE; ++i) {
+        DirectoryEntry* entry = ::new (static_cast<void*>(&directory_[i])) DirectoryEntry();
+        entry->id.store(NO_SEGMENT, std::memory_order_relaxed);
+        entry->segment.store(nullptr, std::memory_order_relaxed);
+    }
+
+    // 回收时不再分配，池的push_back不会抛出
+    pool_.reserve(POOL_LIMIT);
+
+    directory_[0].segment.store(createSegment(), std::memory_order_relaxed);
+    directory_[0].id.store(0, std::memory_order_relaxed);
+}
+
+template<typename T, typename Capacity>
+SegmentedStorage<T, Capacity>::~SegmentedStorage() {
+    for (size_t i = 0; i < DIRECTORY_SIZE; ++i) {
+        if (Segment* segment = directory_[i].segment.load(std::memory_order_relaxed)) {
+            destroySegment(segment);
+        }
+        directory_[i].~DirectoryEntry();
+    }
+
+    EntryAllocator allocator(resource_);
+    allocator.deallocate(directory_, DIRECTORY_SIZE);
+
+    if (Segment* segment = spare_.load(std::memory_order_relaxed)) {
+        destroySegment(segment);
+    }
+
+    Segment* segment = returned_.load(std::memory_order_relaxed);
+    while (segment) {
+        Segment* next = segment->next;
+        destroySegment(segment);
+        segment = next;
+    }
+
+    for (Segment* pooled : pool_) {
+        destroySegment(pooled);
+    }
+}
+
+template<typename T, typename Capacity>
+template<typename Fill>
+bool SegmentedStorage<T, Capacity>::tryEmplace(Fill&& fill) {
+    if (isDirectoryFull(1)) {
+        return false;
+    }
+
+    size_t ticket = enqueuePos_.fetch_add(1, std::memory_order_relaxed);
+    Segment* segment = segmentFor(ticket >> segmentShift_);
+    Slot& slot = segment->slots[ticket & (segmentSize_.value() - 1)];
+
+    fill(slot.value);
+    slot.ticket.store(ticket + 1, std::memory_order_release);
+    return true;
+}
+
+template<typename T, typename Capacity>
+template<typename Fill>
+size_t SegmentedStorage<T, Capacity>::tryEmplaceBatch(size_t count, Fill&& fill) {
+    count = count < segmentSize_.value() ? count : segmentSize_.value();
+    if (count == 0 || isDirectoryFull(count)) {
+        return 0;
+    }
+
+    size_t ticket = enqueuePos_.fetch_add(count, std::memory_order_relaxed);
+
+    // 一批最多跨两段，换段时才查目录
+    size_t id = NO_SEGMENT;
+    Segment* segment = nullptr;
+    for (size_t i = 0; i < count; ++i) {
+        size_t current = ticket + i;
+        if ((current >> segmentShift_) != id) {
+            id = current >> segmentShift_;
+            segment = segmentFor(id);
+        }
+
+        Slot& slot = segment->slots[current & (segmentSize_.value() - 1)];
+        fill(slot.value, i, count);
+        slot.ticket.store(current + 1, std::memory_order_release);
+    }
+    return count;
+}
+
+template<typename T, typename Capacity>
+bool SegmentedStorage<T, Capacity>::tryPop(T& item) {
+    size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+    size_t id = pos >> segmentShift_;
+
+    if (headId_ != id) {
+        DirectoryEntry& entry = directory_[id % DIRECTORY_SIZE];
+        if (entry.id.load(std::memory_order_acquire) != id) {
+            // 新段尚未登记
+            return false;
+        }
+        head_ = entry.segment.load(std::memory_order_relaxed);
+        headId_ = id;
+    }
+
+    Slot& slot = head_->slots[pos & (segmentSize_.value() - 1)];
+    if (slot.ticket.load(std::memory_order_acquire) != pos + 1) {
+        return false;
+    }
+
+    item = std::move(slot.value);
+    dequeuePos_.store(pos + 1, std::memory_order_relaxed);
+
+    // 本段的票号都已出队，不会再有生产者访问它
+    if (((pos + 1) & (segmentSize_.value() - 1)) == 0) {
+        retire(head_, id);
+        head_ = nullptr;
+        headId_ = NO_SEGMENT;
+    }
+    return true;
+}
+
+template<typename T, typename Capacity>
+bool SegmentedStorage<T, Capacity>::empty() const {
+    return getSize() == 0;
+}
+
+template<typename T, typename Capacity>
+size_t SegmentedStorage<T, Capacity>::getSize() const {
+    size_t enqueued = enqueuePos_.load(std::memory_order_relaxed);
+    size_t dequeued = dequeuePos_.load(std::memory_order_relaxed);
+    return enqueued > dequeued ? enqueued - dequeued : 0;
+}
+
+template<typename T, typename Capacity>
+size_t SegmentedStorage<T, Capacity>::getCapacity() const {
+    return 0;
+}
+
+template<typename T, typename Capacity>
+size_t SegmentedStorage<T, Capacity>::getSegmentSize() const {
+    return segmentSize_.value();
+}
+
+template<typename T, typename Capacity>
+size_t SegmentedStorage<T, Capacity>::getFootprint() const {
+    size_t segmentBytes = sizeof(Segment) + segmentSize_.value() * sizeof(Slot);
+    return DIRECTORY_SIZE * sizeof(DirectoryEntry) + segmentCount_.load(std::memory_order_relaxed) * segmentBytes;
+}
+
+template<typename T, typename Capacity>
+std::pmr::memory_resource* SegmentedStorage<T, Capacity>::getMemoryResource() const {
+    return resource_;
+}
+
+template<typename T, typename Capacity>
+typename SegmentedStorage<T, Capacity>::Segment* SegmentedStorage<T, Capacity>::segmentFor(size_t id) {
+    DirectoryEntry& entry = directory_[id % DIRECTORY_SIZE];
+
+    for (;;) {
+        if (entry.id.load(std::memory_order_acquire) == id) {
+            return entry.segment.load(std::memory_order_relaxed);
+        }
+
+        Segment* current = entry.segment.load(std::memory_order_acquire);
+        if (current == nullptr) {
+            Segment* fresh = takeSpare();
+            if (entry.segment.compare_exchange_strong(current, fresh, std::memory_order_acq_rel)) {
+                entry.id.store(id, std::memory_order_release);
+                return fresh;
+            }
+            giveBack(fresh);
+            continue;
+        }
+
+        // 其他生产者正在登记本段，或者目录项仍被更早的段占用，等待对方完成或消费者取空
+        std::this_thread::yield();
+    }
+}
+
+template<typename T, typename Capacity>
+bool SegmentedStorage<T, Capacity>::isDirectoryFull(size_t count) const {
+    // 留出一段的余量给同时领取票号的生产者
+    size_t last = enqueuePos_.load(std::memory_order_relaxed) + count;
+    size_t first = dequeuePos_.load(std::memory_order_relaxed);
+    return (last >> segmentShift_) - (first >> segmentShift_) >= DIRECTORY_SIZE - 1;
+}
+
+template<typename T, typename Capacity>
+typename SegmentedStorage<T, Capacity>::Segment* SegmentedStorage<T, Capacity>::takeSpare() {
+    if (Segment* segment = spare_.exchange(nullptr, std::memory_order_acquire)) {
+        return segment;
+    }
+    return createSegment();
+}
+
+template<typename T, typename Capacity>
+void SegmentedStorage<T, Capacity>::giveBack(Segment* segment) {
+    // 只有消费者整体取走，压栈不存在ABA问题
+    Segment* head = returned_.load(std::memory_order_relaxed);
+    do {
+        segment->next = head;
+    } while (!returned_.compare_exchange_weak(head, segment, std::memory_order_release,
+                                              std::memory_order_relaxed));
+}
+
+template<typename T, typename Capacity>
+void SegmentedStorage<T, Capacity>::retire(Segment* segment, size_t id) {
+    DirectoryEntry& entry = directory_[id % DIRECTORY_SIZE];
+    entry.id.store(NO_SEGMENT, std::memory_order_relaxed);
+    entry.segment.store(nullptr, std::memory_order_release);
+    recycle(segment);
+
+    Segment* returned = returned_.exchange(nullptr, std::memory_order_acquire);
+    while (returned) {
+        Segment* next = returned->next;
+        recycle(returned);
+        returned = next;
+    }
+
+    // 备好下一个空闲段，走到新段的生产者不必分配
+    if (!pool_.empty() && spare_.load(std::memory_order_relaxed) == nullptr) {
+        Segment* expected = nullptr;
+        if (spare_.compare_exchange_strong(expected, pool_.back(), std::memory_order_release)) {
+            pool_.pop_back();
+        }
+    }
+}
+
+template<typename T, typename Capacity>
+void SegmentedStorage<T, Capacity>::recycle(Segment* segment) {
+    if (pool_.size() < POOL_LIMIT) {
+        pool_.push_back(segment);
+    } else {
+        destroySegment(segment);
+    }
+}
+
+template<typename T, typename Capacity>
+typename SegmentedStorage<T, Capacity>::Segment* SegmentedStorage<T, Capacity>::createSegment() {
+    SlotAllocator slotAllocator(resource_);
+    Slot* slots = slotAllocator.allocate(segmentSize_.value());
+    for (size_t i = 0; i < segmentSize_.value(); ++i) {
+        Slot* slot = ::new (static_cast<void*>(&slots[i])) Slot();
+        slot->ticket.store(0, std::memory_order_relaxed);
+    }
+
+    SegmentAllocator segmentAllocator(resource_);
+    Segment* segment = segmentAllocator.allocate(1);
+    segment->next = nullptr;
+    segment->slots = slots;
+    segmentCount_.fetch_add(1, std::memory_order_relaxed);
+    return segment;
+}
+
+template<typename T, typename Capacity>
+void SegmentedStorage<T, Capacity>::destroySegment(Segment* segment) {
+    for (size_t i = 0; i < segmentSize_.value(); ++i) {
+        segment->slots[i].~Slot();
+    }
+
+    SlotAllocator slotAllocator(resource_);
+    slotAllocator.deallocate(segment->slots, segmentSize_.value());
+
+    SegmentAllocator segmentAllocator(resource_);
+    segmentAllocator.deallocate(segment, 1);
+    segmentCount_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+namespace queue_detail {
+
+/**
+ * @brief 按等待策略选择算法后创建队列
+ * @tparam T 元素类型
+ * @tparam Wait 等待策略
+ * @since 1.1.0
+ */
+template<typename T, typename Wait>
+std::unique_ptr<AnyQueue<T>> makeQueueWith(QueueAlgorithm algorithm, size_t capacity,
+                                           std::pmr::memory_resource* resource) {
+    switch (algorithm) {
+        case QueueAlgorithm::BOUNDED_MPMC:
+            return std::make_unique<QueueAdapter<LockFreeQueue<T, BoundedMpmcAlgorithm, RuntimeCapacity, Wait>>>(
+                capacity, resource);
+        case QueueAlgorithm::MPSC_RING:
+            return std::make_unique<QueueAdapter<LockFreeQueue<T, MpscRingAlgorithm, RuntimeCapacity, Wait>>>(
+                capacity, resource);
+        case QueueAlgorithm::TICKET_RING:
+            return std::make_unique<QueueAdapter<LockFreeQueue<T, TicketRingAlgorithm, RuntimeCapacity, Wait>>>(
+                capacity, resource);
+        case QueueAlgorithm::SEGMENTED:
+            return std::make_unique<QueueAdapter<LockFreeQueue<T, SegmentedAlgorithm, RuntimeCapacity, Wait>>>(
+                capacity, resource);
+        default:
+            return std::make_unique<QueueAdapter<LockFreeQueue<T, LinkedAlgorithm, RuntimeCapacity, Wait>>>(
+                capacity, resource);
     }
 }
 
+} // namespace queue_detail
+
 template<typename T>
-QueueNode<T>* LockFreeQueue<T>::createSentinel() {
-    return new QueueNode<T>(T{});
+std::unique_ptr<AnyQueue<T>> makeQueue(QueueAlgorithm algorithm, QueueWaitStrategy wait, size_t capacity,
+                                       std::pmr::memory_resource* resource) {
+    switch (wait) {
+        case QueueWaitStrategy::SPIN:
+            return queue_detail::makeQueueWith<T, SpinWait>(algorithm, capacity, resource);
+        case QueueWaitStrategy::YIELD:
+            return queue_detail::makeQueueWith<T, YieldWait>(algorithm, capacity, resource);
+        default:
+            return queue_detail::makeQueueWith<T, NoWait>(algorithm, capacity, resource);
+    }
 }
 
 } // namespace async_log
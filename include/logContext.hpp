@@ -0,0 +1,154 @@
+/**
+ * @file logContext.hpp
+ * @brief 线程本地诊断上下文（MDC）
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 每个线程维护一个键值对上下文栈（如请求ID、租户、用户），通过作用域对象压栈和出栈。
+ *          上下文栈由不可变节点组成，日志记录只保存栈顶节点的共享指针作为快照，
+ *          生产者不做任何字符串拼接，由工作线程上的格式化器展开
+ * @see LogMessage, formatLogLine
+ * @since 1.1.0
+ */
+
+#pragma once
+
+#include "logTypes.hpp"
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+namespace async_log {
+
+/**
+ * @brief 上下文节点
+ * @details 节点创建后不再修改，多个快照可以安全地共享同一条节点链
+ * @since 1.1.0
+ */
+struct LogContextNode {
+    LogContextRef parent;   ///< 外层上下文，为空表示栈底
+    StringId keyId;         ///< 驻留的键
+    std::string value;      ///< 值
+
+    /**
+     * @brief 构造函数
+     * @param[in] outer 外层上下文
+     * @param[in] key 驻留的键
+     * @param[in] val 值
+     * @since 1.1.0
+     */
+    LogContextNode(LogContextRef outer, StringId key, std::string val)
+        : parent(std::move(outer)), keyId(key), value(std::move(val)) {}
+};
+
+/**
+ * @brief 诊断上下文访问类
+ * @details 提供当前线程上下文的读取以及快照的查询和格式化
+ * @since 1.1.0
+ */
+class LogContext {
+public:
+    /**
+     * @brief 获取当前线程的上下文快照
+     * @return 栈顶节点，没有上下文时为空
+     * @note 返回的引用只在当前作用域未结束前有效，需要保存时应复制
+     * @since 1.1.0
+     */
+    static const LogContextRef& current();
+
+    /**
+     * @brief 在快照中查找键对应的值
+     * @details 内层的同名键会遮蔽外层
+     * @param[in] context 上下文快照
+     * @param[in] key 键
+     * @return 值的指针，不存在时返回nullptr
+     * @since 1.1.0
+     */
+    static const std::string* find(const LogContextRef& context, std::string_view key);
+
+    /**
+     * @brief 按驻留的键ID在快照中查找值
+     * @details 供预先驻留键名的调用方（如过滤表达式）在热路径上使用，不需要查询驻留表
+     * @param[in] context 上下文快照
+     * @param[in] keyId 驻留的键
+     * @return 值的指针，不存在时返回nullptr
+     * @since 1.1.0
+     */
+    static const std::string* find(const LogContextRef& context, StringId keyId);
+
+    /**
+     * @brief 将快照格式化为"{k1=v1 k2=v2}"并追加到输出
+     * @details 按压栈顺序由外到内输出；快照为空时不追加任何内容
+     * @param[in] context 上下文快照
+     * @param[in,out] out 输出缓冲区
+     * @since 1.1.0
+     */
+    static void format(const LogContextRef& context, std::pmr::string& out);
+
+    /**
+     * @brief 将快照格式化为字符串
+     * @param[in] context 上下文快照
+     * @return 格式化结果，快照为空时返回空字符串
+     * @since 1.1.0
+     */
+    static std::string toString(const LogContextRef& context);
+
+private:
+    friend class ScopedLogContext;
+
+    /**
+     * @brief 获取当前线程的上下文栈顶
+     * @return 可修改的栈顶引用
+     * @since 1.1.0
+     */
+    static LogContextRef& top();
+
+    /**
+     * @brief 由外到内追加节点链
+     * @param[in] node 当前节点
+     * @param[in,out] out 输出缓冲区
+     * @since 1.1.0
+     */
+    static void appendNodes(const LogContextNode* node, std::pmr::string& out);
+};
+
+/**
+ * @brief 作用域上下文
+ * @details 构造时压入一个键值对，析构时恢复为压入前的上下文。
+ *          必须按后进先出的顺序使用，且不能跨线程移动
+ * @since 1.1.0
+ */
+class ScopedLogContext {
+private:
+    LogContextRef previous_;   ///< 压入前的上下文
+
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] key 键，会被驻留，应使用固定的名称
+     * @param[in] value 值
+     * @since 1.1.0
+     */
+    ScopedLogContext(std::string_view key, std::string value);
+
+    /**
+     * @brief 析构函数，恢复压入前的上下文
+     * @since 1.1.0
+     */
+    ~ScopedLogContext();
+
+    // 禁用拷贝和移动
+    ScopedLogContext(const ScopedLogContext&) = delete;
+    ScopedLogContext& operator=(const ScopedLogContext&) = delete;
+};
+
+} // namespace async_log
+
+// 内部使用的标识符拼接宏
+#define ASYNC_LOG_CONCAT_INNER_(a, b) a##b
+#define ASYNC_LOG_CONCAT_(a, b) ASYNC_LOG_CONCAT_INNER_(a, b)
+
+// 在当前作用域内为本线程的日志附加一个键值对，例如 LOG_CONTEXT("requestId", id);
+#define LOG_CONTEXT(key, value) \
+    async_log::ScopedLogContext ASYNC_LOG_CONCAT_(asyncLogContext_, __COUNTER__)(key, value)
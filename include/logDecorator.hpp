@@ -14,6 +14,8 @@
 
 #include "logOutput.hpp"
 #include "logTypes.hpp"
+#include "logFilter.hpp"
+#include "redactionMatcher.hpp"
 #include <memory>
 #include <string>
 #include <regex>
@@ -22,7 +24,8 @@ namespace async_log {
 
 /**
  * @brief 基础装饰器类
- * @details 装饰器模式的基类，包装ILogOutput接口
+ * @details 装饰器模式的基类，包装ILogOutput接口。基类不支持format()，
+ *          只重写write()的子类在并行格式化流水线中仍由写出线程逐条调用write()
  * @note 此实现是线程安全的
  * @since 1.0.0
  */
@@ -46,7 +49,18 @@ public:
     
     // 基础接口实现
     void write(const LogMessage& msg) override;
+    
+    /**
+     * @brief 把format()生成的文本交给被装饰的输出写出
+     * @details 子类的format()最终由被装饰的输出生成文本，写出同样由它完成
+     * @param[in] text 格式化文本
+     * @since 1.1.0
+     */
+    void writeFormatted(const std::pmr::string& text) override;
+    
     void flush() override;
+    void sync() override;
+    void reopen() override;
     void close() override;
     bool isAvailable() const override;
     
@@ -85,6 +99,7 @@ public:
                       const std::string& timeFormat = "%Y-%m-%d %H:%M:%S");
     
     void write(const LogMessage& msg) override;
+    bool format(const LogMessage& msg, std::pmr::string& out) const override;
     
     /**
      * @brief 设置时间格式
@@ -106,7 +121,7 @@ private:
      * @return 格式化的时间戳字符串
      * @since 1.0.0
      */
-    std::string getCurrentTimestamp();
+    std::string getCurrentTimestamp() const;
     
     /**
      * @brief 格式化时间
@@ -114,7 +129,7 @@ private:
      * @return 格式化的时间字符串
      * @since 1.0.0
      */
-    std::string formatTime(const std::chrono::system_clock::time_point& timePoint);
+    std::string formatTime(const std::chrono::system_clock::time_point& timePoint) const;
 };
 
 /**
@@ -136,6 +151,7 @@ public:
     explicit ColorDecorator(std::unique_ptr<ILogOutput> output, bool enableColor = true);
     
     void write(const LogMessage& msg) override;
+    bool format(const LogMessage& msg, std::pmr::string& out) const override;
     
     /**
      * @brief 设置颜色启用状态
@@ -158,14 +174,14 @@ private:
      * @return ANSI颜色代码字符串
      * @since 1.0.0
      */
-    std::string getColorCode(LogLevel level);
+    std::string getColorCode(LogLevel level) const;
     
     /**
      * @brief 重置颜色代码
      * @return ANSI重置颜色代码字符串
      * @since 1.0.0
      */
-    std::string getResetCode();
+    std::string getResetCode() const;
 };
 
 /**
@@ -191,6 +207,7 @@ public:
                         size_t minSize = 1024);
     
     void write(const LogMessage& msg) override;
+    bool format(const LogMessage& msg, std::pmr::string& out) const override;
     
     /**
      * @brief 设置压缩启用状态
@@ -213,7 +230,7 @@ private:
      * @return 压缩后的数据
      * @since 1.0.0
      */
-    std::string compress(const std::string& data);
+    std::string compress(const std::string& data) const;
     
     /**
      * @brief 解压数据
@@ -232,6 +249,7 @@ private:
 class FilterDecorator : public LogDecorator {
 private:
     std::function<bool(const LogMessage&)> filter_;  ///< 过滤函数
+    std::shared_ptr<const LogFilter> expression_;    ///< 编译后的过滤表达式，通过原子操作读写以支持热更新
     
 public:
     /**
@@ -243,7 +261,17 @@ public:
     FilterDecorator(std::unique_ptr<ILogOutput> output, 
                    std::function<bool(const LogMessage&)> filter);
     
+    /**
+     * @brief 使用过滤表达式构造
+     * @param[in] output 要装饰的输出对象
+     * @param[in] expression 编译后的过滤表达式
+     * @since 1.1.0
+     */
+    FilterDecorator(std::unique_ptr<ILogOutput> output, 
+                   std::shared_ptr<const LogFilter> expression);
+    
     void write(const LogMessage& msg) override;
+    bool format(const LogMessage& msg, std::pmr::string& out) const override;
     
     /**
      * @brief 设置过滤函数
@@ -258,6 +286,16 @@ public:
      */
     void clearFilter();
     
+    /**
+     * @brief 设置过滤表达式
+     * @details 编译成功后原子替换当前表达式；与过滤函数同时生效
+     * @param[in] expression 表达式文本，空字符串表示清除
+     * @param[out] error 编译失败时写入错误描述，可为nullptr
+     * @return true表示成功，false表示语法错误（原有表达式保持不变）
+     * @since 1.1.0
+     */
+    bool setFilterExpression(const std::string& expression, std::string* error = nullptr);
+    
 private:
     /**
      * @brief 检查消息是否应该通过
@@ -265,12 +303,66 @@ private:
      * @return true表示应该通过，false表示应该过滤
      * @since 1.0.0
      */
-    bool shouldPass(const LogMessage& msg);
+    bool shouldPass(const LogMessage& msg) const;
+};
+
+/**
+ * @brief 打码装饰器
+ * @details 用RedactionMatcher扫描消息内容和诊断上下文，命中时复制消息并就地打码后再写入，
+ *          未命中的消息不做任何复制，直接转发。上下文条目按输出中的"键=值"形式匹配，
+ *          因此键规则（如"password="）对同名的上下文键同样生效
+ * @see RedactionMatcher
+ * @since 1.1.0
+ */
+class RedactionDecorator : public LogDecorator {
+private:
+    std::shared_ptr<const RedactionMatcher> matcher_;   ///< 匹配器，通过原子操作读写以支持热更新
+    
+    /**
+     * @brief 对消息内容和诊断上下文打码
+     * @param[in] matcher 匹配器
+     * @param[in] msg 原消息
+     * @param[out] redacted 打码后的消息，只在返回true时写入
+     * @return true表示有内容被打码
+     * @since 1.1.0
+     */
+    static bool redactMessage(const RedactionMatcher& matcher, const LogMessage& msg, LogMessage& redacted);
+    
+    /**
+     * @brief 对诊断上下文打码
+     * @details 只重建从栈顶到最外层命中条目的节点，更外层的节点继续共享
+     * @param[in] matcher 匹配器
+     * @param[in] context 上下文快照
+     * @return 打码后的快照，没有条目命中时为空
+     * @since 1.1.0
+     */
+    static LogContextRef redactContext(const RedactionMatcher& matcher, const LogContextRef& context);
+    
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] output 要装饰的输出对象
+     * @param[in] matcher 匹配器，多个装饰器可以共享同一个匹配器
+     * @since 1.1.0
+     */
+    RedactionDecorator(std::unique_ptr<ILogOutput> output, 
+                      std::shared_ptr<const RedactionMatcher> matcher);
+    
+    void write(const LogMessage& msg) override;
+    bool format(const LogMessage& msg, std::pmr::string& out) const override;
+    
+    /**
+     * @brief 替换匹配器
+     * @param[in] matcher 新的匹配器，nullptr表示不再打码
+     * @since 1.1.0
+     */
+    void setMatcher(std::shared_ptr<const RedactionMatcher> matcher);
 };
 
 /**
  * @brief 格式化装饰器
  * @details 自定义日志消息的格式
+ * @note 自1.1.0起支持{context}占位符，展开为诊断上下文"{k1=v1 k2=v2}"
  * @since 1.0.0
  */
 class FormatDecorator : public LogDecorator {
@@ -287,6 +379,7 @@ public:
     FormatDecorator(std::unique_ptr<ILogOutput> output, const std::string& format);
     
     void write(const LogMessage& msg) override;
+    bool format(const LogMessage& msg, std::pmr::string& out) const override;
     
     /**
      * @brief 设置格式字符串
@@ -309,7 +402,7 @@ private:
      * @return 格式化后的消息
      * @since 1.0.0
      */
-    std::string formatMessage(const LogMessage& msg);
+    std::string formatMessage(const LogMessage& msg) const;
     
     /**
      * @brief 替换格式占位符
@@ -318,7 +411,7 @@ private:
      * @return 替换后的字符串
      * @since 1.0.0
      */
-    std::string replacePlaceholders(const std::string& format, const LogMessage& msg);
+    std::string replacePlaceholders(const std::string& format, const LogMessage& msg) const;
 };
 
 } // namespace async_log
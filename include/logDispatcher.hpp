@@ -14,11 +14,15 @@
 
 #include "logTypes.hpp"
 #include "logOutput.hpp"
+#include "logFilter.hpp"
+#include "formatPipeline.hpp"
 #include <memory>
 #include <vector>
 #include <mutex>
+#include <shared_mutex>
 #include <functional>
 #include <atomic> // Added for std::atomic
+#include <chrono>
 
 namespace async_log {
 
@@ -31,11 +35,36 @@ namespace async_log {
 class LogDispatcher {
 private:
     std::vector<std::unique_ptr<ILogOutput>> outputs_;  ///< 输出目标列表
-    mutable std::mutex outputsMutex_;                   ///< 输出列表互斥锁
+    mutable std::shared_mutex outputsMutex_;            ///< 输出列表读写锁，格式化、写出批次与路由共享持有，增删输出时独占
     
     // 过滤和路由函数
     std::function<bool(const LogMessage&)> messageFilter_;  ///< 消息过滤器
     std::function<size_t(const LogMessage&)> routeFunction_; ///< 路由函数
+    std::shared_ptr<const LogFilter> compiledFilter_;        ///< 编译后的过滤表达式，通过原子操作读写以支持热更新
+    
+    /**
+     * @brief 重复消息表项
+     * @details 记录窗口内第一条已输出的消息以及之后被合并的重复次数
+     * @since 1.1.0
+     */
+    struct RepeatEntry {
+        bool occupied = false;                              ///< 是否已占用
+        size_t hash = 0;                                    ///< 调用点与文本的哈希值
+        LogMessage first;                                   ///< 窗口内第一条消息
+        uint64_t repeatCount = 0;                           ///< 被合并的重复次数
+        std::chrono::system_clock::time_point lastSeen;     ///< 最后一次重复的时间
+    };
+    
+    static constexpr size_t REPEAT_TABLE_SIZE = 256;    ///< 重复消息表大小（直接映射）
+    
+    std::vector<RepeatEntry> repeatTable_;              ///< 重复消息表，启用合并时才分配
+    std::chrono::milliseconds repeatWindow_;            ///< 合并窗口，0表示不合并
+    size_t pendingRepeats_;                             ///< 尚未输出汇总行的表项数量
+    mutable std::mutex repeatMutex_;                    ///< 重复消息表互斥锁
+    
+    std::unique_ptr<FormatPipeline> pipeline_;          ///< 并行格式化流水线，线程数为0时关闭
+    MemoryBudget* memoryBudget_;                        ///< 登记在途批次内存的预算，重建流水线时沿用
+    std::pmr::memory_resource* memoryResource_;         ///< 格式化批次和文本的内存来源，重建流水线时沿用
     
 public:
     /**
@@ -105,6 +134,14 @@ public:
      */
     void flush();
     
+    /**
+     * @brief 刷新所有输出并持久化到存储设备
+     * @see ILogOutput::sync
+     * @note 此操作是线程安全的
+     * @since 1.1.0
+     */
+    void sync();
+    
     /**
      * @brief 关闭所有输出
      * @note 此操作是线程安全的
@@ -112,6 +149,76 @@ public:
      */
     void close();
     
+    /**
+     * @brief 重新打开所有输出的文件或连接
+     * @see ILogOutput::reopen
+     * @note 此操作是线程安全的
+     * @since 1.1.0
+     */
+    void reopenOutputs();
+    
+    /**
+     * @brief 在fork前锁住分发器的所有互斥锁
+     * @details 保证fork时没有其他线程持有这些锁，子进程中的锁处于一致状态
+     * @see unlockAfterFork
+     * @since 1.1.0
+     */
+    void lockForFork();
+    
+    /**
+     * @brief 释放lockForFork()持有的锁
+     * @note 只在父进程中由调用fork的线程调用，子进程改用reinitializeAfterFork()
+     * @since 1.1.0
+     */
+    void unlockAfterFork();
+    
+    /**
+     * @brief 在fork后的子进程中恢复分发器
+     * @details 释放lockForFork()持有的锁，重新创建格式化线程，并重新打开所有输出的文件或连接
+     * @since 1.1.0
+     */
+    void reinitializeAfterFork();
+    
+    /**
+     * @brief 设置登记并行格式化在途批次内存的预算
+     * @param[in] budget 内存预算，nullptr表示不登记；必须比分发器存活更久
+     * @see FormatPipeline::setMemoryBudget
+     * @since 1.1.0
+     */
+    void setMemoryBudget(MemoryBudget* budget);
+    
+    /**
+     * @brief 设置并行格式化批次和格式化文本的内存来源
+     * @param[in] resource 内存资源，必须是线程安全的资源，并且比分发器存活更久
+     * @see FormatPipeline::setMemoryResource
+     * @since 1.1.0
+     */
+    void setMemoryResource(std::pmr::memory_resource* resource);
+    
+    /**
+     * @brief 设置并行格式化线程数
+     * @details 启用后消息在消费者中完成过滤、合并和路由，格式化交给线程池并行完成，
+     *          再由唯一的写出者按原顺序写出。调整前先写出所有已接收的消息
+     * @param[in] threads 格式化线程数，0表示关闭，由调用dispatch()的线程直接写出
+     * @see FormatPipeline
+     * @since 1.1.0
+     */
+    void setFormatThreads(size_t threads);
+    
+    /**
+     * @brief 获取并行格式化线程数
+     * @return 线程数，0表示未启用
+     * @since 1.1.0
+     */
+    size_t getFormatThreads() const;
+    
+    /**
+     * @brief 把已分发的消息作为一个批次交给格式化线程
+     * @details 消费者每处理完一批消息调用一次；未启用并行格式化时不做任何事
+     * @since 1.1.0
+     */
+    void submitBatch();
+    
     // 过滤和路由配置
     /**
      * @brief 设置消息过滤器
@@ -120,6 +227,31 @@ public:
      */
     void setMessageFilter(std::function<bool(const LogMessage&)> filter);
     
+    /**
+     * @brief 设置过滤表达式
+     * @details 表达式编译成功后原子替换当前的表达式，工作线程下一条消息即按新规则过滤；
+     *          与setMessageFilter设置的过滤函数同时生效，两者都通过才分发
+     * @param[in] expression 表达式文本，空字符串表示清除
+     * @param[out] error 编译失败时写入错误描述，可为nullptr
+     * @return true表示成功，false表示语法错误（原有表达式保持不变）
+     * @since 1.1.0
+     */
+    bool setFilterExpression(const std::string& expression, std::string* error = nullptr);
+    
+    /**
+     * @brief 设置已编译的过滤表达式
+     * @param[in] filter 过滤表达式，nullptr表示清除
+     * @since 1.1.0
+     */
+    void setCompiledFilter(std::shared_ptr<const LogFilter> filter);
+    
+    /**
+     * @brief 获取当前的过滤表达式
+     * @return 表达式文本，未设置时返回空字符串
+     * @since 1.1.0
+     */
+    std::string getFilterExpression() const;
+    
     /**
      * @brief 设置路由函数
      * @param[in] router 路由函数，返回目标输出的索引
@@ -146,6 +278,31 @@ public:
      */
     void setDefaultRoutingStrategy(int strategy);
     
+    // 重复消息合并
+    /**
+     * @brief 设置重复消息合并窗口
+     * @details 窗口内来自同一调用点（级别、文件、行号）且文本相同的消息只输出第一条，
+     *          其余只计数，窗口结束后输出一条"重复了N次，历时T毫秒"的汇总行
+     * @param[in] window 合并窗口，0表示关闭合并
+     * @note 关闭合并时会先输出所有未完成的汇总行
+     * @since 1.1.0
+     */
+    void setRepeatWindow(std::chrono::milliseconds window);
+    
+    /**
+     * @brief 获取重复消息合并窗口
+     * @return 合并窗口，0表示未启用
+     * @since 1.1.0
+     */
+    std::chrono::milliseconds getRepeatWindow() const;
+    
+    /**
+     * @brief 输出窗口已结束的重复汇总行
+     * @details 由工作线程周期性调用，使没有后续消息的重复风暴也能及时得到汇总
+     * @since 1.1.0
+     */
+    void expireRepeats();
+    
 private:
     /**
      * @brief 检查消息是否应该被过滤
@@ -155,6 +312,65 @@ private:
      */
     bool shouldDispatch(const LogMessage& msg);
     
+    /**
+     * @brief 输出未完成的重复汇总行并刷新所有输出
+     * @param[in] durable 是否调用输出的sync()持久化
+     * @since 1.1.0
+     */
+    void flushOutputs(bool durable);
+    
+    /**
+     * @brief 将消息写入路由选中的输出
+     * @param[in] msg 日志消息
+     * @return 成功写入的输出数量
+     * @since 1.1.0
+     */
+    size_t writeToOutputs(const LogMessage& msg);
+    
+    /**
+     * @brief 在重复消息表中登记一条消息
+     * @param[in] msg 日志消息
+     * @param[out] summaries 因窗口结束或表项被替换而需要输出的汇总行
+     * @return true表示消息是窗口内的重复，应被合并；false表示应正常输出
+     * @note 调用方需持有repeatMutex_
+     * @since 1.1.0
+     */
+    bool registerRepeat(const LogMessage& msg, std::vector<LogMessage>& summaries);
+    
+    /**
+     * @brief 收集重复汇总行
+     * @param[in] force true表示收集所有表项，false表示只收集窗口已结束的表项
+     * @param[out] summaries 需要输出的汇总行
+     * @note 调用方需持有repeatMutex_
+     * @since 1.1.0
+     */
+    void collectRepeats(bool force, std::vector<LogMessage>& summaries);
+    
+    /**
+     * @brief 为表项生成汇总行并清空表项
+     * @param[in,out] entry 重复消息表项
+     * @return 汇总行消息
+     * @since 1.1.0
+     */
+    static LogMessage makeRepeatSummary(RepeatEntry& entry);
+    
+    /**
+     * @brief 计算消息的调用点与文本哈希
+     * @param[in] msg 日志消息
+     * @return 哈希值
+     * @since 1.1.0
+     */
+    static size_t repeatHash(const LogMessage& msg);
+    
+    /**
+     * @brief 判断两条消息是否来自同一调用点且文本相同
+     * @param[in] a 第一条消息
+     * @param[in] b 第二条消息
+     * @return true表示是重复消息
+     * @since 1.1.0
+     */
+    static bool isSameRepeat(const LogMessage& a, const LogMessage& b);
+    
     /**
      * @brief 确定目标输出
      * @param[in] msg 日志消息
@@ -187,6 +403,30 @@ private:
      */
     std::vector<size_t> randomRouting(const LogMessage& msg);
     
+    /**
+     * @brief 创建绑定到本分发器的格式化流水线
+     * @return 处于关闭状态的流水线
+     * @since 1.1.0
+     */
+    std::unique_ptr<FormatPipeline> createPipeline();
+    
+    /**
+     * @brief 格式化一个批次
+     * @details 按输出逐条调用ILogOutput::format()并拼接结果，不支持预格式化的输出被标记为逐条写出
+     * @param[in,out] batch 批次
+     * @note 在格式化线程中调用，共享持有outputsMutex_
+     * @since 1.1.0
+     */
+    void formatBatch(FormatBatch& batch);
+    
+    /**
+     * @brief 写出一个已格式化的批次
+     * @param[in,out] batch 批次
+     * @note 按批次编号依次调用，同一时刻只有一个批次在写出；共享持有outputsMutex_
+     * @since 1.1.0
+     */
+    void commitBatch(FormatBatch& batch);
+    
     int routingStrategy_;               ///< 当前路由策略
     std::atomic<size_t> roundRobinCounter_; ///< 轮询计数器
 };
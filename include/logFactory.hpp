@@ -52,6 +52,7 @@ public:
         COMPRESSION,    ///< 压缩装饰器
         FILTER,         ///< 过滤装饰器
         FORMAT,         ///< 格式化装饰器
+        REDACTION,      ///< 打码装饰器
         CUSTOM          ///< 自定义装饰器
     };
     
@@ -241,6 +242,11 @@ private:
         std::unique_ptr<ILogOutput> output, const LogConfig& config);
     static std::unique_ptr<LogDecorator> createFormatDecorator(
         std::unique_ptr<ILogOutput> output, const LogConfig& config);
+    static std::unique_ptr<LogDecorator> createRedactionDecorator(
+        std::unique_ptr<ILogOutput> output, const LogConfig& config);
+    
+    // 配置中的内存资源，未设置时返回默认资源
+    static std::pmr::memory_resource* resourceFromConfig(const LogConfig& config);
     
     // 字符串转换
     static std::string outputTypeToString(OutputType type);
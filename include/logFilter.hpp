@@ -0,0 +1,169 @@
+/**
+ * @file logFilter.hpp
+ * @brief 日志过滤表达式
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 提供一个小型过滤表达式语言，表达式在加载时编译为紧凑的字节码，
+ *          由工作线程上的分发器和FilterDecorator逐条求值。语法示例：
+ *          @code
+ *          level >= WARN && file ~ "*net_*.cpp"
+ *          (message contains "timeout" || ctx.tenant == "acme") && !(function == "heartbeat")
+ *          @endcode
+ *          字段：level、line、thread（与{thread}占位符相同的哈希值）、file、function、message、
+ *          ctx.<键>（诊断上下文中的值，不存在时视为空字符串）。
+ *          数值比较：== != < <= > >=；文本比较：== != ~（通配符，支持*和?） !~ contains。
+ *          逻辑运算：&& || !（也可写作and or not），支持括号、true和false
+ * @see LogDispatcher, FilterDecorator, LogConfig
+ * @since 1.1.0
+ */
+
+#pragma once
+
+#include "logTypes.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace async_log {
+
+/**
+ * @brief 编译后的过滤表达式
+ * @details 字节码是一个布尔栈机，&&和||编译为短路跳转。对象创建后不可修改，
+ *          因此可以通过共享指针在运行时原子替换，实现过滤规则的热更新
+ * @note 求值是线程安全的
+ * @since 1.1.0
+ */
+class LogFilter {
+public:
+    /**
+     * @brief 字节码操作码
+     * @since 1.1.0
+     */
+    enum class Opcode : uint8_t {
+        PUSH_CONST,      ///< 压入常量true/false
+        NUMBER_CMP,      ///< 比较数值字段并压入结果
+        TEXT_CMP,        ///< 比较文本字段并压入结果
+        NOT,             ///< 对栈顶取反
+        JUMP_IF_FALSE,   ///< 栈顶为false时跳转（保留栈顶），否则弹出栈顶继续
+        JUMP_IF_TRUE     ///< 栈顶为true时跳转（保留栈顶），否则弹出栈顶继续
+    };
+
+    /**
+     * @brief 字段
+     * @since 1.1.0
+     */
+    enum class Field : uint8_t {
+        LEVEL, LINE, THREAD, FILE, FUNCTION, MESSAGE, CONTEXT
+    };
+
+    /**
+     * @brief 比较方式
+     * @since 1.1.0
+     */
+    enum class Compare : uint8_t {
+        EQ, NE, LT, LE, GT, GE, GLOB, NOT_GLOB, CONTAINS, PREFIX, SUFFIX
+    };
+
+    /**
+     * @brief 字节码指令
+     * @since 1.1.0
+     */
+    struct Instruction {
+        Opcode op;                  ///< 操作码
+        Field field;                ///< 比较的字段
+        Compare compare;            ///< 比较方式
+        StringId contextKey;        ///< ctx字段的驻留键
+        uint32_t operand;           ///< 文本池索引或跳转目标
+        int64_t number;             ///< 数值操作数或常量值
+    };
+
+    static constexpr size_t MAX_STACK_DEPTH = 64;   ///< 求值栈的最大深度
+
+private:
+    std::string expression_;                ///< 原始表达式
+    std::vector<Instruction> code_;         ///< 字节码
+    std::vector<std::string> strings_;      ///< 文本操作数池
+
+    class Compiler;
+
+public:
+    /**
+     * @brief 编译过滤表达式
+     * @param[in] expression 表达式文本，空白表达式表示全部通过
+     * @param[out] error 编译失败时写入错误描述，可为nullptr
+     * @return 编译结果，语法错误时返回nullptr
+     * @since 1.1.0
+     */
+    static std::shared_ptr<const LogFilter> compile(const std::string& expression,
+                                                    std::string* error = nullptr);
+
+    /**
+     * @brief 对一条消息求值
+     * @param[in] msg 日志消息
+     * @return true表示通过，false表示过滤
+     * @since 1.1.0
+     */
+    bool evaluate(const LogMessage& msg) const;
+
+    /**
+     * @brief 函数调用形式的求值，便于作为谓词使用
+     * @param[in] msg 日志消息
+     * @return true表示通过，false表示过滤
+     * @since 1.1.0
+     */
+    bool operator()(const LogMessage& msg) const {
+        return evaluate(msg);
+    }
+
+    /**
+     * @brief 获取原始表达式
+     * @return 表达式文本
+     * @since 1.1.0
+     */
+    const std::string& getExpression() const;
+
+    /**
+     * @brief 获取字节码
+     * @return 指令序列
+     * @since 1.1.0
+     */
+    const std::vector<Instruction>& getCode() const;
+
+private:
+    /**
+     * @brief 私有构造函数，只能通过compile创建
+     * @since 1.1.0
+     */
+    LogFilter() = default;
+
+    /**
+     * @brief 通配符匹配
+     * @param[in] text 文本
+     * @param[in] pattern 模式，*匹配任意长度，?匹配单个字符
+     * @return true表示匹配
+     * @since 1.1.0
+     */
+    static bool globMatch(const std::string& text, const std::string& pattern);
+
+    /**
+     * @brief 求值单条文本比较指令
+     * @param[in] msg 日志消息
+     * @param[in] instruction 指令
+     * @return 比较结果
+     * @since 1.1.0
+     */
+    bool evaluateText(const LogMessage& msg, const Instruction& instruction) const;
+
+    /**
+     * @brief 求值单条数值比较指令
+     * @param[in] msg 日志消息
+     * @param[in] instruction 指令
+     * @return 比较结果
+     * @since 1.1.0
+     */
+    static bool evaluateNumber(const LogMessage& msg, const Instruction& instruction);
+};
+
+} // namespace async_log
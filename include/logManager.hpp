@@ -5,7 +5,7 @@
  * @date 2025-08-25 11:25:00
  * @version 1.0.0
  * @details 实现日志系统的核心管理器，负责协调各个组件，提供统一的日志接口
- * @note 此实现使用单例模式，确保全局只有一个日志管理器实例
+ * @note 默认实例通过单例获取；需要隔离的子系统可以另外构造独立的实例
  * @see ILogOutput, LockFreeQueue, LogConfig
  * @since 1.0.0
  */
@@ -15,6 +15,15 @@
 #include "logTypes.hpp"
 #include "logOutput.hpp"
 #include "lockFreeQueue.hpp"
+#include "slotRing.hpp"
+#include "memoryBudget.hpp"
+#include "stringTable.hpp"
+#include "rateLimiter.hpp"
+#include "logContext.hpp"
+#include "logScope.hpp"
+#include "callSiteStats.hpp"
+#include "errorBacklog.hpp"
+#include "stagingBuffer.hpp"
 #include <memory>
 #include <thread>
 #include <atomic>
@@ -22,6 +31,10 @@
 #include <vector>
 #include <functional>
 #include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <queue>
 
 namespace async_log {
 
@@ -30,24 +43,32 @@ class LogDispatcher;
 
 /**
  * @brief 日志管理器类
- * @details 负责管理整个日志系统的生命周期，协调各个组件工作
- * @note 此实现使用单例模式，线程安全
+ * @details 负责管理整个日志系统的生命周期，协调各个组件工作。getInstance()返回进程的默认实例，
+ *          日志宏都写入它；也可以直接构造独立的实例（例如审计日志），每个实例拥有自己的队列、工作线程、
+ *          输出、配置和内存预算，互不争用。字符串驻留表、调用点统计和诊断上下文是进程级的，各实例共用
+ * @note 此实现是线程安全的
  * @since 1.0.0
  */
 class LogManager {
 private:
     // 单例相关
     static std::unique_ptr<LogManager> instance_;
+    static std::atomic<LogManager*> instancePtr_;   ///< 已创建实例的快速访问指针，热路径上免去加锁
     static std::mutex instanceMutex_;
     
+    // 实例登记（存活实例表见logManager.cpp，fork时逐个处理）
+    static std::atomic<uint64_t> nextInstanceId_;   ///< 下一个实例编号
+    const uint64_t instanceId_;                     ///< 进程内不重复的实例编号，用于区分各实例的线程局部状态
+    
     // 核心组件
     std::unique_ptr<LogConfig> config_;
-    std::unique_ptr<LockFreeQueue<LogMessage>> messageQueue_;
-    std::unique_ptr<LogDispatcher> dispatcher_;
-    std::vector<std::unique_ptr<ILogOutput>> outputs_;
+    std::unique_ptr<AnyQueue<LogMessage>> messageQueue_;   ///< 按queueAlgorithm和queueWaitStrategy选择的队列
+    std::unique_ptr<SlotRing<LogMessage>> slotRing_;    ///< 槽位复用模式下的队列，为空时使用messageQueue_
+    std::unique_ptr<LogDispatcher> dispatcher_;         ///< 分发器，持有全部输出
     
     // 工作线程
     std::thread workerThread_;
+    std::atomic<std::thread::id> workerId_;         ///< 工作线程的ID，启动时登记、join后清除，供其他线程无锁读取
     std::atomic<bool> running_;
     std::atomic<bool> shouldStop_;
     
@@ -55,6 +76,79 @@ private:
     mutable std::mutex configMutex_;
     mutable std::mutex outputsMutex_;
     std::condition_variable workerCondition_;
+    std::atomic<bool> workerSleeping_;              ///< 工作线程是否已宣告即将等待，生产者只在此时唤醒它
+    
+    // 内存预算与溢出处理
+    MemoryBudget memoryBudget_;                     ///< 在途日志数据的字节预算
+    size_t queueFootprint_;                         ///< 已登记到预算的队列结构字节数，由消费者按实际占用补登
+    std::atomic<OverflowPolicy> overflowPolicy_;    ///< 当前溢出策略
+    std::atomic<uint64_t> droppedCount_;            ///< 因超出预算被丢弃的消息数
+    std::atomic<size_t> blockedProducers_;          ///< 正在等待预算的生产者数量
+    std::mutex spaceMutex_;                         ///< 预算等待互斥锁
+    std::condition_variable spaceCondition_;        ///< 预算释放通知
+    
+    // 过载时的级别降级
+    std::atomic<LogLevel> effectiveMinLevel_;       ///< 生产者检查使用的最低级别（配置级别加上降级）
+    std::chrono::steady_clock::time_point lastDegradeCheck_;   ///< 上次评估压力的时间（仅工作线程访问）
+    std::chrono::steady_clock::time_point pressureSince_;      ///< 本轮持续过载的开始时间（仅工作线程访问）
+    std::chrono::steady_clock::time_point calmSince_;          ///< 本轮持续低于恢复线的开始时间（仅工作线程访问）
+    bool degradeReset_;                             ///< setConfig()清除了降级，下次评估时重新计时（受configMutex_保护）
+    
+    // 调用点排行
+    std::vector<CallSiteStats::Entry> lastCallSiteReport_;      ///< 上次排行时的统计快照（仅工作线程访问）
+    std::chrono::steady_clock::time_point lastCallSiteReportTime_; ///< 上次输出排行的时间（仅工作线程访问）
+    
+    // 限流汇总
+    std::chrono::steady_clock::time_point lastSuppressedReport_;   ///< 上次代为输出限流汇总的时间（仅工作线程访问）
+    
+    // 错误回溯
+    std::atomic<size_t> errorBacklogSize_;          ///< 每个线程缓存的低级别日志条数，0表示关闭
+    std::atomic<LogLevel> errorBacklogLevel_;       ///< 不高于该级别的日志进入缓存
+    
+    // 线程局部暂存
+    std::atomic<size_t> stagingBatchSize_;          ///< 每个线程攒够多少条后发布，0表示关闭
+    std::atomic<size_t> stagingMaxBytes_;           ///< 暂存文本达到该字节数时发布
+    std::atomic<size_t> stagingMaxDelayUs_;         ///< 最早一条暂存的最长等待时长（微秒）
+    std::vector<std::shared_ptr<StagingBuffer>> stagingBuffers_;   ///< 各线程在本实例中的暂存缓冲区
+    std::mutex stagingMutex_;                       ///< 保护stagingBuffers_
+    
+    // 同步写出
+    std::atomic<bool> syncWrite_;                   ///< 是否启用同步写出
+    std::atomic<LogLevel> syncWriteLevel_;          ///< 不低于该级别的日志同步写出
+    
+    /**
+     * @brief 一次等待中的异步刷新
+     * @details 尚未被工作线程取走前，后来的调用者提高目标序号并共享同一个future
+     * @since 1.1.0
+     */
+    struct FlushRequest {
+        uint64_t target = 0;                 ///< 序号小于该值的消息都写出后完成
+        bool durable = false;                ///< 是否需要持久化
+        std::promise<void> promise;          ///< 完成通知
+        std::shared_future<void> future;     ///< 返回给调用者的future
+    };
+    
+    // 异步刷新
+    std::atomic<uint64_t> nextSequence_;            ///< 下一条入队消息的序号
+    uint64_t completedSequence_;                    ///< 序号小于该值的消息都已写出（仅消费者访问）
+    std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>> earlySequences_; ///< 先于更小序号写出的序号（仅消费者访问）
+    std::unique_ptr<FlushRequest> pendingFlush_;    ///< 等待中的刷新请求
+    std::atomic<bool> flushPending_;                ///< 是否有等待中的刷新请求，供工作线程免锁检查
+    std::mutex flushMutex_;                         ///< 保护pendingFlush_
+    
+    // 手动驱动模式
+    std::atomic<bool> manualDrain_;                 ///< 本次运行是否由宿主调用poll()消费队列
+    std::atomic<bool> pollSignaled_;                ///< 通知描述符是否已处于可读状态，用于合并通知
+    int notifyReadFd_;                              ///< 通知描述符的读端，-1表示不可用
+    int notifyWriteFd_;                             ///< 通知描述符的写端（eventfd时与读端相同）
+    std::mutex drainMutex_;                         ///< 保证同一时刻只有一个消费者（工作线程、poll()或同步写出的调用线程）
+    std::atomic<std::thread::id> consumerThread_;   ///< 当前持有drainMutex_的线程，用于识别输出内部的重入
+    std::unique_ptr<std::pmr::vector<LogMessage>> pollBuffer_;  ///< 手动驱动模式下复用的批处理缓冲区
+    
+    // fork处理
+    std::atomic<bool> forkPending_;                 ///< 是否有线程正在准备fork，工作线程见到后写完队列并暂停
+    std::atomic<bool> workerParked_;                ///< 工作线程是否已写完队列并暂停
+    std::atomic<uint64_t> forkTarget_;              ///< 暂停前需要写出的序号上限，即准备fork时的nextSequence_
     
 public:
     /**
@@ -72,6 +166,20 @@ public:
      */
     static void destroyInstance();
     
+    /**
+     * @brief 构造独立的日志管理器
+     * @details 使用默认配置，调用start()后开始处理日志
+     * @since 1.1.0
+     */
+    LogManager();
+    
+    /**
+     * @brief 使用指定配置构造独立的日志管理器
+     * @param[in] config 初始配置
+     * @since 1.1.0
+     */
+    explicit LogManager(const LogConfig& config);
+    
     // 禁用拷贝构造和赋值
     LogManager(const LogManager&) = delete;
     LogManager& operator=(const LogManager&) = delete;
@@ -91,6 +199,8 @@ public:
      * @brief 设置日志配置
      * @param[in] config 新的配置对象
      * @note 此操作是线程安全的
+     * @warning memoryResource、recycledSlotCount、queueAlgorithm、queueWaitStrategy、有界队列算法的maxQueueSize以及分段队列算法的queueSegmentSize只在日志系统停止且队列为空时切换，且调用时不能有其他线程正在记录日志，
+     *          应在程序初始化阶段设置；该资源必须比日志管理器活得更久（或在其之前调用destroyInstance()）
      * @since 1.0.0
      */
     void setConfig(const LogConfig& config);
@@ -166,6 +276,52 @@ public:
     void log(LogLevel level, const std::string& message, 
              const std::string& file, int line, const std::string& function = "");
     
+    /**
+     * @brief 在指定调用点记录日志消息
+     * @details 记录只携带调用点中驻留的文件名和函数名ID，不再复制这两个字符串
+     * @param[in] level 日志级别
+     * @param[in] message 日志消息
+     * @param[in] site 调用点，通常由日志宏创建的静态实例
+     * @note 此操作是线程安全的，异步执行
+     * @since 1.1.0
+     */
+    void log(LogLevel level, const std::string& message, const LogCallSite& site);
+    
+    /**
+     * @brief 在指定调用点记录驻留的常量消息
+     * @details 消息文本本身也只以ID形式入队，适合大量重复出现的固定文本
+     * @param[in] level 日志级别
+     * @param[in] messageId 由StringTable驻留的消息ID
+     * @param[in] site 调用点
+     * @note 此操作是线程安全的，异步执行
+     * @since 1.1.0
+     */
+    void log(LogLevel level, StringId messageId, const LogCallSite& site);
+    
+    /**
+     * @brief 检查指定级别的日志当前是否会被记录
+     * @details 限流宏在调用限流策略和构造消息之前先做这一检查，
+     *          被级别过滤掉的日志不会消耗令牌，也不会计入抑制数量
+     * @param[in] level 日志级别
+     * @return true表示会被记录
+     * @note 内联实现，只有一次原子读取
+     * @since 1.1.0
+     */
+    bool isEnabled(LogLevel level) const {
+        return shouldLog(level);
+    }
+    
+    /**
+     * @brief 输出调用点的限流汇总行
+     * @details 限流策略在抑制一段时间后再次放行时调用，汇总行与被放行的消息使用相同的级别和调用点；
+     *          调用点一直不再放行时，工作线程通过reportSuppressed()输出同样的汇总行
+     * @param[in] level 日志级别
+     * @param[in] suppressedCount 期间被抑制的日志数量
+     * @param[in] site 调用点
+     * @since 1.1.0
+     */
+    void logSuppressed(LogLevel level, uint64_t suppressedCount, const LogCallSite& site);
+    
     // 便捷日志方法
     /**
      * @brief 记录DEBUG级别日志
@@ -220,11 +376,52 @@ public:
     
     /**
      * @brief 刷新所有输出
+     * @details 等待调用前入队的消息全部写出后刷新输出
      * @note 此操作是线程安全的
      * @since 1.0.0
      */
     void flush();
     
+    /**
+     * @brief 异步刷新
+     * @details 调用前已入队的所有消息写出并刷新输出后，返回的future就绪。
+     *          工作线程尚未开始处理时，并发的多个调用共享同一次物理刷新
+     * @param[in] durable 为true时还会调用输出的sync()把内容持久化到存储设备
+     * @return 完成通知，日志系统未运行时立即就绪
+     * @note 此操作是线程安全的；在工作线程（例如输出或装饰器内部）中调用时同步完成
+     * @since 1.1.0
+     */
+    std::shared_future<void> flushAsync(bool durable = false);
+    
+    /**
+     * @brief 手动驱动模式下处理待写出的消息
+     * @details 配置了LogConfig::manualDrain时start()不创建工作线程，由宿主事件循环在空闲时调用本函数。
+     *          处理完成后执行与工作线程相同的周期性任务（重复汇总、级别降级、调用点排行、异步刷新）
+     * @param[in] maxMessages 本次最多处理的消息数量
+     * @param[in] maxTime 本次最多占用的时间，按批检查，可能略微超出
+     * @return 实际处理的消息数量；非手动驱动模式或未运行时返回0
+     * @note 此操作是线程安全的，并发调用会串行执行
+     * @since 1.1.0
+     */
+    size_t poll(size_t maxMessages = SIZE_MAX,
+                std::chrono::microseconds maxTime = std::chrono::microseconds::max());
+    
+    /**
+     * @brief 获取"有消息待处理"的通知描述符
+     * @details 手动驱动模式下有消息入队时描述符变为可读，宿主可以把它注册到epoll/poll/select中；
+     *          poll()会在处理前清除可读状态，未处理完时重新置为可读。多次入队只产生一次通知
+     * @return 文件描述符（Linux上为eventfd，其他POSIX系统为管道读端），不支持或未处于手动驱动模式时返回-1
+     * @since 1.1.0
+     */
+    int getNotifyFd() const;
+    
+    /**
+     * @brief 检查当前是否处于手动驱动模式
+     * @return true表示由宿主调用poll()消费队列
+     * @since 1.1.0
+     */
+    bool isManualDrain() const;
+    
     /**
      * @brief 检查系统是否运行中
      * @return true表示运行中，false表示已停止
@@ -239,13 +436,77 @@ public:
      */
     size_t getQueueSize() const;
     
-private:
     /**
-     * @brief 私有构造函数
-     * @since 1.0.0
+     * @brief 获取在途日志数据的内存使用量
+     * @return 当前登记在预算中的字节数（队列中的记录及其他登记的缓冲区）
+     * @since 1.1.0
      */
-    LogManager();
+    size_t getMemoryUsage() const;
+    
+    /**
+     * @brief 获取内存上限
+     * @return 字节上限，0表示不限制
+     * @since 1.1.0
+     */
+    size_t getMemoryLimit() const;
+    
+    /**
+     * @brief 获取因超出内存预算而丢弃的消息数量
+     * @return 累计丢弃数量
+     * @since 1.1.0
+     */
+    uint64_t getDroppedCount() const;
+    
+    /**
+     * @brief 获取内存预算对象
+     * @details 自定义输出可以通过它登记自身持有的缓冲区，使其计入同一个内存上限
+     * @return 内存预算引用
+     * @since 1.1.0
+     */
+    MemoryBudget& getMemoryBudget();
+    
+    /**
+     * @brief 获取当前生效的最低日志级别
+     * @details 持续过载时工作线程会把它提升到配置的minLevel之上，压力解除后逐级恢复
+     * @return 生效的最低日志级别
+     * @since 1.1.0
+     */
+    LogLevel getEffectiveMinLevel() const;
+    
+    /**
+     * @brief 设置分发器的过滤表达式
+     * @details 运行时可随时调用以热更新过滤规则，语法见LogFilter
+     * @param[in] expression 表达式文本，空字符串表示清除
+     * @param[out] error 编译失败时写入错误描述，可为nullptr
+     * @return true表示成功，false表示语法错误（原有规则保持不变）
+     * @since 1.1.0
+     */
+    bool setFilterExpression(const std::string& expression, std::string* error = nullptr);
+    
+    /**
+     * @brief 丢弃当前线程缓存的错误回溯日志
+     * @details 请求顺利结束时调用，避免下一个请求的错误带出无关的调试日志
+     * @see LogConfig::errorBacklogSize
+     * @since 1.1.0
+     */
+    void clearErrorBacklog();
+    
+    /**
+     * @brief 获取当前线程缓存的错误回溯日志数量
+     * @return 缓存的消息数量
+     * @since 1.1.0
+     */
+    size_t getErrorBacklogSize() const;
     
+    /**
+     * @brief 立即发布当前线程暂存的日志
+     * @details 线程即将长时间阻塞或等待外部事件前调用，暂存的日志不必等到超时才由工作线程代为发布
+     * @see LogConfig::stagingBatchSize
+     * @since 1.1.0
+     */
+    void flushLocalStaging();
+    
+private:
     /**
      * @brief 工作线程函数
      * @since 1.0.0
@@ -277,7 +538,362 @@ private:
      * @return true表示应该输出，false表示不应该输出
      * @since 1.0.0
      */
-    bool shouldLog(LogLevel level) const;
+    bool shouldLog(LogLevel level) const {
+        // 生产者热路径：只做一次原子读取，不再加锁
+        return static_cast<int>(level) >=
+               static_cast<int>(effectiveMinLevel_.load(std::memory_order_relaxed));
+    }
+    
+    /**
+     * @brief 为一条消息申请内存预算
+     * @details 超出预算时按照溢出策略处理：DROP_NEWEST直接拒绝，BLOCK等待工作线程释放预算
+     * @param[in] bytes 消息占用的字节数
+     * @return true表示可以入队，false表示消息应被丢弃
+     * @since 1.1.0
+     */
+    bool acquireBudget(size_t bytes);
+    
+    /**
+     * @brief 阻塞等待队列或预算腾出空间
+     * @param[in] tryAcquire 尝试获取空间的回调，成功时返回true
+     * @return true表示已获取空间，false表示日志系统已停止
+     * @since 1.1.0
+     */
+    template<typename TryAcquire>
+    bool waitForSpace(TryAcquire&& tryAcquire);
+    
+    /**
+     * @brief 把一条消息交给队列
+     * @details 启用线程局部暂存时先放入当前线程的暂存缓冲区，否则直接发布
+     * @param[in] payloadBytes 消息文本、文件名、函数名的总长度
+     * @param[in] fill 填充回调，必须完整覆盖消息的所有字段
+     * @return true表示已暂存或入队，false表示被丢弃
+     * @since 1.1.0
+     */
+    template<typename Fill>
+    bool enqueue(size_t payloadBytes, Fill&& fill);
+    
+    /**
+     * @brief 申请预算并把一条消息放入共享队列
+     * @details 按配置选择的队列中就地填充；槽位复用模式下直接填充空闲槽位
+     * @param[in] payloadBytes 消息文本、文件名、函数名的总长度
+     * @param[in] fill 填充回调，必须完整覆盖消息的所有字段
+     * @return true表示已入队，false表示被丢弃
+     * @since 1.1.0
+     */
+    template<typename Fill>
+    bool publish(size_t payloadBytes, Fill&& fill);
+    
+    /**
+     * @brief 把一条消息放入当前线程的暂存缓冲区
+     * @details 攒够条数或字节数、或最早一条已等待超过配置的时长时，整批发布
+     * @param[in] payloadBytes 消息文本、文件名、函数名的总长度
+     * @param[in] fill 填充回调，必须完整覆盖消息的所有字段
+     * @return true表示已暂存，false表示未启用暂存
+     * @since 1.1.0
+     */
+    template<typename Fill>
+    bool stage(size_t payloadBytes, Fill&& fill);
+    
+    /**
+     * @brief 把暂存缓冲区中的消息整批发布到共享队列
+     * @details 整批一次申请预算、一次入队并分配连续的序号；有界队列放不下或预算不足时，
+     *          剩余的消息逐条发布，按溢出策略处理
+     * @param[in,out] buffer 暂存缓冲区，调用者必须持有其互斥锁
+     * @since 1.1.0
+     */
+    void publishStaged(StagingBuffer& buffer);
+    
+    /**
+     * @brief 发布所有线程在本实例中暂存的消息
+     * @param[in] dueOnly 为true时只发布已超时、已关闭暂存或拥有者已退出的缓冲区，且不等待任何锁，
+     *                    供工作线程周期性调用；为false时等待并发布全部，供刷新和停止使用
+     * @since 1.1.0
+     */
+    void publishAllStaged(bool dueOnly);
+    
+    /**
+     * @brief 获取当前线程在本实例中的暂存缓冲区
+     * @param[in] create 不存在时是否创建并登记
+     * @return 缓冲区指针，不存在且create为false时返回nullptr
+     * @since 1.1.0
+     */
+    StagingBuffer* localStagingBuffer(bool create);
+    
+    struct StagingHolder;   ///< 线程局部的暂存缓冲区表，线程退出时标记缓冲区
+    
+    /**
+     * @brief 错误回溯模式下暂存低级别日志，或在错误之前写出已暂存的日志
+     * @details 不高于errorBacklogLevel_的日志放入当前线程的缓存；ERROR及以上的日志先把缓存
+     *          按原顺序入队，再由调用方正常入队
+     * @param[in] level 日志级别
+     * @param[in] fill 填充回调，必须完整覆盖消息的所有字段
+     * @return true表示消息已暂存，调用方不应再入队
+     * @since 1.1.0
+     */
+    template<typename Fill>
+    bool deferToErrorBacklog(LogLevel level, Fill&& fill);
+    
+    /**
+     * @brief 同步写出高级别日志
+     * @details 调用线程成为消费者，先写完序号在本条之前的所有消息，再直接写出本条并持久化输出，
+     *          保证与异步写出的日志保持全局顺序，且函数返回时本条已经落盘。
+     *          等待尚未完成入队的其他生产者最多100毫秒，超时后不再保证顺序
+     * @param[in] level 日志级别
+     * @param[in] fill 填充回调，必须完整覆盖消息的所有字段
+     * @return true表示已同步写出；false表示级别未启用同步写出，或当前线程已经是消费者（在输出内部记录日志），
+     *         调用方应正常入队
+     * @since 1.1.0
+     */
+    template<typename Fill>
+    bool writeThrough(LogLevel level, Fill&& fill);
+    
+    class ConsumerLock;   ///< 持有drainMutex_并登记消费者线程的守卫
+    
+    /**
+     * @brief 记录一条消息已写出，推进连续完成的序号
+     * @param[in] sequence 消息序号
+     * @note 只能在消费者中调用
+     * @since 1.1.0
+     */
+    void completeSequence(uint64_t sequence);
+    
+    /**
+     * @brief 等待已停止的工作线程写完剩余消息并被join
+     * @details stop()先清除running_再等待工作线程收尾，其间调用的flushAsync()不能提前完成
+     * @note 不能在工作线程中调用
+     * @since 1.1.0
+     */
+    void awaitWorkerExit() const;
+    
+    /**
+     * @brief 完成已满足条件的异步刷新请求
+     * @param[in] force 为true时不检查序号，直接完成（用于停止时）
+     * @note 只能在消费者中调用
+     * @since 1.1.0
+     */
+    void serviceFlushRequests(bool force);
+    
+    /**
+     * @brief 执行消费者的周期性任务
+     * @details 完成异步刷新、输出重复汇总、调整级别降级、输出调用点排行
+     * @note 只能在消费者中调用
+     * @since 1.1.0
+     */
+    void runHousekeeping();
+    
+    /**
+     * @brief 通知消费者有新消息入队
+     * @details 手动驱动模式下把通知描述符置为可读，只有从未通知状态切换时才写描述符；
+     *          工作线程模式下只有工作线程已宣告即将等待时才唤醒它，连续入队不会产生系统调用
+     * @since 1.1.0
+     */
+    void signalConsumer();
+    
+    /**
+     * @brief 清除通知描述符的可读状态
+     * @since 1.1.0
+     */
+    void clearConsumerSignal();
+    
+    /**
+     * @brief 创建通知描述符
+     * @return true表示成功
+     * @since 1.1.0
+     */
+    bool openNotifyFd();
+    
+    /**
+     * @brief 关闭通知描述符
+     * @since 1.1.0
+     */
+    void closeNotifyFd();
+    
+    /**
+     * @brief 溢出策略为BLOCK且允许阻塞生产者
+     * @details 手动驱动模式下消费者可能就是生产者自己，阻塞会死锁，因此退化为丢弃；
+     *          当前消费者（例如代为发布暂存日志的工作线程）同样不能等待自己
+     * @return true表示可以阻塞等待
+     * @since 1.1.0
+     */
+    bool canBlockProducers() const;
+    
+    /**
+     * @brief 注册fork处理函数
+     * @details 进程内只注册一次，由构造函数调用
+     * @since 1.1.0
+     */
+    static void installForkHandlers();
+    
+    /**
+     * @brief fork前的处理函数
+     * @details 锁住实例互斥锁（同时串行化并发的fork），让每个存活的实例写完队列并锁住所有内部互斥锁，
+     *          再锁住全局驻留表和调用点统计表
+     * @since 1.1.0
+     */
+    static void onForkPrepare();
+    
+    /**
+     * @brief fork后父进程中的处理函数
+     * @since 1.1.0
+     */
+    static void onForkParent();
+    
+    /**
+     * @brief fork后子进程中的处理函数
+     * @since 1.1.0
+     */
+    static void onForkChild();
+    
+    /**
+     * @brief 为fork做准备
+     * @details 工作线程写完此前入队的消息、刷新输出后暂停；手动驱动模式下由调用者写完。
+     *          之后锁住所有内部互斥锁，保证fork时没有其他线程持有它们
+     * @since 1.1.0
+     */
+    void prepareFork();
+    
+    /**
+     * @brief fork后在父进程中恢复运行
+     * @details 释放prepareFork()持有的锁并让工作线程继续
+     * @since 1.1.0
+     */
+    void resumeAfterFork();
+    
+    /**
+     * @brief fork后在子进程中重新初始化
+     * @details 子进程中只有调用fork的线程存在。丢弃工作线程句柄和父进程其他线程在fork前未写出的消息，
+     *          重新打开输出，然后按原模式重新启动：工作线程模式启动新的工作线程，手动驱动模式创建新的通知描述符
+     * @since 1.1.0
+     */
+    void reinitializeAfterFork();
+    
+    /**
+     * @brief 释放prepareFork()持有的内部互斥锁
+     * @details 分发器的锁由调用者先行释放：父进程调用LogDispatcher::unlockAfterFork()，
+     *          子进程调用LogDispatcher::reinitializeAfterFork()
+     * @since 1.1.0
+     */
+    void unlockAfterFork();
+    
+    /**
+     * @brief 工作线程写完准备fork之前入队的消息后暂停，直到fork完成
+     * @details 只写到forkTarget_为止，持续写入的生产者不会使fork无限等待
+     * @param[in,out] messages 批处理缓冲区
+     * @note 只能在工作线程中调用
+     * @since 1.1.0
+     */
+    void parkForFork(std::pmr::vector<LogMessage>& messages);
+    
+    /**
+     * @brief 不写出而丢弃队列中的所有消息
+     * @details 归还消息占用的预算。fork时正在入队的生产者在子进程中不存在，留下的空洞使队列无法取空，
+     *          此时换成同样配置的新队列
+     * @note 只能在子进程重新初始化时调用
+     * @since 1.1.0
+     */
+    void discardQueued();
+    
+    /**
+     * @brief 获取当前线程在本实例中的错误回溯缓存
+     * @details 每个线程为每个实例保留一个缓存，缓存的日志只会写回产生它的实例
+     * @return 缓存引用
+     * @since 1.1.0
+     */
+    ErrorBacklog& localErrorBacklog() const;
+    
+    /**
+     * @brief 取出并处理一批消息
+     * @param[in,out] messages 链表模式下使用的批处理缓冲区
+     * @param[in] maxCount 最多处理的消息数量
+     * @return 实际处理的消息数量
+     * @since 1.1.0
+     */
+    size_t drainBatch(std::pmr::vector<LogMessage>& messages, size_t maxCount);
+    
+    /**
+     * @brief 归还一条已处理消息的内存预算
+     * @param[in] msg 已处理的消息
+     * @since 1.1.0
+     */
+    void releaseBudget(const LogMessage& msg);
+    
+    /**
+     * @brief 按队列结构当前占用的字节数调整预算登记
+     * @details 分段队列的段由生产者按需分配、由消费者放回池中或释放，占用随之变化
+     * @note 只能在消费者中，或没有消费者时调用
+     * @since 1.1.0
+     */
+    void updateQueueFootprint();
+    
+    /**
+     * @brief 估算一条消息在队列中占用的字节数
+     * @param[in] payloadBytes 消息文本、文件名、函数名的总长度
+     * @return 估算的字节数
+     * @since 1.1.0
+     */
+    size_t messageFootprint(size_t payloadBytes) const;
+    
+    /**
+     * @brief 检查当前队列是否为空
+     * @return true表示没有待处理的消息
+     * @since 1.1.0
+     */
+    bool isQueueEmpty() const;
+    
+    /**
+     * @brief 按配置重建队列
+     * @details 更换内存资源、队列算法或切换槽位复用模式，调用方需保证队列为空且工作线程未运行。
+     *          先创建新的队列和槽位数组，预分配的部分单独就超出maxMemoryBytes时保留原有队列
+     * @param[in] config 新的配置
+     * @param[out] error 拒绝新队列时写入原因，可以为nullptr
+     * @return true表示已按配置重建或无需重建，false表示保留了原有队列
+     * @since 1.1.0
+     */
+    bool rebuildQueue(const LogConfig& config, std::string* error);
+    
+    /**
+     * @brief 获取队列结构与槽位数组预先占用的字节数
+     * @return 字节数，与消息数量无关
+     * @since 1.1.0
+     */
+    size_t getPreallocatedBytes() const;
+    
+    /**
+     * @brief 根据队列深度和内存使用量调整生效的最低级别
+     * @details 使用量持续超过阈值时提升一级，持续低于阈值乘以恢复比例时恢复一级，
+     *          两条线之间的区间不做调整，避免级别来回抖动。每次调整都会输出一条日志
+     * @note 只能在工作线程中调用
+     * @since 1.1.0
+     */
+    void updateLevelDegradation();
+    
+    /**
+     * @brief 周期性输出调用点排行
+     * @details 按config.callSiteReportIntervalMs的周期，输出本周期内字节数最多的调用点，
+     *          用于在磁盘被写满前定位刷屏的日志语句
+     * @note 只能在工作线程中调用
+     * @since 1.1.0
+     */
+    void reportCallSites();
+    
+    /**
+     * @brief 代为输出限流调用点的汇总行
+     * @details 每秒最多一次从SuppressionRegistry取出尚未汇总的抑制数量，以调用点的级别和位置写出。
+     *          限流宏只使用全局实例，其他实例不做任何处理
+     * @note 只能在工作线程中调用
+     * @since 1.1.0
+     */
+    void reportSuppressed();
+    
+    /**
+     * @brief 绕过队列直接输出一条系统日志
+     * @details 工作线程自身产生的日志不能进入队列，否则BLOCK策略下可能等待自己
+     * @param[in] level 日志级别
+     * @param[in] message 日志消息
+     * @since 1.1.0
+     */
+    void writeInternal(LogLevel level, const std::string& message);
 };
 
 // 全局日志宏定义
@@ -293,11 +909,98 @@ private:
 #define LOG_ERROR_F(msg, file, line) async_log::LogManager::getInstance().log(async_log::LogLevel::ERROR, msg, file, line)
 #define LOG_FATAL_F(msg, file, line) async_log::LogManager::getInstance().log(async_log::LogLevel::FATAL, msg, file, line)
 
+// 调用点日志宏的内部实现：每个展开位置持有一个静态调用点，文件名和函数名只驻留一次
+#define ASYNC_LOG_AT_CALLSITE_(level, msg) \
+    do { \
+        static const async_log::LogCallSite asyncLogCallSite_(__FILE__, __LINE__, __FUNCTION__); \
+        async_log::LogManager::getInstance().log(level, msg, asyncLogCallSite_); \
+    } while (0)
+
+// 常量消息日志宏的内部实现：消息文本同样只驻留一次
+#define ASYNC_LOG_CONST_AT_CALLSITE_(level, text) \
+    do { \
+        static const async_log::LogCallSite asyncLogCallSite_(__FILE__, __LINE__, __FUNCTION__); \
+        static const async_log::StringId asyncLogTextId_ = async_log::StringTable::getInstance().intern(text); \
+        async_log::LogManager::getInstance().log(level, asyncLogTextId_, asyncLogCallSite_); \
+    } while (0)
+
+// 限流日志宏的内部实现：先检查级别，再询问调用点的静态限流策略，放行后才构造消息；
+// 之前被抑制的日志数量以一条汇总行的形式在本条消息之前输出，调用点不再放行时由工作线程定期代为输出
+#define ASYNC_LOG_LIMITED_AT_CALLSITE_(level, limiterType, limiterArgs, reportSuppressed, msg) \
+    do { \
+        async_log::LogManager& asyncLogManager_ = async_log::LogManager::getInstance(); \
+        if (asyncLogManager_.isEnabled(level)) { \
+            static async_log::limiterType asyncLogLimiter_ limiterArgs; \
+            static const async_log::LogCallSite asyncLogCallSite_(__FILE__, __LINE__, __FUNCTION__); \
+            if (reportSuppressed) { \
+                static const async_log::SuppressionRegistration asyncLogRegistration_( \
+                    asyncLogLimiter_, level, asyncLogCallSite_); \
+            } \
+            if (asyncLogLimiter_.allow()) { \
+                if (reportSuppressed) { \
+                    uint64_t asyncLogSuppressed_ = asyncLogLimiter_.takeSuppressed(); \
+                    if (asyncLogSuppressed_ > 0) { \
+                        asyncLogManager_.logSuppressed(level, asyncLogSuppressed_, asyncLogCallSite_); \
+                    } \
+                } \
+                asyncLogManager_.log(level, msg, asyncLogCallSite_); \
+            } \
+        } \
+    } while (0)
+
+// 限流与采样日志宏（level为DEBUG/INFO/WARN/ERROR/FATAL之一，msg只在放行时求值）
+// 按N取一采样：第1、N+1、2N+1……次放行，采样比例固定，不输出汇总行
+#define LOG_EVERY_N(level, n, msg) \
+    ASYNC_LOG_LIMITED_AT_CALLSITE_(async_log::LogLevel::level, EveryNSampler, (n), false, msg)
+// 每intervalMs毫秒的窗口内只放行前n条
+#define LOG_FIRST_N(level, n, intervalMs, msg) \
+    ASYNC_LOG_LIMITED_AT_CALLSITE_(async_log::LogLevel::level, FirstNPerIntervalLimiter, \
+                                   (n, std::chrono::milliseconds(intervalMs)), true, msg)
+// 令牌桶：长期每秒最多ratePerSecond条，允许burst条突发
+#define LOG_RATE_LIMITED(level, ratePerSecond, burst, msg) \
+    ASYNC_LOG_LIMITED_AT_CALLSITE_(async_log::LogLevel::level, TokenBucketLimiter, \
+                                   (ratePerSecond, burst), true, msg)
+
+// 条件日志宏的内部实现：先检查级别，再求值条件，两者都成立时才构造消息
+#define ASYNC_LOG_IF_AT_CALLSITE_(level, cond, msg) \
+    do { \
+        async_log::LogManager& asyncLogManager_ = async_log::LogManager::getInstance(); \
+        if (asyncLogManager_.isEnabled(level) && (cond)) { \
+            static const async_log::LogCallSite asyncLogCallSite_(__FILE__, __LINE__, __FUNCTION__); \
+            asyncLogManager_.log(level, msg, asyncLogCallSite_); \
+        } \
+    } while (0)
+
+// 延迟构造日志宏的内部实现：builder是返回std::string的可调用对象，只在级别启用时调用
+#define ASYNC_LOG_LAZY_AT_CALLSITE_(level, builder) \
+    ASYNC_LOG_IF_AT_CALLSITE_(level, true, (builder)())
+
 // 带函数名的日志宏
-#define LOG_DEBUG_FUNC(msg) async_log::LogManager::getInstance().log(async_log::LogLevel::DEBUG, msg, __FILE__, __LINE__, __FUNCTION__)
-#define LOG_INFO_FUNC(msg) async_log::LogManager::getInstance().log(async_log::LogLevel::INFO, msg, __FILE__, __LINE__, __FUNCTION__)
-#define LOG_WARN_FUNC(msg) async_log::LogManager::getInstance().log(async_log::LogLevel::WARN, msg, __FILE__, __LINE__, __FUNCTION__)
-#define LOG_ERROR_FUNC(msg) async_log::LogManager::getInstance().log(async_log::LogLevel::ERROR, msg, __FILE__, __LINE__, __FUNCTION__)
-#define LOG_FATAL_FUNC(msg) async_log::LogManager::getInstance().log(async_log::LogLevel::FATAL, msg, __FILE__, __LINE__, __FUNCTION__)
+#define LOG_DEBUG_FUNC(msg) ASYNC_LOG_AT_CALLSITE_(async_log::LogLevel::DEBUG, msg)
+#define LOG_INFO_FUNC(msg) ASYNC_LOG_AT_CALLSITE_(async_log::LogLevel::INFO, msg)
+#define LOG_WARN_FUNC(msg) ASYNC_LOG_AT_CALLSITE_(async_log::LogLevel::WARN, msg)
+#define LOG_ERROR_FUNC(msg) ASYNC_LOG_AT_CALLSITE_(async_log::LogLevel::ERROR, msg)
+#define LOG_FATAL_FUNC(msg) ASYNC_LOG_AT_CALLSITE_(async_log::LogLevel::FATAL, msg)
+
+// 条件日志宏（cond和msg只在级别启用时求值，msg只在cond成立时求值）
+#define LOG_DEBUG_IF(cond, msg) ASYNC_LOG_IF_AT_CALLSITE_(async_log::LogLevel::DEBUG, cond, msg)
+#define LOG_INFO_IF(cond, msg) ASYNC_LOG_IF_AT_CALLSITE_(async_log::LogLevel::INFO, cond, msg)
+#define LOG_WARN_IF(cond, msg) ASYNC_LOG_IF_AT_CALLSITE_(async_log::LogLevel::WARN, cond, msg)
+#define LOG_ERROR_IF(cond, msg) ASYNC_LOG_IF_AT_CALLSITE_(async_log::LogLevel::ERROR, cond, msg)
+#define LOG_FATAL_IF(cond, msg) ASYNC_LOG_IF_AT_CALLSITE_(async_log::LogLevel::FATAL, cond, msg)
+
+// 延迟构造日志宏，例如 LOG_DEBUG_LAZY([&] { return dumpState(); })
+#define LOG_DEBUG_LAZY(builder) ASYNC_LOG_LAZY_AT_CALLSITE_(async_log::LogLevel::DEBUG, builder)
+#define LOG_INFO_LAZY(builder) ASYNC_LOG_LAZY_AT_CALLSITE_(async_log::LogLevel::INFO, builder)
+#define LOG_WARN_LAZY(builder) ASYNC_LOG_LAZY_AT_CALLSITE_(async_log::LogLevel::WARN, builder)
+#define LOG_ERROR_LAZY(builder) ASYNC_LOG_LAZY_AT_CALLSITE_(async_log::LogLevel::ERROR, builder)
+#define LOG_FATAL_LAZY(builder) ASYNC_LOG_LAZY_AT_CALLSITE_(async_log::LogLevel::FATAL, builder)
+
+// 常量消息日志宏（text必须是内容固定的字符串）
+#define LOG_DEBUG_CONST(text) ASYNC_LOG_CONST_AT_CALLSITE_(async_log::LogLevel::DEBUG, text)
+#define LOG_INFO_CONST(text) ASYNC_LOG_CONST_AT_CALLSITE_(async_log::LogLevel::INFO, text)
+#define LOG_WARN_CONST(text) ASYNC_LOG_CONST_AT_CALLSITE_(async_log::LogLevel::WARN, text)
+#define LOG_ERROR_CONST(text) ASYNC_LOG_CONST_AT_CALLSITE_(async_log::LogLevel::ERROR, text)
+#define LOG_FATAL_CONST(text) ASYNC_LOG_CONST_AT_CALLSITE_(async_log::LogLevel::FATAL, text)
 
 } // namespace async_log
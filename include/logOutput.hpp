@@ -15,10 +15,21 @@
 #include <memory>
 #include <string>
 #include <fstream>
+#include <memory_resource>
 #include <mutex>
 
 namespace async_log {
 
+/**
+ * @brief 将日志消息格式化为一行文本
+ * @details 输出格式为"[级别] 秒级时间戳 文件:行号 函数 - 消息"，结果追加到out中。
+ *          内置输出都使用此函数，并复用各自的行缓冲区，预热后不再产生分配
+ * @param[in] msg 日志消息
+ * @param[out] out 输出缓冲区，调用前会被清空，内存来自其自身的内存资源
+ * @since 1.1.0
+ */
+void formatLogLine(const LogMessage& msg, std::pmr::string& out);
+
 /**
  * @brief 日志输出接口
  * @details 定义了日志输出的基本操作，所有具体的输出实现都必须实现此接口
@@ -37,6 +48,31 @@ public:
      */
     virtual void write(const LogMessage& msg) = 0;
     
+    /**
+     * @brief 把日志消息格式化为最终写出的文本
+     * @details 与writeFormatted()配合把write()拆成可并行的格式化和必须串行的写出两步，
+     *          供并行格式化流水线使用。同一输出对所有消息的返回值应保持一致。
+     *          默认实现返回false，这类输出在流水线中由写出线程逐条调用write()
+     * @param[in] msg 日志消息
+     * @param[out] out 格式化结果，调用前会被清空，包含行尾换行；消息被过滤时为空
+     * @return true表示支持预格式化，false表示不支持
+     * @note 可能在多个线程中同时调用，实现不能修改对象状态
+     * @since 1.1.0
+     */
+    virtual bool format(const LogMessage& /*msg*/, std::pmr::string& /*out*/) const {
+        return false;
+    }
+    
+    /**
+     * @brief 写出format()生成的文本
+     * @details 默认实现不做任何事，只有format()返回true的输出才会被调用
+     * @param[in] text 一条或多条消息首尾相接的格式化文本
+     * @note 同一时刻只在一个线程中调用
+     * @since 1.1.0
+     */
+    virtual void writeFormatted(const std::pmr::string& /*text*/) {
+    }
+    
     /**
      * @brief 刷新输出缓冲区
      * @note 确保所有待输出的内容都被实际输出
@@ -44,6 +80,24 @@ public:
      */
     virtual void flush() = 0;
     
+    /**
+     * @brief 刷新并把已写出的内容持久化到存储设备
+     * @details 默认实现等同于flush()，没有持久化概念的输出无需重写
+     * @since 1.1.0
+     */
+    virtual void sync() {
+        flush();
+    }
+    
+    /**
+     * @brief 重新打开底层的文件或连接
+     * @details fork后的子进程与父进程共享打开的文件描述和连接，子进程调用此函数换成自己的句柄。
+     *          默认实现不做任何事，没有进程级资源的输出无需重写
+     * @since 1.1.0
+     */
+    virtual void reopen() {
+    }
+    
     /**
      * @brief 关闭输出
      * @note 释放相关资源，关闭后不应再调用write或flush
@@ -74,6 +128,7 @@ private:
     size_t maxFileSize_;                ///< 最大文件大小
     int maxFileCount_;                  ///< 最大文件数量
     bool isOpen_;                       ///< 文件是否打开
+    std::pmr::string lineBuffer_;       ///< 复用的格式化缓冲区
     
 public:
     /**
@@ -81,11 +136,13 @@ public:
      * @param[in] path 文件路径
      * @param[in] maxSize 最大文件大小（字节）
      * @param[in] maxCount 最大文件数量
+     * @param[in] resource 格式化缓冲区的内存来源
      * @since 1.0.0
      */
     explicit FileOutput(const std::string& path, 
                        size_t maxSize = 10 * 1024 * 1024,
-                       int maxCount = 5);
+                       int maxCount = 5,
+                       std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     
     /**
      * @brief 析构函数
@@ -102,7 +159,11 @@ public:
     FileOutput& operator=(FileOutput&&) noexcept;
     
     void write(const LogMessage& msg) override;
+    bool format(const LogMessage& msg, std::pmr::string& out) const override;
+    void writeFormatted(const std::pmr::string& text) override;
     void flush() override;
+    void sync() override;
+    void reopen() override;
     void close() override;
     bool isAvailable() const override;
     
@@ -137,10 +198,10 @@ private:
     /**
      * @brief 格式化日志消息
      * @param[in] msg 日志消息
-     * @return 格式化后的字符串
+     * @return 格式化后的字符串，引用内部行缓冲区，下次格式化前有效
      * @since 1.0.0
      */
-    std::string formatMessage(const LogMessage& msg);
+    const std::pmr::string& formatMessage(const LogMessage& msg);
 };
 
 /**
@@ -153,16 +214,21 @@ class ConsoleOutput : public ILogOutput {
 private:
     bool enableColor_;                  ///< 是否启用颜色
     mutable std::mutex consoleMutex_;   ///< 控制台输出互斥锁
+    std::pmr::string lineBuffer_;       ///< 复用的格式化缓冲区
     
 public:
     /**
      * @brief 构造函数
      * @param[in] enableColor 是否启用颜色输出
+     * @param[in] resource 格式化缓冲区的内存来源
      * @since 1.0.0
      */
-    explicit ConsoleOutput(bool enableColor = true);
+    explicit ConsoleOutput(bool enableColor = true,
+                           std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     
     void write(const LogMessage& msg) override;
+    bool format(const LogMessage& msg, std::pmr::string& out) const override;
+    void writeFormatted(const std::pmr::string& text) override;
     void flush() override;
     void close() override;
     bool isAvailable() const override;
@@ -181,22 +247,22 @@ private:
      * @return ANSI颜色代码字符串
      * @since 1.0.0
      */
-    std::string getColorCode(LogLevel level);
+    std::string getColorCode(LogLevel level) const;
     
     /**
      * @brief 获取重置颜色代码
      * @return ANSI重置颜色代码字符串
      * @since 1.0.0
      */
-    std::string getResetCode();
+    std::string getResetCode() const;
     
     /**
      * @brief 格式化日志消息
      * @param[in] msg 日志消息
-     * @return 格式化后的字符串
+     * @return 格式化后的字符串，引用内部行缓冲区，下次格式化前有效
      * @since 1.0.0
      */
-    std::string formatMessage(const LogMessage& msg);
+    const std::pmr::string& formatMessage(const LogMessage& msg);
 };
 
 /**
@@ -211,18 +277,24 @@ private:
     int port_;                          ///< 服务器端口
     bool isConnected_;                  ///< 连接状态
     mutable std::mutex networkMutex_;   ///< 网络操作互斥锁
+    std::pmr::string lineBuffer_;       ///< 复用的格式化缓冲区
     
 public:
     /**
      * @brief 构造函数
      * @param[in] host 服务器地址
      * @param[in] port 服务器端口
+     * @param[in] resource 格式化缓冲区的内存来源
      * @since 1.0.0
      */
-    NetworkOutput(const std::string& host, int port);
+    NetworkOutput(const std::string& host, int port,
+                  std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     
     void write(const LogMessage& msg) override;
+    bool format(const LogMessage& msg, std::pmr::string& out) const override;
+    void writeFormatted(const std::pmr::string& text) override;
     void flush() override;
+    void reopen() override;
     void close() override;
     bool isAvailable() const override;
     
@@ -253,15 +325,15 @@ private:
      * @return true表示成功，false表示失败
      * @since 1.0.0
      */
-    bool sendData(const std::string& data);
+    bool sendData(const std::pmr::string& data);
     
     /**
      * @brief 格式化日志消息
      * @param[in] msg 日志消息
-     * @return 格式化后的字符串
+     * @return 格式化后的字符串，引用内部行缓冲区，下次格式化前有效
      * @since 1.0.0
      */
-    std::string formatMessage(const LogMessage& msg);
+    const std::pmr::string& formatMessage(const LogMessage& msg);
 };
 
 } // namespace async_log
@@ -0,0 +1,116 @@
+/**
+ * @file logScope.hpp
+ * @brief 作用域计时与跨度事件
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 通过RAII对象记录一段作用域的开始和结束时间，作用域结束时输出一条带耗时的日志。
+ *          支持耗时阈值，低于阈值的作用域只读取两次时钟、不产生任何日志；
+ *          嵌套的作用域自动形成父子跨度关系，跨度ID随日志一起输出
+ * @see LogManager, LogCallSite
+ * @since 1.1.0
+ */
+
+#pragma once
+
+#include "logTypes.hpp"
+#include "logContext.hpp"
+#include <chrono>
+#include <cstdint>
+
+namespace async_log {
+
+/**
+ * @brief 作用域计时器
+ * @details 构造时记录开始时间并成为当前线程的活动跨度，析构时恢复外层跨度，
+ *          耗时达到阈值且级别启用时输出"name 耗时 N us (span=... parent=...)"
+ * @note 必须在同一线程内按后进先出的顺序构造和析构
+ * @since 1.1.0
+ */
+class LogScope {
+private:
+    const LogCallSite& site_;              ///< 调用点
+    const char* name_;                     ///< 作用域名称，必须是静态字符串
+    std::chrono::nanoseconds threshold_;   ///< 耗时阈值
+    LogLevel level_;                       ///< 日志级别
+    uint64_t spanId_;                      ///< 本跨度ID
+    uint64_t parentSpanId_;                ///< 父跨度ID，0表示根跨度
+    std::chrono::steady_clock::time_point start_;   ///< 开始时间
+
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] site 调用点，通常由宏创建的静态实例
+     * @param[in] name 作用域名称，必须在进程生命周期内有效（如字符串字面量）
+     * @param[in] threshold 耗时阈值，低于该值的作用域不输出日志
+     * @param[in] level 日志级别
+     * @since 1.1.0
+     */
+    LogScope(const LogCallSite& site, const char* name,
+             std::chrono::nanoseconds threshold = std::chrono::nanoseconds(0),
+             LogLevel level = LogLevel::INFO);
+
+    /**
+     * @brief 析构函数，结束计时并按需输出日志
+     * @since 1.1.0
+     */
+    ~LogScope();
+
+    // 禁用拷贝和移动
+    LogScope(const LogScope&) = delete;
+    LogScope& operator=(const LogScope&) = delete;
+
+    /**
+     * @brief 获取本跨度ID
+     * @return 跨度ID
+     * @since 1.1.0
+     */
+    uint64_t getSpanId() const;
+
+    /**
+     * @brief 获取父跨度ID
+     * @return 父跨度ID，0表示根跨度
+     * @since 1.1.0
+     */
+    uint64_t getParentSpanId() const;
+
+    /**
+     * @brief 获取当前线程的活动跨度ID
+     * @return 跨度ID，没有活动跨度时返回0
+     * @since 1.1.0
+     */
+    static uint64_t currentSpanId();
+
+private:
+    /**
+     * @brief 生成新的跨度ID
+     * @details 高32位为线程序号，低32位为线程内计数，不需要跨线程同步
+     * @return 跨度ID
+     * @since 1.1.0
+     */
+    static uint64_t nextSpanId();
+
+    /**
+     * @brief 获取当前线程的活动跨度ID
+     * @return 可修改的活动跨度ID引用
+     * @since 1.1.0
+     */
+    static uint64_t& activeSpan();
+};
+
+} // namespace async_log
+
+// 作用域计时宏的内部实现：id用于生成唯一的变量名
+#define ASYNC_LOG_SCOPE_(name, threshold, id) \
+    static const async_log::LogCallSite ASYNC_LOG_CONCAT_(asyncLogScopeSite_, id)( \
+        __FILE__, __LINE__, __FUNCTION__); \
+    async_log::LogScope ASYNC_LOG_CONCAT_(asyncLogScope_, id)( \
+        ASYNC_LOG_CONCAT_(asyncLogScopeSite_, id), name, threshold)
+
+// 记录当前作用域的耗时，例如 LOG_SCOPE("db.query");
+#define LOG_SCOPE(name) \
+    ASYNC_LOG_SCOPE_(name, std::chrono::nanoseconds(0), __COUNTER__)
+
+// 只有耗时达到thresholdUs微秒时才记录，例如 LOG_SCOPE_SLOW("db.query", 500);
+#define LOG_SCOPE_SLOW(name, thresholdUs) \
+    ASYNC_LOG_SCOPE_(name, std::chrono::microseconds(thresholdUs), __COUNTER__)
@@ -16,9 +16,29 @@
 #include <memory>
 #include <vector>
 #include <thread>
+#include <cstdint>
+#include <memory_resource>
 
 namespace async_log {
 
+/**
+ * @brief 驻留字符串ID类型
+ * @details 由StringTable分配，0表示空字符串或未驻留
+ * @see StringTable
+ * @since 1.1.0
+ */
+using StringId = std::uint32_t;
+
+struct LogContextNode;
+
+/**
+ * @brief 诊断上下文快照类型
+ * @details 指向线程上下文栈的栈顶节点，节点不可变，因此快照可以跨线程共享
+ * @see LogContext
+ * @since 1.1.0
+ */
+using LogContextRef = std::shared_ptr<const LogContextNode>;
+
 /**
  * @brief 日志级别枚举
  * @details 定义了从DEBUG到FATAL的五个日志级别，用于控制日志输出的详细程度
@@ -32,6 +52,42 @@ enum class LogLevel : uint8_t {
     FATAL = 4     ///< 致命错误，程序无法继续运行
 };
 
+/**
+ * @brief 溢出策略枚举
+ * @details 定义在途日志数据超出内存预算时的处理方式
+ * @since 1.1.0
+ */
+enum class OverflowPolicy : uint8_t {
+    DROP_NEWEST = 0,  ///< 丢弃新到达的消息，生产者不阻塞
+    BLOCK = 1         ///< 阻塞生产者直到预算有空闲（日志系统未运行时退化为丢弃）
+};
+
+/**
+ * @brief 队列算法枚举
+ * @details 选择消息队列的实现，不同部署可以按硬件和负载权衡延迟、吞吐和内存
+ * @see LockFreeQueue
+ * @since 1.1.0
+ */
+enum class QueueAlgorithm : uint8_t {
+    LINKED = 0,        ///< 无界链表队列，每条消息分配一个节点
+    BOUNDED_MPMC = 1,  ///< 有界多生产者多消费者环形队列（Vyukov），槽位预先分配
+    MPSC_RING = 2,     ///< 有界多生产者单消费者环形队列，出队不需要原子读改写
+    TICKET_RING = 3,   ///< 有界多生产者单消费者票号环形队列，入队只做一次fetch_add，不因竞争重试
+    SEGMENTED = 4      ///< 无界多生产者单消费者分段队列，按段整块分配，取空的段回收复用
+};
+
+/**
+ * @brief 队列等待策略枚举
+ * @details 定义队列已满（入队）或为空（出队）时，在返回失败之前如何重试
+ * @see LockFreeQueue
+ * @since 1.1.0
+ */
+enum class QueueWaitStrategy : uint8_t {
+    NONE = 0,   ///< 不等待，立即返回失败
+    SPIN = 1,   ///< 忙等重试一小段时间
+    YIELD = 2   ///< 先忙等，再让出CPU重试
+};
+
 /**
  * @brief 日志消息结构体
  * @details 包含一条完整日志的所有信息，包括级别、内容、时间戳、源文件等
@@ -45,6 +101,11 @@ struct LogMessage {
     std::string function;              ///< 函数名
     std::chrono::system_clock::time_point timestamp; ///< 时间戳
     std::thread::id threadId;          ///< 线程ID
+    StringId fileId = 0;               ///< 驻留的源文件名ID，非0时优先于file
+    StringId functionId = 0;           ///< 驻留的函数名ID，非0时优先于function
+    StringId messageId = 0;            ///< 驻留的常量消息ID，非0时优先于message
+    LogContextRef context;             ///< 生产者线程的诊断上下文快照，由assign()捕获
+    uint64_t sequence = 0;             ///< 入队序号，由LogManager在消息确定入队时分配
     
     /**
      * @brief 默认构造函数
@@ -69,6 +130,74 @@ struct LogMessage {
         : level(lvl), message(msg), file(f), line(ln), 
           function(func), timestamp(std::chrono::system_clock::now()),
           threadId(std::this_thread::get_id()) {}
+    
+    /**
+     * @brief 就地重新填充消息
+     * @details 与构造函数等价，但复用已有字符串的容量，供槽位复用模式下的生产者使用。
+     *          所有字段（包括时间戳、线程ID和驻留ID）都会被覆盖，并捕获当前线程的诊断上下文
+     * @param[in] lvl 日志级别
+     * @param[in] msg 日志消息
+     * @param[in] f 源文件名
+     * @param[in] ln 源文件行号
+     * @param[in] func 函数名
+     * @since 1.1.0
+     */
+    void assign(LogLevel lvl, const std::string& msg,
+                const std::string& f = "", int ln = 0,
+                const std::string& func = "");
+    
+    /**
+     * @brief 获取消息内容
+     * @return 消息文本，驻留的常量消息会被解析
+     * @note 格式化器和装饰器应使用此函数而不是直接读取message字段
+     * @since 1.1.0
+     */
+    const std::string& getMessage() const;
+    
+    /**
+     * @brief 获取源文件名
+     * @return 源文件名，驻留的文件名会被解析
+     * @since 1.1.0
+     */
+    const std::string& getFile() const;
+    
+    /**
+     * @brief 获取函数名
+     * @return 函数名，驻留的函数名会被解析
+     * @since 1.1.0
+     */
+    const std::string& getFunction() const;
+    
+    /**
+     * @brief 替换消息内容
+     * @details 写入message字段并清除messageId，供装饰器改写消息时使用
+     * @param[in] text 新的消息内容
+     * @since 1.1.0
+     */
+    void setMessage(std::string text);
+};
+
+/**
+ * @brief 日志调用点
+ * @details 描述一条日志语句在源码中的位置。日志宏为每个调用点创建一个静态实例，
+ *          文件名和函数名只在首次执行时驻留一次，之后每条记录只携带ID
+ * @see StringTable, LogManager::log
+ * @since 1.1.0
+ */
+struct LogCallSite {
+    StringId fileId;       ///< 驻留的源文件名ID
+    StringId functionId;   ///< 驻留的函数名ID
+    int line;              ///< 源文件行号
+    uint32_t statsIndex;   ///< 在CallSiteStats中的下标
+    
+    /**
+     * @brief 构造函数
+     * @param[in] file 源文件名
+     * @param[in] ln 源文件行号
+     * @param[in] function 函数名
+     * @since 1.1.0
+     */
+    LogCallSite(const char* file, int ln, const char* function);
 };
 
 /**
@@ -79,7 +208,10 @@ struct LogMessage {
 struct LogConfig {
     LogLevel minLevel = LogLevel::DEBUG;    ///< 最小日志级别
     std::string format = "[{level}] {time} {file}:{line} - {message}"; ///< 日志格式
-    size_t maxQueueSize = 10000;           ///< 最大队列大小
+    size_t maxQueueSize = 10000;           ///< 最大队列大小，有界队列算法的槽位数量（向上取整为2的幂）
+    QueueAlgorithm queueAlgorithm = QueueAlgorithm::LINKED; ///< 消息队列算法，只在日志系统停止且队列为空时切换
+    QueueWaitStrategy queueWaitStrategy = QueueWaitStrategy::NONE; ///< 消息队列已满或为空时的等待策略
+    size_t queueSegmentSize = 4096;        ///< 分段队列每段的槽位数量（向上取整为2的幂）
     size_t flushInterval = 1000;           ///< 刷新间隔（毫秒）
     bool enableTimestamp = true;           ///< 是否启用时间戳
     bool enableColor = true;               ///< 是否启用颜色输出
@@ -88,6 +220,31 @@ struct LogConfig {
     std::string logFile = "app.log";       ///< 日志文件名
     size_t maxFileSize = 10 * 1024 * 1024; ///< 最大文件大小（字节）
     int maxFileCount = 5;                  ///< 最大文件数量
+    size_t maxMemoryBytes = 0;             ///< 在途日志数据的内存上限（字节），0表示不限制。计入队列中的消息、队列结构与消息槽位数组、并行格式化中的批次和文本；不计入暂存缓冲区、错误回溯和各输出内部的缓冲区。队列预分配的部分单独就超出上限时，setConfig()保留原有队列和上限并记录错误
+    OverflowPolicy overflowPolicy = OverflowPolicy::DROP_NEWEST; ///< 超出内存上限时的溢出策略
+    size_t recycledSlotCount = 0;          ///< 预构造的消息槽位数量，大于0时启用槽位复用模式（向上取整为2的幂）
+    std::pmr::memory_resource* memoryResource = nullptr; ///< 队列节点、批处理缓冲区和格式化缓冲区的内存来源，nullptr表示默认资源；必须是线程安全的资源
+    size_t repeatWindowMs = 0;             ///< 重复消息合并窗口（毫秒），窗口内同一调用点的相同文本只输出一次，0表示不合并
+    size_t degradeQueueDepth = 0;          ///< 触发级别降级的队列深度，0表示不按队列深度降级
+    size_t degradeMemoryBytes = 0;         ///< 触发级别降级的内存使用量（字节），0表示不按内存降级
+    size_t degradeSustainMs = 1000;        ///< 压力或压力解除需持续的时间（毫秒），每持续一次提升或恢复一级
+    double degradeRecoverRatio = 0.5;      ///< 使用量降到阈值的该比例以下才视为压力解除（滞回）
+    LogLevel degradeMaxLevel = LogLevel::WARN; ///< 降级时最多提升到的级别，更高级别的日志永不因降级丢弃
+    std::string filterExpression;          ///< 分发器使用的过滤表达式（语法见LogFilter），空表示不过滤；重新设置配置即可热更新
+    std::vector<std::string> redactionKeys = {"password=", "passwd=", "secret=", "token=", "api_key=", "authorization:"}; ///< 打码装饰器的键，其后的值被打码（不区分大小写）
+    std::vector<std::string> redactionLiterals;   ///< 打码装饰器的字面量，出现即整体打码
+    bool redactCardNumbers = true;         ///< 打码装饰器是否检测银行卡号（Luhn校验，保留最后4位）
+    size_t callSiteReportIntervalMs = 0;   ///< 输出调用点排行的周期（毫秒），0表示不输出
+    size_t callSiteReportTopN = 5;         ///< 每次排行输出的调用点数量，按周期内的字节数排序
+    size_t errorBacklogSize = 0;           ///< 错误回溯：每个线程暂存的低级别日志条数，记录ERROR时先写出暂存的日志，0表示关闭
+    LogLevel errorBacklogLevel = LogLevel::INFO; ///< 错误回溯：不高于该级别的日志只暂存，不直接写出
+    bool manualDrain = false;              ///< 手动驱动模式：start()不创建工作线程，由宿主事件循环调用LogManager::poll()，下次start()时生效
+    bool syncWrite = true;                 ///< 同步写出：不低于syncWriteLevel的日志由调用线程先写完此前入队的日志，再直接写出并持久化
+    LogLevel syncWriteLevel = LogLevel::FATAL; ///< 同步写出的最低级别，可设为ERROR
+    size_t formatThreads = 0;              ///< 并行格式化线程数：格式化由线程池并行完成，再按原顺序写出，0表示由工作线程直接格式化写出
+    size_t stagingBatchSize = 0;           ///< 线程局部暂存：每个线程攒够该条数再一次发布到共享队列，0表示关闭
+    size_t stagingMaxBytes = 16 * 1024;    ///< 线程局部暂存：暂存的文本达到该字节数时立即发布
+    size_t stagingMaxDelayUs = 1000;       ///< 线程局部暂存：最早一条暂存超过该时长（微秒）时发布，空闲或已退出线程的暂存由工作线程代为发布
 };
 
 /**
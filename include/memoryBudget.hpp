@@ -0,0 +1,118 @@
+/**
+ * @file memoryBudget.hpp
+ * @brief 日志内存预算类
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 以字节为单位统计在途日志数据（队列中的记录、预分配的槽位与缓冲区等）占用的内存，
+ *          并在超出上限时拒绝新的申请，为日志系统提供硬性的内存上限
+ * @note 所有操作均为无锁原子操作，可在生产者热路径上调用
+ * @see LogManager, LogConfig
+ * @since 1.1.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace async_log {
+
+/**
+ * @brief 内存预算类
+ * @details 维护一个字节计数器，申请方在分配前调用tryAcquire()登记，释放后调用release()归还。
+ *          上限为0时表示不限制，此时只做统计
+ * @note 此实现是线程安全的
+ * @since 1.1.0
+ */
+class MemoryBudget {
+private:
+    std::atomic<size_t> used_;      ///< 当前已登记的字节数
+    std::atomic<size_t> peak_;      ///< 历史峰值字节数
+    std::atomic<size_t> limit_;     ///< 字节上限，0表示不限制
+
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] limit 字节上限，0表示不限制
+     * @since 1.1.0
+     */
+    explicit MemoryBudget(size_t limit = 0);
+
+    // 禁用拷贝构造和赋值
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+    /**
+     * @brief 尝试登记一块内存
+     * @param[in] bytes 要登记的字节数
+     * @return true表示登记成功，false表示超出上限（此时不做任何登记）
+     * @note 此操作是线程安全的
+     * @since 1.1.0
+     */
+    bool tryAcquire(size_t bytes);
+
+    /**
+     * @brief 无条件登记一块内存
+     * @details 用于已经完成分配、无法拒绝的内存（如启动时预分配的槽位），可能使用量暂时超过上限
+     * @param[in] bytes 要登记的字节数
+     * @note 此操作是线程安全的
+     * @since 1.1.0
+     */
+    void acquire(size_t bytes);
+
+    /**
+     * @brief 归还一块内存
+     * @param[in] bytes 要归还的字节数，必须与登记时一致
+     * @note 此操作是线程安全的
+     * @since 1.1.0
+     */
+    void release(size_t bytes);
+
+    /**
+     * @brief 获取当前使用量
+     * @return 当前已登记的字节数
+     * @since 1.1.0
+     */
+    size_t getUsage() const;
+
+    /**
+     * @brief 获取历史峰值
+     * @return 历史峰值字节数
+     * @since 1.1.0
+     */
+    size_t getPeakUsage() const;
+
+    /**
+     * @brief 获取字节上限
+     * @return 字节上限，0表示不限制
+     * @since 1.1.0
+     */
+    size_t getLimit() const;
+
+    /**
+     * @brief 设置字节上限
+     * @param[in] limit 新的字节上限，0表示不限制
+     * @note 降低上限不会回收已登记的内存，只影响后续的tryAcquire()
+     * @since 1.1.0
+     */
+    void setLimit(size_t limit);
+
+    /**
+     * @brief 检查一次申请是否可能成功
+     * @param[in] bytes 申请的字节数
+     * @return false表示即使预算完全空闲也无法满足该申请
+     * @since 1.1.0
+     */
+    bool canEverFit(size_t bytes) const;
+
+private:
+    /**
+     * @brief 更新峰值
+     * @param[in] current 最新的使用量
+     * @since 1.1.0
+     */
+    void updatePeak(size_t current);
+};
+
+} // namespace async_log
@@ -0,0 +1,281 @@
+/**
+ * @file rateLimiter.hpp
+ * @brief 调用点级别的限流与采样策略
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 提供按N取一采样、每个时间窗口只记录前N条、令牌桶限速三种策略。
+ *          日志宏为每个调用点创建一个静态策略对象，在生产者线程上、构造消息之前完成判断，
+ *          被拒绝的日志不会分配内存也不会进入队列。输出汇总行的调用点登记在SuppressionRegistry中，
+ *          调用点不再放行时由工作线程代为输出汇总
+ * @note 所有策略都是无锁的
+ * @see LogManager, LogCallSite
+ * @since 1.1.0
+ */
+
+#pragma once
+
+#include "logTypes.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace async_log {
+
+/**
+ * @brief 限流策略基类
+ * @details 统计被抑制的日志数量，供调用点在下一次放行时输出汇总行
+ * @since 1.1.0
+ */
+class RateLimiterBase {
+protected:
+    std::atomic<uint64_t> suppressed_;   ///< 自上次汇总以来被抑制的数量
+
+public:
+    /**
+     * @brief 构造函数
+     * @since 1.1.0
+     */
+    RateLimiterBase() : suppressed_(0) {}
+
+    // 禁用拷贝构造和赋值
+    RateLimiterBase(const RateLimiterBase&) = delete;
+    RateLimiterBase& operator=(const RateLimiterBase&) = delete;
+
+    /**
+     * @brief 取出并清零被抑制的数量
+     * @return 自上次调用以来被抑制的日志数量
+     * @since 1.1.0
+     */
+    uint64_t takeSuppressed() {
+        return suppressed_.exchange(0, std::memory_order_relaxed);
+    }
+
+protected:
+    /**
+     * @brief 记录一次判断结果
+     * @param[in] allowed 是否放行
+     * @return allowed本身
+     * @since 1.1.0
+     */
+    bool record(bool allowed) {
+        if (!allowed) {
+            suppressed_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return allowed;
+    }
+
+    /**
+     * @brief 获取单调时钟的当前时间
+     * @return 纳秒数
+     * @since 1.1.0
+     */
+    static int64_t nowNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+/**
+ * @brief 按N取一采样
+ * @details 第1、N+1、2N+1……次调用被放行；采样比例固定，不输出汇总行，因此不统计被抑制的数量
+ * @since 1.1.0
+ */
+class EveryNSampler : public RateLimiterBase {
+private:
+    std::atomic<uint64_t> counter_;   ///< 调用计数
+    uint64_t n_;                      ///< 采样间隔
+
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] n 采样间隔，0按1处理
+     * @since 1.1.0
+     */
+    explicit EveryNSampler(uint64_t n);
+
+    /**
+     * @brief 判断本次调用是否放行
+     * @return true表示放行
+     * @since 1.1.0
+     */
+    bool allow();
+};
+
+/**
+ * @brief 每个时间窗口只放行前N条
+ * @details 窗口从第一次调用开始计时，窗口结束后计数清零
+ * @since 1.1.0
+ */
+class FirstNPerIntervalLimiter : public RateLimiterBase {
+private:
+    std::atomic<int64_t> windowStart_;   ///< 当前窗口开始时间（纳秒）
+    std::atomic<uint64_t> count_;        ///< 当前窗口内的调用次数
+    uint64_t n_;                         ///< 每个窗口放行的数量
+    int64_t intervalNanos_;              ///< 窗口长度（纳秒）
+
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] n 每个窗口放行的数量
+     * @param[in] interval 窗口长度
+     * @since 1.1.0
+     */
+    FirstNPerIntervalLimiter(uint64_t n, std::chrono::milliseconds interval);
+
+    /**
+     * @brief 判断本次调用是否放行
+     * @return true表示放行
+     * @since 1.1.0
+     */
+    bool allow();
+};
+
+/**
+ * @brief 令牌桶限速
+ * @details 使用GCRA（通用信元速率算法）实现，整个桶状态只有一个原子时间戳，
+ *          长期速率不超过ratePerSecond，允许最多burst条的突发
+ * @since 1.1.0
+ */
+class TokenBucketLimiter : public RateLimiterBase {
+private:
+    std::atomic<int64_t> theoreticalArrival_;   ///< 理论到达时间（纳秒）
+    int64_t emissionInterval_;                  ///< 每个令牌的间隔（纳秒）
+    int64_t burstTolerance_;                    ///< 突发容忍度（纳秒）
+
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] ratePerSecond 每秒放行的数量，必须大于0
+     * @param[in] burst 允许的最大突发数量，0按1处理
+     * @since 1.1.0
+     */
+    TokenBucketLimiter(double ratePerSecond, uint64_t burst);
+
+    /**
+     * @brief 判断本次调用是否放行
+     * @return true表示放行
+     * @since 1.1.0
+     */
+    bool allow();
+};
+
+/**
+ * @brief 输出汇总行的限流调用点表
+ * @details 调用点被抑制后可能再也不放行，汇总行也就不会输出。工作线程定期从这里取出
+ *          尚未汇总的抑制数量，以调用点的级别和位置代为输出
+ * @see SuppressionRegistration
+ * @since 1.1.0
+ */
+class SuppressionRegistry {
+public:
+    /**
+     * @brief 待输出的汇总
+     * @since 1.1.0
+     */
+    struct Pending {
+        LogLevel level;         ///< 调用点的日志级别
+        LogCallSite site;       ///< 调用点
+        uint64_t count;         ///< 被抑制的数量
+    };
+
+private:
+    /**
+     * @brief 登记项
+     * @since 1.1.0
+     */
+    struct Entry {
+        RateLimiterBase* limiter;   ///< 限流策略
+        LogLevel level;             ///< 调用点的日志级别
+        const LogCallSite* site;    ///< 调用点
+    };
+
+    std::mutex mutex_;              ///< 保护entries_
+    std::vector<Entry> entries_;    ///< 登记项
+
+    SuppressionRegistry() = default;
+
+public:
+    /**
+     * @brief 获取全局实例
+     * @return 调用点表引用
+     * @note 此函数是线程安全的
+     * @since 1.1.0
+     */
+    static SuppressionRegistry& getInstance();
+
+    /**
+     * @brief 登记调用点
+     * @param[in] limiter 调用点的限流策略
+     * @param[in] level 调用点的日志级别
+     * @param[in] site 调用点
+     * @since 1.1.0
+     */
+    void add(RateLimiterBase& limiter, LogLevel level, const LogCallSite& site);
+
+    /**
+     * @brief 注销调用点
+     * @param[in] limiter 登记时的限流策略
+     * @since 1.1.0
+     */
+    void remove(const RateLimiterBase& limiter);
+
+    /**
+     * @brief 取出所有非零的抑制数量
+     * @return 待输出的汇总，取出的数量已清零
+     * @since 1.1.0
+     */
+    std::vector<Pending> takePending();
+
+    /**
+     * @brief 在fork前锁住调用点表
+     * @see unlockAfterFork
+     * @since 1.1.0
+     */
+    void lockForFork();
+
+    /**
+     * @brief 释放lockForFork()持有的锁
+     * @since 1.1.0
+     */
+    void unlockAfterFork();
+};
+
+/**
+ * @brief 调用点登记的作用域对象
+ * @details 与调用点的静态限流策略一同作为静态对象定义，先于策略析构，析构时注销
+ * @since 1.1.0
+ */
+class SuppressionRegistration {
+private:
+    const RateLimiterBase& limiter_;   ///< 登记的限流策略
+
+public:
+    /**
+     * @brief 构造函数，登记调用点
+     * @param[in] limiter 调用点的限流策略
+     * @param[in] level 调用点的日志级别
+     * @param[in] site 调用点，必须比本对象存活更久
+     * @since 1.1.0
+     */
+    SuppressionRegistration(RateLimiterBase& limiter, LogLevel level, const LogCallSite& site)
+        : limiter_(limiter) {
+        SuppressionRegistry::getInstance().add(limiter, level, site);
+    }
+
+    /**
+     * @brief 析构函数，注销调用点
+     * @since 1.1.0
+     */
+    ~SuppressionRegistration() {
+        SuppressionRegistry::getInstance().remove(limiter_);
+    }
+
+    // 禁用拷贝构造和赋值
+    SuppressionRegistration(const SuppressionRegistration&) = delete;
+    SuppressionRegistration& operator=(const SuppressionRegistration&) = delete;
+};
+
+} // namespace async_log
@@ -0,0 +1,171 @@
+/**
+ * @file redactionMatcher.hpp
+ * @brief 敏感信息多模式匹配器
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 将一组字面量和"键=值"规则编译为Aho-Corasick自动机（按字节等价类压缩的完整DFA），
+ *          扫描时先用规则前缀（最多3字节）预过滤跳过不可能命中的区域（支持SSE2时每次检查16字节），
+ *          命中后在原字符串上就地打码，长度保持不变。可选检测通过Luhn校验的银行卡号
+ * @note 匹配对ASCII字母不区分大小写
+ * @see RedactionDecorator
+ * @since 1.1.0
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace async_log {
+
+/**
+ * @brief 打码规则
+ * @since 1.1.0
+ */
+struct RedactionRule {
+    /**
+     * @brief 规则类型
+     * @since 1.1.0
+     */
+    enum class Kind : uint8_t {
+        LITERAL,     ///< 字面量本身是敏感信息（如已知的令牌），整体打码
+        KEY_VALUE    ///< 字面量是键（如"password="），打码其后直到分隔符为止的值
+    };
+
+    std::string pattern;            ///< 字面量
+    Kind kind = Kind::KEY_VALUE;    ///< 规则类型
+};
+
+/**
+ * @brief 敏感信息匹配器
+ * @details 构造后不可修改，扫描是只读的，因此可以被多个线程同时使用
+ * @since 1.1.0
+ */
+class RedactionMatcher {
+public:
+    static constexpr char MASK_CHAR = '*';   ///< 打码使用的字符
+
+private:
+    std::array<uint8_t, 256> byteClass_;            ///< 字节到等价类的映射，0表示不出现在任何规则中
+    size_t classCount_;                             ///< 等价类数量
+    std::vector<uint32_t> transitions_;             ///< 状态转移表，下标为 状态 * classCount_ + 等价类
+    std::vector<std::vector<uint32_t>> outputs_;    ///< 每个状态命中的规则下标（含失败链上的规则）
+    std::vector<RedactionRule> rules_;              ///< 规则
+    std::array<bool, 256> firstByte_;               ///< 能使自动机离开根状态的字节
+    bool detectCardNumbers_;                        ///< 是否检测银行卡号
+
+    /**
+     * @brief 预过滤使用的规则前缀
+     * @details 字节按"或0x20"折叠，对字母等价于转小写，对其他字节只会多出误报，不会漏报
+     * @since 1.1.0
+     */
+    struct PrefixNeedle {
+        std::array<uint8_t, 3> bytes;   ///< 折叠后的前缀字节
+        uint8_t length;                 ///< 前缀长度（1到3）
+    };
+
+    static constexpr size_t MAX_SIMD_PREFIXES = 16;  ///< 超过该数量时预过滤退回标量查表
+
+    std::vector<PrefixNeedle> prefixes_;            ///< 去重后的规则前缀
+
+    /**
+     * @brief 需要打码的区间
+     * @since 1.1.0
+     */
+    struct MaskRange {
+        size_t begin;           ///< 起始位置
+        size_t end;             ///< 结束位置（不含）
+        bool keepLastDigits;    ///< 是否保留最后4位数字（卡号）
+    };
+
+public:
+    /**
+     * @brief 构造函数，编译规则
+     * @param[in] rules 规则列表，空字面量会被忽略
+     * @param[in] detectCardNumbers 是否检测13到19位、通过Luhn校验的卡号（可含空格或短横线），只保留最后4位
+     * @since 1.1.0
+     */
+    explicit RedactionMatcher(std::vector<RedactionRule> rules, bool detectCardNumbers = false);
+
+    /**
+     * @brief 就地打码
+     * @param[in,out] text 要处理的文本
+     * @return 打码的字节数，0表示文本未被修改
+     * @since 1.1.0
+     */
+    size_t redact(std::string& text) const;
+
+    /**
+     * @brief 检查文本是否包含需要打码的内容
+     * @param[in] text 要检查的文本
+     * @return true表示包含
+     * @since 1.1.0
+     */
+    bool matches(const std::string& text) const;
+
+    /**
+     * @brief 获取规则数量
+     * @return 规则数量
+     * @since 1.1.0
+     */
+    size_t getRuleCount() const;
+
+    /**
+     * @brief 获取自动机状态数量
+     * @return 状态数量
+     * @since 1.1.0
+     */
+    size_t getStateCount() const;
+
+private:
+    /**
+     * @brief 查找所有需要打码的区间
+     * @param[in] text 文本
+     * @param[out] ranges 区间列表，stopAtFirst为true时最多一个
+     * @param[in] stopAtFirst 找到第一个区间后立即返回
+     * @since 1.1.0
+     */
+    void findRanges(const std::string& text, std::vector<MaskRange>& ranges, bool stopAtFirst) const;
+
+    /**
+     * @brief 从pos开始查找下一个可能有规则开始的位置
+     * @param[in] data 文本数据
+     * @param[in] pos 起始位置
+     * @param[in] size 文本长度
+     * @return 候选位置，没有时返回size
+     * @since 1.1.0
+     */
+    size_t nextCandidate(const char* data, size_t pos, size_t size) const;
+
+    /**
+     * @brief 从pos开始查找下一个数字
+     * @param[in] data 文本数据
+     * @param[in] pos 起始位置
+     * @param[in] size 文本长度
+     * @return 数字位置，没有时返回size
+     * @since 1.1.0
+     */
+    static size_t nextDigit(const char* data, size_t pos, size_t size);
+
+    /**
+     * @brief 查找银行卡号区间
+     * @param[in] text 文本
+     * @param[out] ranges 区间列表
+     * @param[in] stopAtFirst 找到第一个区间后立即返回
+     * @since 1.1.0
+     */
+    void findCardNumbers(const std::string& text, std::vector<MaskRange>& ranges, bool stopAtFirst) const;
+
+    /**
+     * @brief 判断字符是否结束一个值
+     * @param[in] c 字符
+     * @return true表示是值的分隔符
+     * @since 1.1.0
+     */
+    static bool isValueTerminator(char c);
+};
+
+} // namespace async_log
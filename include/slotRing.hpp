@@ -0,0 +1,257 @@
+/**
+ * @file slotRing.hpp
+ * @brief 槽位复用环形队列模板类
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 有界多生产者多消费者环形队列，槽位中的对象在构造时一次性创建并在整个生命周期内复用。
+ *          生产者直接向槽位中的对象赋值，消费者就地处理后归还槽位，对象（及其字符串容量）不会被销毁，
+ *          因此预热之后稳定状态下的入队和出队都不再分配内存
+ * @note 序号算法参考Dmitry Vyukov的有界MPMC队列
+ * @see LockFreeQueue, LogManager
+ * @since 1.1.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+
+namespace async_log {
+
+/**
+ * @brief 槽位复用环形队列模板类
+ * @details 每个槽位带有一个序号：序号等于入队位置时槽位空闲，等于入队位置+1时槽位已发布可供消费。
+ *          生产者通过回调向槽位赋值，消费者通过回调就地读取，回调期间槽位被独占
+ * @note 此实现是线程安全的。要求T可默认构造，且对T的赋值能够复用其已有资源（如std::string的容量）
+ * @tparam T 槽位中存放的对象类型
+ * @since 1.1.0
+ */
+template<typename T>
+class SlotRing {
+private:
+    /**
+     * @brief 槽位结构
+     * @since 1.1.0
+     */
+    struct Slot {
+        std::atomic<size_t> sequence;   ///< 槽位序号
+        T value;                        ///< 复用的对象
+    };
+
+    using SlotAllocator = std::pmr::polymorphic_allocator<Slot>;
+
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    Slot* slots_;                                               ///< 槽位数组
+    size_t capacity_;                                           ///< 槽位数量（2的幂）
+    size_t mask_;                                               ///< 位置掩码
+    std::pmr::memory_resource* resource_;                       ///< 槽位数组的内存来源
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueuePos_;   ///< 下一个入队位置
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> dequeuePos_;   ///< 下一个出队位置
+
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] capacity 期望的槽位数量，向上取整为2的幂，最小为2
+     * @param[in] resource 槽位数组的内存来源
+     * @since 1.1.0
+     */
+    explicit SlotRing(size_t capacity,
+                      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    /**
+     * @brief 析构函数
+     * @since 1.1.0
+     */
+    ~SlotRing();
+
+    // 禁用拷贝和移动：槽位地址在生命周期内必须稳定
+    SlotRing(const SlotRing&) = delete;
+    SlotRing& operator=(const SlotRing&) = delete;
+
+    /**
+     * @brief 尝试占用一个空闲槽位并填充
+     * @param[in] fill 填充回调，参数为槽位中对象的引用，必须完整覆盖对象的所有字段
+     * @return true表示成功发布，false表示队列已满
+     * @note 此操作是线程安全的
+     * @tparam Fill 回调类型，签名为void(T&)
+     * @since 1.1.0
+     */
+    template<typename Fill>
+    bool tryPush(Fill&& fill);
+
+    /**
+     * @brief 就地消费已发布的槽位
+     * @param[in] handler 消费回调，参数为槽位中对象的常量引用，回调返回后槽位被归还
+     * @param[in] maxCount 本次最多消费的数量
+     * @return 实际消费的数量
+     * @note 此操作是线程安全的
+     * @tparam Consume 回调类型，签名为void(const T&)
+     * @since 1.1.0
+     */
+    template<typename Consume>
+    size_t consume(Consume&& handler, size_t maxCount);
+
+    /**
+     * @brief 检查队列是否为空
+     * @return true表示没有已入队的槽位
+     * @since 1.1.0
+     */
+    bool empty() const;
+
+    /**
+     * @brief 获取已入队的槽位数量
+     * @return 槽位数量，并发情况下为近似值
+     * @since 1.1.0
+     */
+    size_t getSize() const;
+
+    /**
+     * @brief 获取槽位数量
+     * @return 槽位数量
+     * @since 1.1.0
+     */
+    size_t getCapacity() const;
+
+    /**
+     * @brief 获取槽位数组占用的字节数
+     * @return 字节数（不含对象内部的动态内存）
+     * @since 1.1.0
+     */
+    size_t getFootprint() const;
+
+    /**
+     * @brief 获取槽位数组的内存来源
+     * @return 内存资源
+     * @since 1.1.0
+     */
+    std::pmr::memory_resource* getMemoryResource() const;
+
+    /**
+     * @brief 向上取整为2的幂
+     * @details 构造函数用它计算实际槽位数量，调用方可据此判断现有队列是否满足新的容量要求
+     * @param[in] value 输入值
+     * @return 不小于value且不小于2的最小2的幂
+     * @since 1.1.0
+     */
+    static size_t roundUpToPowerOfTwo(size_t value);
+};
+
+// 模板类实现
+template<typename T>
+SlotRing<T>::SlotRing(size_t capacity, std::pmr::memory_resource* resource)
+    : slots_(nullptr), capacity_(roundUpToPowerOfTwo(capacity)), mask_(capacity_ - 1),
+      resource_(resource), enqueuePos_(0), dequeuePos_(0) {
+    SlotAllocator allocator(resource_);
+    slots_ = allocator.allocate(capacity_);
+
+    for (size_t i = 0; i < capacity_; ++i) {
+        Slot* slot = ::new (static_cast<void*>(&slots_[i])) Slot();
+        slot->sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template<typename T>
+SlotRing<T>::~SlotRing() {
+    for (size_t i = 0; i < capacity_; ++i) {
+        slots_[i].~Slot();
+    }
+
+    SlotAllocator allocator(resource_);
+    allocator.deallocate(slots_, capacity_);
+}
+
+template<typename T>
+template<typename Fill>
+bool SlotRing<T>::tryPush(Fill&& fill) {
+    size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+
+    for (;;) {
+        Slot& slot = slots_[pos & mask_];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+        if (diff == 0) {
+            // 槽位空闲，尝试占用
+            if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                fill(slot.value);
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            // 槽位仍被上一轮占用，队列已满
+            return false;
+        } else {
+            pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template<typename T>
+template<typename Consume>
+size_t SlotRing<T>::consume(Consume&& handler, size_t maxCount) {
+    size_t count = 0;
+
+    while (count < maxCount) {
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[pos & mask_];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+
+        if (diff < 0) {
+            // 槽位尚未发布，队列为空
+            break;
+        }
+
+        if (diff == 0 && dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+            handler(static_cast<const T&>(slot.value));
+            // 归还槽位给下一轮生产者，对象本身保持存活
+            slot.sequence.store(pos + mask_ + 1, std::memory_order_release);
+            count++;
+        }
+    }
+
+    return count;
+}
+
+template<typename T>
+bool SlotRing<T>::empty() const {
+    return getSize() == 0;
+}
+
+template<typename T>
+size_t SlotRing<T>::getSize() const {
+    size_t enqueued = enqueuePos_.load(std::memory_order_relaxed);
+    size_t dequeued = dequeuePos_.load(std::memory_order_relaxed);
+    return enqueued > dequeued ? enqueued - dequeued : 0;
+}
+
+template<typename T>
+size_t SlotRing<T>::getCapacity() const {
+    return capacity_;
+}
+
+template<typename T>
+size_t SlotRing<T>::getFootprint() const {
+    return capacity_ * sizeof(Slot);
+}
+
+template<typename T>
+std::pmr::memory_resource* SlotRing<T>::getMemoryResource() const {
+    return resource_;
+}
+
+template<typename T>
+size_t SlotRing<T>::roundUpToPowerOfTwo(size_t value) {
+    size_t result = 2;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace async_log
@@ -0,0 +1,127 @@
+/**
+ * @file stagingBuffer.hpp
+ * @brief 线程局部暂存缓冲区
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 日志频繁的线程先把消息攒在自己的暂存缓冲区中，攒够条数或字节数、最早一条等待过久、
+ *          线程退出或刷新时再一次发布到共享队列。共享队列上的原子操作按批摊销，
+ *          增加的延迟不超过配置的时长
+ * @see LogManager, LogConfig::stagingBatchSize
+ * @since 1.1.0
+ */
+
+#pragma once
+
+#include "logTypes.hpp"
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace async_log {
+
+/**
+ * @brief 线程局部暂存缓冲区
+ * @details 槽位在发布后保留，之后写入只是对已有消息重新赋值。
+ *          拥有者线程写入，工作线程在拥有者空闲或退出后代为发布，两者通过getMutex()互斥
+ * @note 除getMutex()外的操作都要求调用者持有该互斥锁
+ * @since 1.1.0
+ */
+class StagingBuffer {
+private:
+    std::mutex mutex_;                  ///< 拥有者写入与代为发布之间的互斥锁
+    std::vector<LogMessage> slots_;     ///< 消息槽位，前count_个有效
+    size_t count_;                      ///< 暂存的消息数量
+    size_t bytes_;                      ///< 暂存消息的文本总长度
+    bool retired_;                      ///< 拥有者线程是否已退出
+
+public:
+    /**
+     * @brief 构造函数
+     * @since 1.1.0
+     */
+    StagingBuffer();
+
+    // 禁用拷贝构造和赋值
+    StagingBuffer(const StagingBuffer&) = delete;
+    StagingBuffer& operator=(const StagingBuffer&) = delete;
+
+    /**
+     * @brief 获取互斥锁
+     * @return 互斥锁引用
+     * @since 1.1.0
+     */
+    std::mutex& getMutex();
+
+    /**
+     * @brief 暂存一条消息
+     * @param[in] payloadBytes 消息文本、文件名、函数名的总长度
+     * @param[in] fill 填充回调，必须完整覆盖消息的所有字段
+     * @since 1.1.0
+     */
+    template<typename Fill>
+    void push(size_t payloadBytes, Fill&& fill) {
+        if (count_ == slots_.size()) {
+            slots_.emplace_back();
+        }
+
+        fill(slots_[count_]);
+        count_++;
+        bytes_ += payloadBytes;
+    }
+
+    /**
+     * @brief 获取暂存的消息
+     * @param[in] index 消息下标，小于size()
+     * @return 消息引用，发布时可以移走其内容
+     * @since 1.1.0
+     */
+    LogMessage& at(size_t index);
+
+    /**
+     * @brief 获取暂存的消息数量
+     * @return 消息数量
+     * @since 1.1.0
+     */
+    size_t size() const;
+
+    /**
+     * @brief 获取暂存消息的文本总长度
+     * @return 字节数
+     * @since 1.1.0
+     */
+    size_t getBytes() const;
+
+    /**
+     * @brief 检查最早一条暂存的消息是否已等待超过指定时长
+     * @details 以消息自身的时间戳计算，系统时钟回拨时视为已超时
+     * @param[in] now 当前时间
+     * @param[in] maxDelay 最长等待时长
+     * @return true表示应当发布
+     * @since 1.1.0
+     */
+    bool isDue(std::chrono::system_clock::time_point now, std::chrono::microseconds maxDelay) const;
+
+    /**
+     * @brief 丢弃所有暂存的消息
+     * @details 只重置计数，保留槽位
+     * @since 1.1.0
+     */
+    void clear();
+
+    /**
+     * @brief 标记拥有者线程已退出
+     * @details 之后由工作线程发布剩余的消息并不再保留此缓冲区
+     * @since 1.1.0
+     */
+    void retire();
+
+    /**
+     * @brief 检查拥有者线程是否已退出
+     * @return true表示已退出
+     * @since 1.1.0
+     */
+    bool isRetired() const;
+};
+
+} // namespace async_log
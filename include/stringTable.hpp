@@ -0,0 +1,120 @@
+/**
+ * @file stringTable.hpp
+ * @brief 字符串驻留表
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 将源文件名、函数名以及重复出现的常量消息映射为小整数ID，
+ *          日志记录只携带ID，由工作线程上的格式化器解析回字符串
+ * @note 驻留是并发安全的；按ID解析是无锁的
+ * @see LogMessage, LogCallSite
+ * @since 1.1.0
+ */
+
+#pragma once
+
+#include "logTypes.hpp"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace async_log {
+
+/**
+ * @brief 字符串驻留表类
+ * @details 字符串按1024个一组分块存放，块一经分配就不再移动，因此解析返回的引用在进程生命周期内有效。
+ *          ID 0 固定表示空字符串，也用于表示"未驻留"
+ * @note 此实现是线程安全的，全局唯一实例永不析构，保证退出阶段的工作线程仍可解析ID
+ * @since 1.1.0
+ */
+class StringTable {
+public:
+    static constexpr size_t CHUNK_SIZE = 1024;   ///< 每块容纳的字符串数量
+    static constexpr size_t MAX_CHUNKS = 1024;   ///< 最大块数量，即最多约一百万个字符串
+
+private:
+    std::array<std::atomic<std::string*>, MAX_CHUNKS> chunks_;     ///< 字符串分块存储
+    std::unordered_map<std::string_view, StringId> index_;        ///< 字符串到ID的索引
+    mutable std::shared_mutex indexMutex_;                        ///< 索引读写锁
+    std::atomic<StringId> nextId_;                                ///< 下一个可分配的ID
+
+public:
+    /**
+     * @brief 获取全局驻留表实例
+     * @return 驻留表引用
+     * @note 此函数是线程安全的
+     * @since 1.1.0
+     */
+    static StringTable& getInstance();
+
+    /**
+     * @brief 构造函数
+     * @since 1.1.0
+     */
+    StringTable();
+
+    /**
+     * @brief 析构函数
+     * @since 1.1.0
+     */
+    ~StringTable();
+
+    // 禁用拷贝构造和赋值
+    StringTable(const StringTable&) = delete;
+    StringTable& operator=(const StringTable&) = delete;
+
+    /**
+     * @brief 驻留字符串
+     * @param[in] text 要驻留的字符串
+     * @return 字符串对应的ID；空字符串或驻留表已满时返回0
+     * @note 同一字符串总是得到同一个ID。此操作是线程安全的，已驻留字符串只需一次共享锁查找
+     * @since 1.1.0
+     */
+    StringId intern(std::string_view text);
+
+    /**
+     * @brief 查找已驻留的字符串
+     * @param[in] text 要查找的字符串
+     * @return 字符串对应的ID，未驻留时返回0
+     * @note 不会插入新字符串
+     * @since 1.1.0
+     */
+    StringId find(std::string_view text) const;
+
+    /**
+     * @brief 解析ID
+     * @param[in] id 字符串ID
+     * @return 对应的字符串，无效ID返回空字符串
+     * @note 此操作是无锁的
+     * @since 1.1.0
+     */
+    const std::string& resolve(StringId id) const;
+
+    /**
+     * @brief 获取已驻留的字符串数量
+     * @return 字符串数量（不含ID 0）
+     * @since 1.1.0
+     */
+    size_t size() const;
+
+    /**
+     * @brief 在fork前独占索引锁
+     * @details 保证fork时没有其他线程正在驻留字符串，子进程中的索引处于一致状态
+     * @see unlockAfterFork
+     * @since 1.1.0
+     */
+    void lockForFork();
+
+    /**
+     * @brief 释放lockForFork()持有的锁
+     * @note 在父进程和子进程中都由调用fork的线程调用
+     * @since 1.1.0
+     */
+    void unlockAfterFork();
+};
+
+} // namespace async_log
@@ -0,0 +1,221 @@
+/**
+ * @file callSiteStats.cpp
+ * @brief 调用点输出统计实现
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 实现调用点登记、线程私有计数块的分配与归并，以及统计查询
+ * @see callSiteStats.hpp
+ * @since 1.1.0
+ */
+
+#include "callSiteStats.hpp"
+#include "stringTable.hpp"
+#include <algorithm>
+
+namespace async_log {
+
+/**
+ * @brief 线程私有计数块的持有者
+ * @details 线程首次记录时登记计数块，线程退出时把计数并入汇总
+ * @since 1.1.0
+ */
+struct CallSiteStats::ThreadHolder {
+    ThreadCounters* counters;
+
+    ThreadHolder() : counters(new ThreadCounters()) {
+        CallSiteStats::getInstance().attachThread(counters);
+    }
+
+    ~ThreadHolder() {
+        CallSiteStats::getInstance().retireThread(counters);
+    }
+};
+
+namespace {
+
+void increment(std::atomic<uint64_t>& counter, uint64_t amount) {
+    // 只有拥有者线程写入，不需要原子读改写
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+} // namespace
+
+// Entry 实现
+std::string CallSiteStats::Entry::location() const {
+    return StringTable::getInstance().resolve(fileId) + ":" + std::to_string(line);
+}
+
+// CallSiteStats 实现
+CallSiteStats& CallSiteStats::getInstance() {
+    // 有意泄漏：线程局部计数块在线程退出时归并，可能晚于静态对象析构
+    static CallSiteStats* instance = new CallSiteStats();
+    return *instance;
+}
+
+uint32_t CallSiteStats::registerSite(StringId fileId, int line, StringId functionId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto key = std::make_tuple(fileId, line, functionId);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        return it->second;
+    }
+
+    if (sites_.size() >= CHUNK_SIZE * MAX_CHUNKS) {
+        return INVALID_INDEX;
+    }
+
+    uint32_t index = static_cast<uint32_t>(sites_.size());
+    sites_.push_back({fileId, functionId, line});
+    index_.emplace(key, index);
+    return index;
+}
+
+void CallSiteStats::recordEmitted(uint32_t index, size_t bytes) {
+    if (Counters* counters = localCounters(index)) {
+        increment(counters->messages, 1);
+        increment(counters->bytes, bytes);
+    }
+}
+
+void CallSiteStats::recordDropped(uint32_t index, uint64_t count) {
+    if (Counters* counters = localCounters(index)) {
+        increment(counters->drops, count);
+    }
+}
+
+std::vector<CallSiteStats::Entry> CallSiteStats::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<Entry> entries(sites_.size());
+    for (size_t i = 0; i < sites_.size(); ++i) {
+        entries[i].index = static_cast<uint32_t>(i);
+        entries[i].fileId = sites_[i].fileId;
+        entries[i].functionId = sites_[i].functionId;
+        entries[i].line = sites_[i].line;
+    }
+
+    for (size_t i = 0; i < retired_.size() && i < entries.size(); ++i) {
+        entries[i].messages += retired_[i].messages;
+        entries[i].bytes += retired_[i].bytes;
+        entries[i].drops += retired_[i].drops;
+    }
+
+    for (const ThreadCounters* counters : threads_) {
+        accumulate(*counters, entries);
+    }
+
+    return entries;
+}
+
+std::vector<CallSiteStats::Entry> CallSiteStats::topTalkers(size_t count) const {
+    return top(snapshot(), count);
+}
+
+std::vector<CallSiteStats::Entry> CallSiteStats::delta(const std::vector<Entry>& current,
+                                                       const std::vector<Entry>& previous) {
+    std::vector<Entry> result = current;
+    for (size_t i = 0; i < previous.size() && i < result.size(); ++i) {
+        result[i].messages -= std::min(result[i].messages, previous[i].messages);
+        result[i].bytes -= std::min(result[i].bytes, previous[i].bytes);
+        result[i].drops -= std::min(result[i].drops, previous[i].drops);
+    }
+    return result;
+}
+
+std::vector<CallSiteStats::Entry> CallSiteStats::top(std::vector<Entry> entries, size_t count) {
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [](const Entry& entry) {
+                      return entry.messages == 0 && entry.drops == 0;
+                  }),
+                  entries.end());
+
+    auto heavier = [](const Entry& a, const Entry& b) {
+        if (a.bytes != b.bytes) {
+            return a.bytes > b.bytes;
+        }
+        if (a.messages != b.messages) {
+            return a.messages > b.messages;
+        }
+        return a.drops > b.drops;
+    };
+
+    if (entries.size() > count) {
+        std::partial_sort(entries.begin(), entries.begin() + count, entries.end(), heavier);
+        entries.resize(count);
+    } else {
+        std::sort(entries.begin(), entries.end(), heavier);
+    }
+    return entries;
+}
+
+size_t CallSiteStats::getSiteCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sites_.size();
+}
+
+void CallSiteStats::lockForFork() {
+    mutex_.lock();
+}
+
+void CallSiteStats::unlockAfterFork() {
+    mutex_.unlock();
+}
+
+CallSiteStats::Counters* CallSiteStats::localCounters(uint32_t index) {
+    if (index == INVALID_INDEX) {
+        return nullptr;
+    }
+
+    thread_local ThreadHolder holder;
+
+    // 分块只由拥有者线程分配，发布后读取方可以看到
+    std::atomic<Counters*>& slot = holder.counters->chunks[index / CHUNK_SIZE];
+    Counters* chunk = slot.load(std::memory_order_relaxed);
+    if (!chunk) {
+        chunk = new Counters[CHUNK_SIZE];
+        slot.store(chunk, std::memory_order_release);
+    }
+    return &chunk[index % CHUNK_SIZE];
+}
+
+void CallSiteStats::attachThread(ThreadCounters* counters) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    threads_.push_back(counters);
+}
+
+void CallSiteStats::retireThread(ThreadCounters* counters) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        threads_.erase(std::remove(threads_.begin(), threads_.end(), counters), threads_.end());
+
+        if (retired_.size() < sites_.size()) {
+            retired_.resize(sites_.size());
+        }
+        accumulate(*counters, retired_);
+    }
+
+    for (auto& chunk : counters->chunks) {
+        delete[] chunk.load(std::memory_order_relaxed);
+    }
+    delete counters;
+}
+
+void CallSiteStats::accumulate(const ThreadCounters& counters, std::vector<Entry>& entries) {
+    for (size_t c = 0; c < MAX_CHUNKS && c * CHUNK_SIZE < entries.size(); ++c) {
+        const Counters* chunk = counters.chunks[c].load(std::memory_order_acquire);
+        if (!chunk) {
+            continue;
+        }
+
+        size_t end = std::min(CHUNK_SIZE, entries.size() - c * CHUNK_SIZE);
+        for (size_t i = 0; i < end; ++i) {
+            Entry& entry = entries[c * CHUNK_SIZE + i];
+            entry.messages += chunk[i].messages.load(std::memory_order_relaxed);
+            entry.bytes += chunk[i].bytes.load(std::memory_order_relaxed);
+            entry.drops += chunk[i].drops.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+} // namespace async_log
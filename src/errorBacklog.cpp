@@ -0,0 +1,46 @@
+/**
+ * @file errorBacklog.cpp
+ * @brief 错误回溯缓存实现
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 实现错误回溯环形缓存的容量管理
+ * @see errorBacklog.hpp
+ * @since 1.1.0
+ */
+
+#include "errorBacklog.hpp"
+
+namespace async_log {
+
+ErrorBacklog::ErrorBacklog() : head_(0), count_(0), overwritten_(0) {
+}
+
+void ErrorBacklog::setCapacity(size_t capacity) {
+    if (capacity == slots_.size()) {
+        return;
+    }
+
+    std::vector<LogMessage>(capacity).swap(slots_);
+    head_ = 0;
+    count_ = 0;
+}
+
+size_t ErrorBacklog::getCapacity() const {
+    return slots_.size();
+}
+
+size_t ErrorBacklog::size() const {
+    return count_;
+}
+
+uint64_t ErrorBacklog::getOverwrittenCount() const {
+    return overwritten_;
+}
+
+void ErrorBacklog::clear() {
+    head_ = 0;
+    count_ = 0;
+}
+
+} // namespace async_log
@@ -0,0 +1,256 @@
+/**
+ * @file formatPipeline.cpp
+ * @brief 并行格式化流水线实现
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 实现批次的提交、并行格式化、重排缓冲与按序写出
+ * @see formatPipeline.hpp
+ * @since 1.1.0
+ */
+
+#include "formatPipeline.hpp"
+#include "memoryBudget.hpp"
+#include <algorithm>
+#include <exception>
+
+namespace async_log {
+
+// FormatBatch 实现
+void FormatBatch::clear() {
+    count = 0;
+    targets.clear();
+    targetEnds.clear();
+    for (auto& text : texts) {
+        text.clear();
+    }
+    fallback.clear();
+    charged = 0;
+}
+
+FormatBatch::FormatBatch(std::pmr::memory_resource* resource) : messages(resource), texts(resource) {
+}
+
+// FormatPipeline 实现
+FormatPipeline::FormatPipeline(Stage format, Stage commit)
+    : format_(std::move(format)), commit_(std::move(commit)), enabled_(false),
+      nextSubmit_(0), nextCommit_(0), committing_(false), stopping_(false), maxInFlight_(0),
+      budget_(nullptr), resource_(std::pmr::get_default_resource()) {
+}
+
+FormatPipeline::~FormatPipeline() {
+    setThreadCount(0);
+}
+
+void FormatPipeline::setThreadCount(size_t threads) {
+    std::lock_guard<std::mutex> stageLock(stageMutex_);
+
+    if (threads == threads_.size()) {
+        return;
+    }
+
+    submitLocked();
+    waitIdle();
+
+    if (!threads_.empty()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        workCondition_.notify_all();
+
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+        threads_.clear();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        maxInFlight_ = threads * IN_FLIGHT_PER_THREAD;
+    }
+
+    for (size_t i = 0; i < threads; ++i) {
+        threads_.emplace_back(&FormatPipeline::formatterLoop, this);
+    }
+    enabled_ = threads > 0;
+}
+
+size_t FormatPipeline::getThreadCount() const {
+    std::lock_guard<std::mutex> stageLock(stageMutex_);
+    return threads_.size();
+}
+
+void FormatPipeline::setMemoryBudget(MemoryBudget* budget) {
+    budget_.store(budget, std::memory_order_release);
+}
+
+void FormatPipeline::setMemoryResource(std::pmr::memory_resource* resource) {
+    resource_.store(resource, std::memory_order_release);
+}
+
+bool FormatPipeline::append(const LogMessage& msg, const std::vector<size_t>& targets) {
+    std::lock_guard<std::mutex> stageLock(stageMutex_);
+
+    if (!enabled_) {
+        return false;
+    }
+
+    if (!open_) {
+        std::pmr::memory_resource* resource = resource_.load(std::memory_order_acquire);
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 内存来源更换后，旧来源的空闲批次逐个释放
+        while (!freeList_.empty() && freeList_.back()->messages.get_allocator().resource() != resource) {
+            freeList_.pop_back();
+        }
+        if (!freeList_.empty()) {
+            open_ = std::move(freeList_.back());
+            freeList_.pop_back();
+        } else {
+            open_ = std::make_unique<FormatBatch>(resource);
+        }
+    }
+
+    // 复用槽位中上一轮消息的字符串容量
+    FormatBatch& batch = *open_;
+    if (batch.count < batch.messages.size()) {
+        batch.messages[batch.count] = msg;
+    } else {
+        batch.messages.push_back(msg);
+    }
+    batch.count++;
+    batch.targets.insert(batch.targets.end(), targets.begin(), targets.end());
+    batch.targetEnds.push_back(batch.targets.size());
+
+    // 队列中的消息出队时已归还预算，复制进批次的部分由流水线接着登记，直到写出
+    if (MemoryBudget* budget = budget_.load(std::memory_order_acquire)) {
+        size_t bytes = sizeof(LogMessage) + msg.message.size() + msg.file.size() + msg.function.size();
+        budget->acquire(bytes);
+        batch.charged += bytes;
+    }
+
+    if (batch.count >= BATCH_LIMIT) {
+        submitLocked();
+    }
+    return true;
+}
+
+void FormatPipeline::submit() {
+    std::lock_guard<std::mutex> stageLock(stageMutex_);
+    submitLocked();
+}
+
+void FormatPipeline::drain() {
+    {
+        std::lock_guard<std::mutex> stageLock(stageMutex_);
+        submitLocked();
+    }
+    waitIdle();
+}
+
+void FormatPipeline::lockForFork() {
+    stageMutex_.lock();
+    mutex_.lock();
+}
+
+void FormatPipeline::unlockAfterFork() {
+    mutex_.unlock();
+    stageMutex_.unlock();
+}
+
+void FormatPipeline::submitLocked() {
+    if (!open_ || open_->count == 0) {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        doneCondition_.wait(lock, [this] { return nextSubmit_ - nextCommit_ < maxInFlight_; });
+
+        open_->sequence = nextSubmit_++;
+        queue_.push_back(std::move(open_));
+    }
+    workCondition_.notify_one();
+}
+
+void FormatPipeline::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // 只等待调用时已提交的批次，持续写入时不会一直等下去
+    uint64_t target = nextSubmit_;
+    doneCondition_.wait(lock, [this, target] { return nextCommit_ >= target; });
+}
+
+void FormatPipeline::formatterLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true) {
+        workCondition_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            return;
+        }
+
+        std::unique_ptr<FormatBatch> batch = std::move(queue_.front());
+        queue_.pop_front();
+
+        lock.unlock();
+        try {
+            format_(*batch);
+        } catch (const std::exception&) {
+            // 格式化中途失败时文本可能只写了一部分，整批改为逐条write()，仍按顺序提交
+            size_t outputs = batch->texts.size();
+            for (size_t target : batch->targets) {
+                outputs = std::max(outputs, target + 1);
+            }
+            batch->fallback.assign(outputs, 1);
+            for (auto& text : batch->texts) {
+                text.clear();
+            }
+        }
+        if (MemoryBudget* budget = budget_.load(std::memory_order_acquire)) {
+            size_t bytes = 0;
+            for (const auto& text : batch->texts) {
+                bytes += text.size();
+            }
+            budget->acquire(bytes);
+            batch->charged += bytes;
+        }
+        lock.lock();
+
+        uint64_t sequence = batch->sequence;
+        ready_.emplace(sequence, std::move(batch));
+
+        // 已有提交者时由它在写完当前批次后接着写出这一批
+        if (committing_) {
+            continue;
+        }
+
+        committing_ = true;
+        while (!ready_.empty() && ready_.begin()->first == nextCommit_) {
+            std::unique_ptr<FormatBatch> next = std::move(ready_.begin()->second);
+            ready_.erase(ready_.begin());
+
+            lock.unlock();
+            try {
+                commit_(*next);
+            } catch (const std::exception&) {
+                // 忽略写出错误，继续写出后续批次
+            }
+            if (MemoryBudget* budget = budget_.load(std::memory_order_acquire)) {
+                budget->release(next->charged);
+            }
+            next->clear();
+            lock.lock();
+
+            freeList_.push_back(std::move(next));
+            nextCommit_++;
+            doneCondition_.notify_all();
+        }
+        committing_ = false;
+    }
+}
+
+} // namespace async_log
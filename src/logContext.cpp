@@ -0,0 +1,85 @@
+/**
+ * @file logContext.cpp
+ * @brief 线程本地诊断上下文实现
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 实现上下文栈的压栈、出栈、查询和格式化
+ * @see logContext.hpp
+ * @since 1.1.0
+ */
+
+#include "logContext.hpp"
+#include "stringTable.hpp"
+
+namespace async_log {
+
+// LogContext 实现
+LogContextRef& LogContext::top() {
+    thread_local LogContextRef context;
+    return context;
+}
+
+const LogContextRef& LogContext::current() {
+    return top();
+}
+
+const std::string* LogContext::find(const LogContextRef& context, std::string_view key) {
+    StringId keyId = StringTable::getInstance().find(key);
+    if (keyId == 0) {
+        return nullptr; // 从未驻留过的键不可能出现在上下文中
+    }
+
+    return find(context, keyId);
+}
+
+const std::string* LogContext::find(const LogContextRef& context, StringId keyId) {
+    for (const LogContextNode* node = context.get(); node; node = node->parent.get()) {
+        if (node->keyId == keyId) {
+            return &node->value;
+        }
+    }
+    return nullptr;
+}
+
+void LogContext::format(const LogContextRef& context, std::pmr::string& out) {
+    if (!context) {
+        return;
+    }
+
+    out += '{';
+    appendNodes(context.get(), out);
+    out += '}';
+}
+
+std::string LogContext::toString(const LogContextRef& context) {
+    std::pmr::string buffer;
+    format(context, buffer);
+    return std::string(buffer);
+}
+
+void LogContext::appendNodes(const LogContextNode* node, std::pmr::string& out) {
+    // 节点链由内向外，先递归输出外层以保持压栈顺序
+    if (node->parent) {
+        appendNodes(node->parent.get(), out);
+        out += ' ';
+    }
+
+    out += StringTable::getInstance().resolve(node->keyId);
+    out += '=';
+    out += node->value;
+}
+
+// ScopedLogContext 实现
+ScopedLogContext::ScopedLogContext(std::string_view key, std::string value) {
+    LogContextRef& top = LogContext::top();
+    previous_ = top;
+    top = std::make_shared<const LogContextNode>(
+        previous_, StringTable::getInstance().intern(key), std::move(value));
+}
+
+ScopedLogContext::~ScopedLogContext() {
+    LogContext::top() = std::move(previous_);
+}
+
+} // namespace async_log
@@ -11,11 +11,15 @@
 
 #include "logDecorator.hpp"
 #include "logTypes.hpp"
+#include "logContext.hpp"
+#include "stringTable.hpp"
 #include <sstream>
 #include <iomanip>
 #include <chrono>
+#include <ctime>
 #include <regex>
 #include <algorithm>
+#include <vector>
 
 namespace async_log {
 
@@ -30,12 +34,30 @@ void LogDecorator::write(const LogMessage& msg) {
     }
 }
 
+void LogDecorator::writeFormatted(const std::pmr::string& text) {
+    if (wrapped_) {
+        wrapped_->writeFormatted(text);
+    }
+}
+
 void LogDecorator::flush() {
     if (wrapped_) {
         wrapped_->flush();
     }
 }
 
+void LogDecorator::sync() {
+    if (wrapped_) {
+        wrapped_->sync();
+    }
+}
+
+void LogDecorator::reopen() {
+    if (wrapped_) {
+        wrapped_->reopen();
+    }
+}
+
 void LogDecorator::close() {
     if (wrapped_) {
         wrapped_->close();
@@ -67,12 +89,23 @@ void TimestampDecorator::write(const LogMessage& msg) {
         std::string timestamp = getCurrentTimestamp();
         
         // 在消息前添加时间戳
-        decoratedMsg.message = "[" + timestamp + "] " + msg.message;
+        decoratedMsg.setMessage("[" + timestamp + "] " + msg.getMessage());
         
         wrapped_->write(decoratedMsg);
     }
 }
 
+bool TimestampDecorator::format(const LogMessage& msg, std::pmr::string& out) const {
+    if (!wrapped_) {
+        out.clear();
+        return true;
+    }
+    
+    LogMessage decoratedMsg = msg;
+    decoratedMsg.setMessage("[" + getCurrentTimestamp() + "] " + msg.getMessage());
+    return wrapped_->format(decoratedMsg, out);
+}
+
 void TimestampDecorator::setTimeFormat(const std::string& format) {
     format_ = format;
 }
@@ -81,14 +114,20 @@ std::string TimestampDecorator::getTimeFormat() const {
     return format_;
 }
 
-std::string TimestampDecorator::getCurrentTimestamp() {
+std::string TimestampDecorator::getCurrentTimestamp() const {
     auto now = std::chrono::system_clock::now();
     return formatTime(now);
 }
 
-std::string TimestampDecorator::formatTime(const std::chrono::system_clock::time_point& timePoint) {
+std::string TimestampDecorator::formatTime(const std::chrono::system_clock::time_point& timePoint) const {
     auto time_t = std::chrono::system_clock::to_time_t(timePoint);
-    auto tm = *std::localtime(&time_t);
+    std::tm tm{};
+    // 可能在多个格式化线程中同时调用，使用可重入版本
+#if defined(_WIN32)
+    localtime_s(&tm, &time_t);
+#else
+    localtime_r(&time_t, &tm);
+#endif
     
     std::ostringstream oss;
     oss << std::put_time(&tm, format_.c_str());
@@ -109,7 +148,7 @@ void ColorDecorator::write(const LogMessage& msg) {
             std::string resetCode = getResetCode();
             
             // 在消息前后添加颜色代码
-            coloredMsg.message = colorCode + msg.message + resetCode;
+            coloredMsg.setMessage(colorCode + msg.getMessage() + resetCode);
             
             wrapped_->write(coloredMsg);
         } else {
@@ -118,6 +157,21 @@ void ColorDecorator::write(const LogMessage& msg) {
     }
 }
 
+bool ColorDecorator::format(const LogMessage& msg, std::pmr::string& out) const {
+    if (!wrapped_) {
+        out.clear();
+        return true;
+    }
+    
+    if (!enableColor_) {
+        return wrapped_->format(msg, out);
+    }
+    
+    LogMessage coloredMsg = msg;
+    coloredMsg.setMessage(getColorCode(msg.level) + msg.getMessage() + getResetCode());
+    return wrapped_->format(coloredMsg, out);
+}
+
 void ColorDecorator::setColorEnabled(bool enable) {
     enableColor_ = enable;
 }
@@ -126,7 +180,7 @@ bool ColorDecorator::isColorEnabled() const {
     return enableColor_;
 }
 
-std::string ColorDecorator::getColorCode(LogLevel level) {
+std::string ColorDecorator::getColorCode(LogLevel level) const {
     switch (level) {
         case LogLevel::DEBUG: return "\033[36m"; // 青色
         case LogLevel::INFO:  return "\033[32m"; // 绿色
@@ -137,7 +191,7 @@ std::string ColorDecorator::getColorCode(LogLevel level) {
     }
 }
 
-std::string ColorDecorator::getResetCode() {
+std::string ColorDecorator::getResetCode() const {
     return "\033[0m";
 }
 
@@ -149,10 +203,10 @@ CompressionDecorator::CompressionDecorator(std::unique_ptr<ILogOutput> output,
 
 void CompressionDecorator::write(const LogMessage& msg) {
     if (wrapped_) {
-        if (enableCompression_ && msg.message.length() >= minSize_) {
+        if (enableCompression_ && msg.getMessage().length() >= minSize_) {
             // 创建压缩消息
             LogMessage compressedMsg = msg;
-            compressedMsg.message = compress(msg.message);
+            compressedMsg.setMessage(compress(msg.getMessage()));
             
             wrapped_->write(compressedMsg);
         } else {
@@ -161,6 +215,21 @@ void CompressionDecorator::write(const LogMessage& msg) {
     }
 }
 
+bool CompressionDecorator::format(const LogMessage& msg, std::pmr::string& out) const {
+    if (!wrapped_) {
+        out.clear();
+        return true;
+    }
+    
+    if (!enableCompression_ || msg.getMessage().length() < minSize_) {
+        return wrapped_->format(msg, out);
+    }
+    
+    LogMessage compressedMsg = msg;
+    compressedMsg.setMessage(compress(msg.getMessage()));
+    return wrapped_->format(compressedMsg, out);
+}
+
 void CompressionDecorator::setCompressionEnabled(bool enable) {
     enableCompression_ = enable;
 }
@@ -169,7 +238,7 @@ void CompressionDecorator::setMinCompressionSize(size_t minSize) {
     minSize_ = minSize;
 }
 
-std::string CompressionDecorator::compress(const std::string& data) {
+std::string CompressionDecorator::compress(const std::string& data) const {
     // 简单的压缩实现：移除多余空格和换行
     std::string compressed = data;
     
@@ -198,12 +267,25 @@ FilterDecorator::FilterDecorator(std::unique_ptr<ILogOutput> output,
     : LogDecorator(std::move(output)), filter_(std::move(filter)) {
 }
 
+FilterDecorator::FilterDecorator(std::unique_ptr<ILogOutput> output, 
+                               std::shared_ptr<const LogFilter> expression)
+    : LogDecorator(std::move(output)), expression_(std::move(expression)) {
+}
+
 void FilterDecorator::write(const LogMessage& msg) {
     if (wrapped_ && shouldPass(msg)) {
         wrapped_->write(msg);
     }
 }
 
+bool FilterDecorator::format(const LogMessage& msg, std::pmr::string& out) const {
+    if (!wrapped_ || !shouldPass(msg)) {
+        out.clear();
+        return true;
+    }
+    return wrapped_->format(msg, out);
+}
+
 void FilterDecorator::setFilter(std::function<bool(const LogMessage&)> filter) {
     filter_ = std::move(filter);
 }
@@ -212,13 +294,125 @@ void FilterDecorator::clearFilter() {
     filter_ = nullptr;
 }
 
-bool FilterDecorator::shouldPass(const LogMessage& msg) {
+bool FilterDecorator::setFilterExpression(const std::string& expression, std::string* error) {
+    if (expression.find_first_not_of(" \t\r\n") == std::string::npos) {
+        std::atomic_store(&expression_, std::shared_ptr<const LogFilter>());
+        return true;
+    }
+    
+    auto filter = LogFilter::compile(expression, error);
+    if (!filter) {
+        return false;
+    }
+    
+    std::atomic_store(&expression_, std::move(filter));
+    return true;
+}
+
+bool FilterDecorator::shouldPass(const LogMessage& msg) const {
+    auto expression = std::atomic_load(&expression_);
+    if (expression && !expression->evaluate(msg)) {
+        return false;
+    }
+    
     if (filter_) {
         return filter_(msg);
     }
     return true; // 没有过滤器时默认通过
 }
 
+// RedactionDecorator 实现
+RedactionDecorator::RedactionDecorator(std::unique_ptr<ILogOutput> output, 
+                                     std::shared_ptr<const RedactionMatcher> matcher)
+    : LogDecorator(std::move(output)), matcher_(std::move(matcher)) {
+}
+
+void RedactionDecorator::write(const LogMessage& msg) {
+    if (!wrapped_) {
+        return;
+    }
+    
+    auto matcher = std::atomic_load(&matcher_);
+    LogMessage redactedMsg;
+    if (matcher && redactMessage(*matcher, msg, redactedMsg)) {
+        wrapped_->write(redactedMsg);
+    } else {
+        wrapped_->write(msg);
+    }
+}
+
+bool RedactionDecorator::format(const LogMessage& msg, std::pmr::string& out) const {
+    if (!wrapped_) {
+        out.clear();
+        return true;
+    }
+    
+    auto matcher = std::atomic_load(&matcher_);
+    LogMessage redactedMsg;
+    if (matcher && redactMessage(*matcher, msg, redactedMsg)) {
+        return wrapped_->format(redactedMsg, out);
+    }
+    return wrapped_->format(msg, out);
+}
+
+bool RedactionDecorator::redactMessage(const RedactionMatcher& matcher, const LogMessage& msg,
+                                       LogMessage& redacted) {
+    bool messageMatched = matcher.matches(msg.getMessage());
+    LogContextRef context = msg.context ? redactContext(matcher, msg.context) : nullptr;
+    if (!messageMatched && !context) {
+        return false;
+    }
+    
+    redacted = msg;
+    if (messageMatched) {
+        std::string text = msg.getMessage();
+        matcher.redact(text);
+        redacted.setMessage(std::move(text));
+    }
+    if (context) {
+        redacted.context = std::move(context);
+    }
+    return true;
+}
+
+LogContextRef RedactionDecorator::redactContext(const RedactionMatcher& matcher, const LogContextRef& context) {
+    struct Entry {
+        const LogContextNode* node;
+        bool matched;
+        std::string value;      ///< 打码后的值，只在命中时有效
+    };
+    
+    // 由内到外收集条目，按格式化输出的"键=值"匹配；打码不改变长度，去掉键前缀即为新值
+    std::vector<Entry> entries;
+    size_t outermostMatch = 0;
+    for (const LogContextNode* node = context.get(); node; node = node->parent.get()) {
+        const std::string& key = StringTable::getInstance().resolve(node->keyId);
+        std::string text = key + '=' + node->value;
+        bool matched = matcher.redact(text) > 0;
+        entries.push_back({node, matched, matched ? text.substr(key.size() + 1) : std::string()});
+        if (matched) {
+            outermostMatch = entries.size();
+        }
+    }
+    
+    if (outermostMatch == 0) {
+        return nullptr;
+    }
+    
+    // 最外层命中条目的外层原样共享，其内的条目依次重建
+    LogContextRef rebuilt = entries[outermostMatch - 1].node->parent;
+    for (size_t i = outermostMatch; i-- > 0;) {
+        Entry& entry = entries[i];
+        rebuilt = std::make_shared<const LogContextNode>(
+            std::move(rebuilt), entry.node->keyId, entry.matched ? std::move(entry.value) : entry.node->value);
+    }
+    return rebuilt;
+}
+
+void RedactionDecorator::setMatcher(std::shared_ptr<const RedactionMatcher> matcher) {
+    std::atomic_store(&matcher_, std::move(matcher));
+}
+
 // FormatDecorator 实现
 FormatDecorator::FormatDecorator(std::unique_ptr<ILogOutput> output, const std::string& format)
     : LogDecorator(std::move(output)), format_(format) {
@@ -228,12 +422,23 @@ void FormatDecorator::write(const LogMessage& msg) {
     if (wrapped_) {
         // 创建格式化消息
         LogMessage formattedMsg = msg;
-        formattedMsg.message = formatMessage(msg);
+        formattedMsg.setMessage(formatMessage(msg));
         
         wrapped_->write(formattedMsg);
     }
 }
 
+bool FormatDecorator::format(const LogMessage& msg, std::pmr::string& out) const {
+    if (!wrapped_) {
+        out.clear();
+        return true;
+    }
+    
+    LogMessage formattedMsg = msg;
+    formattedMsg.setMessage(formatMessage(msg));
+    return wrapped_->format(formattedMsg, out);
+}
+
 void FormatDecorator::setFormat(const std::string& format) {
     format_ = format;
 }
@@ -242,23 +447,24 @@ std::string FormatDecorator::getFormat() const {
     return format_;
 }
 
-std::string FormatDecorator::formatMessage(const LogMessage& msg) {
+std::string FormatDecorator::formatMessage(const LogMessage& msg) const {
     return replacePlaceholders(format_, msg);
 }
 
-std::string FormatDecorator::replacePlaceholders(const std::string& format, const LogMessage& msg) {
+std::string FormatDecorator::replacePlaceholders(const std::string& format, const LogMessage& msg) const {
     std::string result = format;
     
     // 替换各种占位符
     std::map<std::string, std::string> replacements = {
         {"{level}", levelToString(msg.level)},
-        {"{message}", msg.message},
-        {"{file}", msg.file},
+        {"{message}", msg.getMessage()},
+        {"{file}", msg.getFile()},
         {"{line}", std::to_string(msg.line)},
-        {"{function}", msg.function},
+        {"{function}", msg.getFunction()},
         {"{time}", std::to_string(std::chrono::duration_cast<std::chrono::seconds>(
             msg.timestamp.time_since_epoch()).count())},
-        {"{thread}", std::to_string(std::hash<std::thread::id>{}(msg.threadId))}
+        {"{thread}", std::to_string(std::hash<std::thread::id>{}(msg.threadId))},
+        {"{context}", LogContext::toString(msg.context)}
     };
     
     for (const auto& [placeholder, value] : replacements) {
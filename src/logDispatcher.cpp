@@ -14,30 +14,41 @@
 #include <algorithm>
 #include <random>
 #include <chrono>
+#include <new>
+#include <string_view>
 
 namespace async_log {
 
 LogDispatcher::LogDispatcher()
-    : routingStrategy_(0), roundRobinCounter_(0) {
+    : repeatWindow_(0), pendingRepeats_(0), pipeline_(createPipeline()), memoryBudget_(nullptr),
+      memoryResource_(std::pmr::get_default_resource()),
+      routingStrategy_(0), roundRobinCounter_(0) {
 }
 
 LogDispatcher::~LogDispatcher() = default;
 
-LogDispatcher::LogDispatcher(LogDispatcher&& other) noexcept
-    : outputs_(std::move(other.outputs_)),
-      messageFilter_(std::move(other.messageFilter_)),
-      routeFunction_(std::move(other.routeFunction_)),
-      routingStrategy_(other.routingStrategy_),
-      roundRobinCounter_(other.roundRobinCounter_.load()) {
+LogDispatcher::LogDispatcher(LogDispatcher&& other) noexcept : LogDispatcher() {
+    *this = std::move(other);
 }
 
 LogDispatcher& LogDispatcher::operator=(LogDispatcher&& other) noexcept {
     if (this != &other) {
+        // 流水线绑定在各自的对象上，先写出两边在途的批次，再按原线程数重新启用
+        size_t threads = other.pipeline_->getThreadCount();
+        pipeline_->setThreadCount(0);
+        other.pipeline_->setThreadCount(0);
+        
         outputs_ = std::move(other.outputs_);
         messageFilter_ = std::move(other.messageFilter_);
         routeFunction_ = std::move(other.routeFunction_);
+        std::atomic_store(&compiledFilter_, std::atomic_load(&other.compiledFilter_));
+        repeatTable_ = std::move(other.repeatTable_);
+        repeatWindow_ = other.repeatWindow_;
+        pendingRepeats_ = other.pendingRepeats_;
         routingStrategy_ = other.routingStrategy_;
         roundRobinCounter_ = other.roundRobinCounter_.load();
+        
+        pipeline_->setThreadCount(threads);
     }
     return *this;
 }
@@ -47,10 +58,34 @@ size_t LogDispatcher::dispatch(const LogMessage& msg) {
         return 0;
     }
     
+    std::vector<LogMessage> summaries;
+    {
+        std::lock_guard<std::mutex> lock(repeatMutex_);
+        
+        if (repeatWindow_.count() > 0 && registerRepeat(msg, summaries)) {
+            return 0; // 窗口内的重复消息只计数
+        }
+    }
+    
+    // 被替换表项的汇总行先于新消息输出
+    for (const auto& summary : summaries) {
+        writeToOutputs(summary);
+    }
+    
+    return writeToOutputs(msg);
+}
+
+size_t LogDispatcher::writeToOutputs(const LogMessage& msg) {
     std::vector<size_t> targetOutputs = getTargetOutputs(msg);
+    
+    // 启用并行格式化时只加入当前批次，由流水线按顺序写出
+    if (pipeline_->append(msg, targetOutputs)) {
+        return targetOutputs.size();
+    }
+    
     size_t successCount = 0;
     
-    std::lock_guard<std::mutex> lock(outputsMutex_);
+    std::lock_guard<std::shared_mutex> lock(outputsMutex_);
     
     for (size_t index : targetOutputs) {
         if (index < outputs_.size() && outputs_[index] && outputs_[index]->isAvailable()) {
@@ -67,12 +102,14 @@ size_t LogDispatcher::dispatch(const LogMessage& msg) {
 }
 
 void LogDispatcher::addOutput(std::unique_ptr<ILogOutput> output) {
-    std::lock_guard<std::mutex> lock(outputsMutex_);
+    std::lock_guard<std::shared_mutex> lock(outputsMutex_);
     outputs_.push_back(std::move(output));
 }
 
 bool LogDispatcher::removeOutput(size_t index) {
-    std::lock_guard<std::mutex> lock(outputsMutex_);
+    // 在途批次按输出下标记录目标，先写出再调整下标
+    pipeline_->drain();
+    std::lock_guard<std::shared_mutex> lock(outputsMutex_);
     
     if (index >= outputs_.size()) {
         return false;
@@ -83,22 +120,49 @@ bool LogDispatcher::removeOutput(size_t index) {
 }
 
 void LogDispatcher::clearOutputs() {
-    std::lock_guard<std::mutex> lock(outputsMutex_);
+    pipeline_->drain();
+    std::lock_guard<std::shared_mutex> lock(outputsMutex_);
     outputs_.clear();
 }
 
 size_t LogDispatcher::getOutputCount() const {
-    std::lock_guard<std::mutex> lock(outputsMutex_);
+    std::lock_guard<std::shared_mutex> lock(outputsMutex_);
     return outputs_.size();
 }
 
 void LogDispatcher::flush() {
-    std::lock_guard<std::mutex> lock(outputsMutex_);
+    flushOutputs(false);
+}
+
+void LogDispatcher::sync() {
+    flushOutputs(true);
+}
+
+void LogDispatcher::flushOutputs(bool durable) {
+    // 先输出所有未完成的重复汇总行，保证刷新后输出内容完整
+    std::vector<LogMessage> summaries;
+    {
+        std::lock_guard<std::mutex> repeatLock(repeatMutex_);
+        collectRepeats(true, summaries);
+    }
+    
+    for (const auto& summary : summaries) {
+        writeToOutputs(summary);
+    }
+    
+    // 刷新前等待流水线写出所有已分发的消息
+    pipeline_->drain();
+    
+    std::lock_guard<std::shared_mutex> lock(outputsMutex_);
     
     for (auto& output : outputs_) {
         if (output && output->isAvailable()) {
             try {
-                output->flush();
+                if (durable) {
+                    output->sync();
+                } else {
+                    output->flush();
+                }
             } catch (const std::exception&) {
                 // 忽略flush错误
             }
@@ -107,7 +171,8 @@ void LogDispatcher::flush() {
 }
 
 void LogDispatcher::close() {
-    std::lock_guard<std::mutex> lock(outputsMutex_);
+    pipeline_->drain();
+    std::lock_guard<std::shared_mutex> lock(outputsMutex_);
     
     for (auto& output : outputs_) {
         if (output) {
@@ -120,10 +185,105 @@ void LogDispatcher::close() {
     }
 }
 
+void LogDispatcher::reopenOutputs() {
+    std::lock_guard<std::shared_mutex> lock(outputsMutex_);
+    
+    for (auto& output : outputs_) {
+        if (output) {
+            try {
+                output->reopen();
+            } catch (const std::exception&) {
+                // 忽略重新打开错误，输出保持不可用
+            }
+        }
+    }
+}
+
+void LogDispatcher::lockForFork() {
+    // 格式化线程必须都在等待新批次，子进程才能安全地丢弃它们
+    pipeline_->drain();
+    
+    // 与flushOutputs()相同的顺序
+    repeatMutex_.lock();
+    outputsMutex_.lock();
+    pipeline_->lockForFork();
+}
+
+void LogDispatcher::unlockAfterFork() {
+    pipeline_->unlockAfterFork();
+    outputsMutex_.unlock();
+    repeatMutex_.unlock();
+}
+
+void LogDispatcher::reinitializeAfterFork() {
+    // 读写锁按线程ID识别写锁持有者，子进程中调用fork的线程ID已经改变，无法正常解锁，只能就地重建
+    pipeline_->unlockAfterFork();
+    new (&outputsMutex_) std::shared_mutex();
+    repeatMutex_.unlock();
+    
+    // 子进程中没有格式化线程，而旧流水线的条件变量上还登记着它们，只能丢弃不析构
+    size_t threads = pipeline_->getThreadCount();
+    if (threads > 0) {
+        pipeline_.release();
+        pipeline_ = createPipeline();
+        pipeline_->setMemoryBudget(memoryBudget_);
+        pipeline_->setMemoryResource(memoryResource_);
+        pipeline_->setThreadCount(threads);
+    }
+    
+    reopenOutputs();
+}
+
+void LogDispatcher::setMemoryBudget(MemoryBudget* budget) {
+    memoryBudget_ = budget;
+    pipeline_->setMemoryBudget(budget);
+}
+
+void LogDispatcher::setMemoryResource(std::pmr::memory_resource* resource) {
+    memoryResource_ = resource;
+    pipeline_->setMemoryResource(resource);
+}
+
+void LogDispatcher::setFormatThreads(size_t threads) {
+    pipeline_->setThreadCount(threads);
+}
+
+size_t LogDispatcher::getFormatThreads() const {
+    return pipeline_->getThreadCount();
+}
+
+void LogDispatcher::submitBatch() {
+    pipeline_->submit();
+}
+
 void LogDispatcher::setMessageFilter(std::function<bool(const LogMessage&)> filter) {
     messageFilter_ = std::move(filter);
 }
 
+bool LogDispatcher::setFilterExpression(const std::string& expression, std::string* error) {
+    if (expression.find_first_not_of(" \t\r\n") == std::string::npos) {
+        setCompiledFilter(nullptr);
+        return true;
+    }
+    
+    auto filter = LogFilter::compile(expression, error);
+    if (!filter) {
+        return false;
+    }
+    
+    setCompiledFilter(std::move(filter));
+    return true;
+}
+
+void LogDispatcher::setCompiledFilter(std::shared_ptr<const LogFilter> filter) {
+    std::atomic_store(&compiledFilter_, std::move(filter));
+}
+
+std::string LogDispatcher::getFilterExpression() const {
+    auto filter = std::atomic_load(&compiledFilter_);
+    return filter ? filter->getExpression() : std::string();
+}
+
 void LogDispatcher::setRouteFunction(std::function<size_t(const LogMessage&)> router) {
     routeFunction_ = std::move(router);
 }
@@ -140,7 +300,131 @@ void LogDispatcher::setDefaultRoutingStrategy(int strategy) {
     routingStrategy_ = strategy;
 }
 
+void LogDispatcher::setRepeatWindow(std::chrono::milliseconds window) {
+    std::vector<LogMessage> summaries;
+    {
+        std::lock_guard<std::mutex> lock(repeatMutex_);
+        
+        if (window.count() > 0) {
+            if (repeatTable_.empty()) {
+                repeatTable_.resize(REPEAT_TABLE_SIZE);
+            }
+        } else {
+            collectRepeats(true, summaries);
+            repeatTable_.clear();
+            repeatTable_.shrink_to_fit();
+        }
+        repeatWindow_ = window;
+    }
+    
+    for (const auto& summary : summaries) {
+        writeToOutputs(summary);
+    }
+    pipeline_->submit();
+}
+
+std::chrono::milliseconds LogDispatcher::getRepeatWindow() const {
+    std::lock_guard<std::mutex> lock(repeatMutex_);
+    return repeatWindow_;
+}
+
+void LogDispatcher::expireRepeats() {
+    std::vector<LogMessage> summaries;
+    {
+        std::lock_guard<std::mutex> lock(repeatMutex_);
+        
+        if (pendingRepeats_ == 0) {
+            return;
+        }
+        collectRepeats(false, summaries);
+    }
+    
+    for (const auto& summary : summaries) {
+        writeToOutputs(summary);
+    }
+    pipeline_->submit();
+}
+
+bool LogDispatcher::registerRepeat(const LogMessage& msg, std::vector<LogMessage>& summaries) {
+    size_t hash = repeatHash(msg);
+    RepeatEntry& entry = repeatTable_[hash % REPEAT_TABLE_SIZE];
+    
+    if (entry.occupied && entry.hash == hash && isSameRepeat(entry.first, msg) &&
+        msg.timestamp - entry.first.timestamp < repeatWindow_) {
+        if (entry.repeatCount++ == 0) {
+            pendingRepeats_++;
+        }
+        entry.lastSeen = msg.timestamp;
+        return true;
+    }
+    
+    // 窗口已结束或表项被其他消息占用：结算旧表项后由新消息接管
+    if (entry.occupied && entry.repeatCount > 0) {
+        summaries.push_back(makeRepeatSummary(entry));
+        pendingRepeats_--;
+    }
+    
+    entry.occupied = true;
+    entry.hash = hash;
+    entry.first = msg;
+    entry.repeatCount = 0;
+    entry.lastSeen = msg.timestamp;
+    return false;
+}
+
+void LogDispatcher::collectRepeats(bool force, std::vector<LogMessage>& summaries) {
+    if (pendingRepeats_ == 0) {
+        return;
+    }
+    
+    auto now = std::chrono::system_clock::now();
+    
+    for (auto& entry : repeatTable_) {
+        if (entry.occupied && entry.repeatCount > 0 &&
+            (force || now - entry.first.timestamp >= repeatWindow_)) {
+            summaries.push_back(makeRepeatSummary(entry));
+            entry.occupied = false;
+            pendingRepeats_--;
+        }
+    }
+}
+
+LogMessage LogDispatcher::makeRepeatSummary(RepeatEntry& entry) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        entry.lastSeen - entry.first.timestamp).count();
+    
+    LogMessage summary = entry.first;
+    summary.timestamp = entry.lastSeen;
+    summary.setMessage("[重复] 上述日志重复了 " + std::to_string(entry.repeatCount) +
+                       " 次，历时 " + std::to_string(elapsed) + " ms");
+    
+    entry.repeatCount = 0;
+    return summary;
+}
+
+size_t LogDispatcher::repeatHash(const LogMessage& msg) {
+    // 驻留的字符串直接用ID参与哈希，避免解析
+    size_t hash = msg.messageId != 0 ? std::hash<StringId>{}(msg.messageId)
+                                     : std::hash<std::string_view>{}(msg.getMessage());
+    size_t fileHash = msg.fileId != 0 ? std::hash<StringId>{}(msg.fileId)
+                                      : std::hash<std::string_view>{}(msg.getFile());
+    
+    hash ^= fileHash + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    hash ^= static_cast<size_t>(msg.line) * 31 + static_cast<size_t>(msg.level);
+    return hash;
+}
+
+bool LogDispatcher::isSameRepeat(const LogMessage& a, const LogMessage& b) {
+    return a.level == b.level && a.line == b.line &&
+           a.getFile() == b.getFile() && a.getMessage() == b.getMessage();
+}
+
 bool LogDispatcher::shouldDispatch(const LogMessage& msg) {
+    auto filter = std::atomic_load(&compiledFilter_);
+    if (filter && !filter->evaluate(msg)) {
+        return false;
+    }
+    
     if (messageFilter_) {
         return messageFilter_(msg);
     }
@@ -165,7 +449,7 @@ std::vector<size_t> LogDispatcher::defaultRouting(const LogMessage& msg) {
         case 2: return randomRouting(msg);
         default: {
             std::vector<size_t> indices;
-            std::lock_guard<std::mutex> lock(outputsMutex_);
+            std::shared_lock<std::shared_mutex> lock(outputsMutex_);
             
             for (size_t i = 0; i < outputs_.size(); ++i) {
                 indices.push_back(i);
@@ -177,7 +461,7 @@ std::vector<size_t> LogDispatcher::defaultRouting(const LogMessage& msg) {
 }
 
 std::vector<size_t> LogDispatcher::roundRobinRouting(const LogMessage& msg) {
-    std::lock_guard<std::mutex> lock(outputsMutex_);
+    std::shared_lock<std::shared_mutex> lock(outputsMutex_);
     
     if (outputs_.empty()) {
         return {};
@@ -188,7 +472,7 @@ std::vector<size_t> LogDispatcher::roundRobinRouting(const LogMessage& msg) {
 }
 
 std::vector<size_t> LogDispatcher::randomRouting(const LogMessage& msg) {
-    std::lock_guard<std::mutex> lock(outputsMutex_);
+    std::shared_lock<std::shared_mutex> lock(outputsMutex_);
     
     if (outputs_.empty()) {
         return {};
@@ -206,4 +490,85 @@ std::vector<size_t> LogDispatcher::randomRouting(const LogMessage& msg) {
     return {index};
 }
 
+std::unique_ptr<FormatPipeline> LogDispatcher::createPipeline() {
+    return std::make_unique<FormatPipeline>([this](FormatBatch& batch) { formatBatch(batch); },
+                                            [this](FormatBatch& batch) { commitBatch(batch); });
+}
+
+void LogDispatcher::formatBatch(FormatBatch& batch) {
+    std::shared_lock<std::shared_mutex> lock(outputsMutex_);
+    
+    size_t outputCount = outputs_.size();
+    if (batch.texts.size() < outputCount) {
+        batch.texts.resize(outputCount);
+    }
+    batch.fallback.assign(outputCount, 0);
+    
+    std::pmr::string line(batch.texts.get_allocator());
+    size_t begin = 0;
+    
+    for (size_t i = 0; i < batch.count; ++i) {
+        const LogMessage& msg = batch.messages[i];
+        size_t end = batch.targetEnds[i];
+        
+        for (size_t t = begin; t < end; ++t) {
+            size_t index = batch.targets[t];
+            if (index >= outputCount || !outputs_[index] || batch.fallback[index]) {
+                continue;
+            }
+            
+            bool formatted = false;
+            try {
+                formatted = outputs_[index]->format(msg, line);
+            } catch (const std::exception&) {
+                // 格式化失败时交给write()处理
+            }
+            
+            if (formatted) {
+                batch.texts[index] += line;
+            } else {
+                // 整批改为逐条写出，丢弃已格式化的部分
+                batch.fallback[index] = 1;
+                batch.texts[index].clear();
+            }
+        }
+        begin = end;
+    }
+}
+
+void LogDispatcher::commitBatch(FormatBatch& batch) {
+    // 流水线保证同一时刻只有一个批次在写出，各输出自带锁，共享持有即可与格式化和路由并行
+    std::shared_lock<std::shared_mutex> lock(outputsMutex_);
+    
+    size_t outputCount = std::min(batch.fallback.size(), outputs_.size());
+    
+    for (size_t index = 0; index < outputCount; ++index) {
+        ILogOutput* output = outputs_[index].get();
+        if (!output || !output->isAvailable()) {
+            continue;
+        }
+        
+        try {
+            if (!batch.fallback[index]) {
+                if (!batch.texts[index].empty()) {
+                    output->writeFormatted(batch.texts[index]);
+                }
+                continue;
+            }
+            
+            size_t begin = 0;
+            for (size_t i = 0; i < batch.count; ++i) {
+                size_t end = batch.targetEnds[i];
+                if (std::find(batch.targets.begin() + begin, batch.targets.begin() + end, index) !=
+                    batch.targets.begin() + end) {
+                    output->write(batch.messages[i]);
+                }
+                begin = end;
+            }
+        } catch (const std::exception&) {
+            // 忽略输出错误，继续处理其他输出
+        }
+    }
+}
+
 } // namespace async_log
@@ -194,17 +194,22 @@ std::unique_ptr<ILogOutput> LogOutputFactory::createFromConfig(const LogConfig&
 std::unique_ptr<ILogOutput> LogOutputFactory::createFileOutput(const LogConfig& config) {
     return std::make_unique<FileOutput>(config.logDir + "/" + config.logFile,
                                        config.maxFileSize,
-                                       config.maxFileCount);
+                                       config.maxFileCount,
+                                       resourceFromConfig(config));
 }
 
 std::unique_ptr<ILogOutput> LogOutputFactory::createConsoleOutput(const LogConfig& config) {
-    return std::make_unique<ConsoleOutput>(config.enableColor);
+    return std::make_unique<ConsoleOutput>(config.enableColor, resourceFromConfig(config));
 }
 
 std::unique_ptr<ILogOutput> LogOutputFactory::createNetworkOutput(const LogConfig& config) {
     // 这里应该从配置中读取网络参数
     // 暂时使用默认值
-    return std::make_unique<NetworkOutput>("localhost", 8080);
+    return std::make_unique<NetworkOutput>("localhost", 8080, resourceFromConfig(config));
+}
+
+std::pmr::memory_resource* LogOutputFactory::resourceFromConfig(const LogConfig& config) {
+    return config.memoryResource ? config.memoryResource : std::pmr::get_default_resource();
 }
 
 // 内置装饰器创建函数
@@ -225,6 +230,13 @@ std::unique_ptr<LogDecorator> LogOutputFactory::createCompressionDecorator(
 
 std::unique_ptr<LogDecorator> LogOutputFactory::createFilterDecorator(
     std::unique_ptr<ILogOutput> output, const LogConfig& config) {
+    // 配置了过滤表达式时优先使用表达式
+    if (!config.filterExpression.empty()) {
+        if (auto expression = LogFilter::compile(config.filterExpression)) {
+            return std::make_unique<FilterDecorator>(std::move(output), std::move(expression));
+        }
+    }
+    
     // 创建默认过滤器：只允许指定级别以上的日志
     auto filter = [config](const LogMessage& msg) {
         return static_cast<int>(msg.level) >= static_cast<int>(config.minLevel);
@@ -238,6 +250,20 @@ std::unique_ptr<LogDecorator> LogOutputFactory::createFormatDecorator(
     return std::make_unique<FormatDecorator>(std::move(output), config.format);
 }
 
+std::unique_ptr<LogDecorator> LogOutputFactory::createRedactionDecorator(
+    std::unique_ptr<ILogOutput> output, const LogConfig& config) {
+    std::vector<RedactionRule> rules;
+    for (const auto& key : config.redactionKeys) {
+        rules.push_back({key, RedactionRule::Kind::KEY_VALUE});
+    }
+    for (const auto& literal : config.redactionLiterals) {
+        rules.push_back({literal, RedactionRule::Kind::LITERAL});
+    }
+    
+    auto matcher = std::make_shared<const RedactionMatcher>(std::move(rules), config.redactCardNumbers);
+    return std::make_unique<RedactionDecorator>(std::move(output), std::move(matcher));
+}
+
 void LogOutputFactory::initializeBuiltinTypes() {
     // 注册内置输出类型
     outputCreators_["file"] = createFileOutput;
@@ -250,6 +276,7 @@ void LogOutputFactory::initializeBuiltinTypes() {
     decoratorCreators_["compression"] = createCompressionDecorator;
     decoratorCreators_["filter"] = createFilterDecorator;
     decoratorCreators_["format"] = createFormatDecorator;
+    decoratorCreators_["redaction"] = createRedactionDecorator;
 }
 
 // 字符串转换函数
@@ -278,6 +305,7 @@ std::string LogOutputFactory::decoratorTypeToString(DecoratorType type) {
         case DecoratorType::COMPRESSION: return "compression";
         case DecoratorType::FILTER: return "filter";
         case DecoratorType::FORMAT: return "format";
+        case DecoratorType::REDACTION: return "redaction";
         case DecoratorType::CUSTOM: return "custom";
         default: return "unknown";
     }
@@ -289,6 +317,7 @@ LogOutputFactory::DecoratorType LogOutputFactory::stringToDecoratorType(const st
     if (str == "compression") return DecoratorType::COMPRESSION;
     if (str == "filter") return DecoratorType::FILTER;
     if (str == "format") return DecoratorType::FORMAT;
+    if (str == "redaction") return DecoratorType::REDACTION;
     if (str == "custom") return DecoratorType::CUSTOM;
     return DecoratorType::TIMESTAMP; // 默认
 }
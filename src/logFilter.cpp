@@ -0,0 +1,601 @@
+/**
+ * @file logFilter.cpp
+ * @brief 日志过滤表达式实现
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 实现表达式的词法分析、递归下降编译和字节码求值
+ * @see logFilter.hpp
+ * @since 1.1.0
+ */
+
+#include "logFilter.hpp"
+#include "logContext.hpp"
+#include "stringTable.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <functional>
+#include <string_view>
+
+namespace async_log {
+
+namespace {
+
+/**
+ * @brief 词法单元类型
+ * @since 1.1.0
+ */
+enum class TokenType {
+    IDENTIFIER, STRING, NUMBER, OPERATOR, LEFT_PAREN, RIGHT_PAREN, END
+};
+
+/**
+ * @brief 词法单元
+ * @since 1.1.0
+ */
+struct Token {
+    TokenType type;     ///< 类型
+    std::string text;   ///< 文本（字符串已去除引号和转义）
+    size_t position;    ///< 在表达式中的位置
+};
+
+bool isIdentifierChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.';
+}
+
+std::string toUpper(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    return text;
+}
+
+} // namespace
+
+/**
+ * @brief 表达式编译器
+ * @details 递归下降解析，直接生成字节码并回填短路跳转的目标
+ * @since 1.1.0
+ */
+class LogFilter::Compiler {
+private:
+    const std::string& source_;     ///< 表达式文本
+    std::vector<Token> tokens_;     ///< 词法单元
+    size_t current_;                ///< 当前词法单元
+    LogFilter& filter_;             ///< 输出
+    std::string error_;             ///< 第一个错误
+
+public:
+    Compiler(const std::string& source, LogFilter& filter)
+        : source_(source), current_(0), filter_(filter) {}
+
+    bool run() {
+        if (!tokenize()) {
+            return false;
+        }
+
+        if (peek().type == TokenType::END) {
+            return true; // 空白表达式全部通过
+        }
+
+        if (!parseOr()) {
+            return false;
+        }
+
+        if (peek().type != TokenType::END) {
+            return fail("多余的内容 '" + peek().text + "'", peek().position);
+        }
+
+        return checkStackDepth();
+    }
+
+    const std::string& getError() const {
+        return error_;
+    }
+
+private:
+    bool fail(const std::string& message, size_t position) {
+        if (error_.empty()) {
+            error_ = "过滤表达式第 " + std::to_string(position + 1) + " 个字符处: " + message;
+        }
+        return false;
+    }
+
+    bool tokenize() {
+        size_t i = 0;
+        while (i < source_.size()) {
+            char c = source_[i];
+
+            if (std::isspace(static_cast<unsigned char>(c))) {
+                i++;
+            } else if (c == '(' || c == ')') {
+                tokens_.push_back({c == '(' ? TokenType::LEFT_PAREN : TokenType::RIGHT_PAREN,
+                                   std::string(1, c), i});
+                i++;
+            } else if (c == '"' || c == '\'') {
+                size_t start = i++;
+                std::string text;
+                while (i < source_.size() && source_[i] != c) {
+                    if (source_[i] == '\\' && i + 1 < source_.size()) {
+                        i++;
+                    }
+                    text += source_[i++];
+                }
+                if (i >= source_.size()) {
+                    return fail("字符串缺少结束引号", start);
+                }
+                i++;
+                tokens_.push_back({TokenType::STRING, std::move(text), start});
+            } else if (std::isdigit(static_cast<unsigned char>(c)) ||
+                       (c == '-' && i + 1 < source_.size() &&
+                        std::isdigit(static_cast<unsigned char>(source_[i + 1])))) {
+                size_t start = i++;
+                while (i < source_.size() && std::isdigit(static_cast<unsigned char>(source_[i]))) {
+                    i++;
+                }
+                tokens_.push_back({TokenType::NUMBER, source_.substr(start, i - start), start});
+            } else if (isIdentifierChar(c)) {
+                size_t start = i;
+                while (i < source_.size() && isIdentifierChar(source_[i])) {
+                    i++;
+                }
+                tokens_.push_back({TokenType::IDENTIFIER, source_.substr(start, i - start), start});
+            } else {
+                static const std::array<std::string_view, 11> operators = {
+                    "&&", "||", "==", "!=", "<=", ">=", "!~", "<", ">", "~", "!"
+                };
+                auto it = std::find_if(operators.begin(), operators.end(), [&](std::string_view op) {
+                    return source_.compare(i, op.size(), op) == 0;
+                });
+                if (it == operators.end()) {
+                    return fail(std::string("无法识别的字符 '") + c + "'", i);
+                }
+                tokens_.push_back({TokenType::OPERATOR, std::string(*it), i});
+                i += it->size();
+            }
+        }
+
+        tokens_.push_back({TokenType::END, "", source_.size()});
+        return true;
+    }
+
+    const Token& peek() const {
+        return tokens_[current_];
+    }
+
+    const Token& advance() {
+        const Token& token = tokens_[current_];
+        if (token.type != TokenType::END) {
+            current_++;
+        }
+        return token;
+    }
+
+    bool matchOperator(std::string_view symbol, std::string_view keyword) {
+        const Token& token = peek();
+        if ((token.type == TokenType::OPERATOR && token.text == symbol) ||
+            (token.type == TokenType::IDENTIFIER && !keyword.empty() && token.text == keyword)) {
+            advance();
+            return true;
+        }
+        return false;
+    }
+
+    size_t emit(const Instruction& instruction) {
+        filter_.code_.push_back(instruction);
+        return filter_.code_.size() - 1;
+    }
+
+    size_t emitJump(Opcode op) {
+        return emit({op, Field::LEVEL, Compare::EQ, 0, 0, 0});
+    }
+
+    void patchJump(size_t index) {
+        filter_.code_[index].operand = static_cast<uint32_t>(filter_.code_.size());
+    }
+
+    bool parseOr() {
+        if (!parseAnd()) {
+            return false;
+        }
+
+        std::vector<size_t> jumps;
+        while (matchOperator("||", "or")) {
+            jumps.push_back(emitJump(Opcode::JUMP_IF_TRUE));
+            if (!parseAnd()) {
+                return false;
+            }
+        }
+
+        for (size_t jump : jumps) {
+            patchJump(jump);
+        }
+        return true;
+    }
+
+    bool parseAnd() {
+        if (!parseUnary()) {
+            return false;
+        }
+
+        std::vector<size_t> jumps;
+        while (matchOperator("&&", "and")) {
+            jumps.push_back(emitJump(Opcode::JUMP_IF_FALSE));
+            if (!parseUnary()) {
+                return false;
+            }
+        }
+
+        for (size_t jump : jumps) {
+            patchJump(jump);
+        }
+        return true;
+    }
+
+    bool parseUnary() {
+        if (matchOperator("!", "not")) {
+            if (!parseUnary()) {
+                return false;
+            }
+            emit({Opcode::NOT, Field::LEVEL, Compare::EQ, 0, 0, 0});
+            return true;
+        }
+
+        const Token& token = peek();
+
+        if (token.type == TokenType::LEFT_PAREN) {
+            advance();
+            if (!parseOr()) {
+                return false;
+            }
+            if (peek().type != TokenType::RIGHT_PAREN) {
+                return fail("缺少右括号", peek().position);
+            }
+            advance();
+            return true;
+        }
+
+        if (token.type == TokenType::IDENTIFIER && (token.text == "true" || token.text == "false")) {
+            emit({Opcode::PUSH_CONST, Field::LEVEL, Compare::EQ, 0, 0, token.text == "true" ? 1 : 0});
+            advance();
+            return true;
+        }
+
+        return parseComparison();
+    }
+
+    bool parseComparison() {
+        const Token& fieldToken = advance();
+        if (fieldToken.type != TokenType::IDENTIFIER) {
+            return fail("此处需要字段名", fieldToken.position);
+        }
+
+        Instruction instruction{Opcode::TEXT_CMP, Field::MESSAGE, Compare::EQ, 0, 0, 0};
+        const std::string& name = fieldToken.text;
+
+        if (name == "level") {
+            instruction.op = Opcode::NUMBER_CMP;
+            instruction.field = Field::LEVEL;
+        } else if (name == "line") {
+            instruction.op = Opcode::NUMBER_CMP;
+            instruction.field = Field::LINE;
+        } else if (name == "thread") {
+            instruction.op = Opcode::NUMBER_CMP;
+            instruction.field = Field::THREAD;
+        } else if (name == "file") {
+            instruction.field = Field::FILE;
+        } else if (name == "function" || name == "func") {
+            instruction.field = Field::FUNCTION;
+        } else if (name == "message" || name == "msg") {
+            instruction.field = Field::MESSAGE;
+        } else if (name.compare(0, 4, "ctx.") == 0 && name.size() > 4) {
+            instruction.field = Field::CONTEXT;
+            // 键名是有限集合，编译时驻留，求值时按ID比较
+            instruction.contextKey = StringTable::getInstance().intern(std::string_view(name).substr(4));
+        } else {
+            return fail("未知字段 '" + name + "'", fieldToken.position);
+        }
+
+        const Token& opToken = advance();
+        if (!parseCompare(opToken, instruction)) {
+            return false;
+        }
+
+        const Token& valueToken = advance();
+        if (valueToken.type == TokenType::END || valueToken.type == TokenType::OPERATOR ||
+            valueToken.type == TokenType::LEFT_PAREN || valueToken.type == TokenType::RIGHT_PAREN) {
+            return fail("此处需要比较值", valueToken.position);
+        }
+
+        if (instruction.op == Opcode::NUMBER_CMP) {
+            if (!parseNumberValue(valueToken, instruction)) {
+                return false;
+            }
+        } else {
+            std::string operand = valueToken.text;
+            bool negate = false;
+            if (instruction.compare == Compare::GLOB || instruction.compare == Compare::NOT_GLOB) {
+                negate = simplifyGlob(instruction, operand);
+            }
+            filter_.strings_.push_back(std::move(operand));
+            instruction.operand = static_cast<uint32_t>(filter_.strings_.size() - 1);
+            emit(instruction);
+            if (negate) {
+                emit({Opcode::NOT, Field::LEVEL, Compare::EQ, 0, 0, 0});
+            }
+            return true;
+        }
+
+        emit(instruction);
+        return true;
+    }
+
+    bool simplifyGlob(Instruction& instruction, std::string& pattern) {
+        // 常见的通配符形式改写为前缀、后缀、子串或相等比较，求值时不需要回溯
+        if (pattern.find('?') != std::string::npos) {
+            return false;
+        }
+
+        bool leading = !pattern.empty() && pattern.front() == '*';
+        bool trailing = pattern.size() > 1 && pattern.back() == '*';
+        std::string core = pattern.substr(leading ? 1 : 0,
+                                          pattern.size() - (leading ? 1 : 0) - (trailing ? 1 : 0));
+        if (core.find('*') != std::string::npos) {
+            return false;
+        }
+
+        bool negate = instruction.compare == Compare::NOT_GLOB;
+        if (leading && trailing) {
+            instruction.compare = Compare::CONTAINS;
+        } else if (leading) {
+            instruction.compare = Compare::SUFFIX;
+        } else if (trailing) {
+            instruction.compare = Compare::PREFIX;
+        } else {
+            instruction.compare = Compare::EQ;
+        }
+        pattern = std::move(core);
+        return negate;
+    }
+
+    bool parseCompare(const Token& token, Instruction& instruction) {
+        bool numeric = instruction.op == Opcode::NUMBER_CMP;
+
+        if (token.type == TokenType::IDENTIFIER && token.text == "contains" && !numeric) {
+            instruction.compare = Compare::CONTAINS;
+            return true;
+        }
+
+        if (token.type == TokenType::OPERATOR) {
+            const std::string& op = token.text;
+            if (op == "==") { instruction.compare = Compare::EQ; return true; }
+            if (op == "!=") { instruction.compare = Compare::NE; return true; }
+            if (numeric) {
+                if (op == "<")  { instruction.compare = Compare::LT; return true; }
+                if (op == "<=") { instruction.compare = Compare::LE; return true; }
+                if (op == ">")  { instruction.compare = Compare::GT; return true; }
+                if (op == ">=") { instruction.compare = Compare::GE; return true; }
+            } else {
+                if (op == "~")  { instruction.compare = Compare::GLOB; return true; }
+                if (op == "!~") { instruction.compare = Compare::NOT_GLOB; return true; }
+            }
+        }
+
+        return fail("字段不支持运算符 '" + token.text + "'", token.position);
+    }
+
+    bool parseNumberValue(const Token& token, Instruction& instruction) {
+        if (instruction.field == Field::LEVEL && token.type != TokenType::NUMBER) {
+            static const std::array<const char*, 5> levels = {"DEBUG", "INFO", "WARN", "ERROR", "FATAL"};
+            std::string upper = toUpper(token.text);
+            for (size_t i = 0; i < levels.size(); ++i) {
+                if (upper == levels[i]) {
+                    instruction.number = static_cast<int64_t>(i);
+                    return true;
+                }
+            }
+            return fail("未知日志级别 '" + token.text + "'", token.position);
+        }
+
+        if (token.type != TokenType::NUMBER) {
+            return fail("此处需要数字", token.position);
+        }
+
+        // 线程哈希值可能超出int64范围，按无符号解析后保留位模式
+        try {
+            instruction.number = token.text[0] == '-'
+                ? static_cast<int64_t>(std::stoll(token.text))
+                : static_cast<int64_t>(std::stoull(token.text));
+        } catch (const std::exception&) {
+            return fail("数字超出范围", token.position);
+        }
+        return true;
+    }
+
+    bool checkStackDepth() {
+        // 压栈指令使深度加一，跳转指令在顺序执行路径上弹出一个值
+        size_t depth = 0;
+        for (const auto& instruction : filter_.code_) {
+            switch (instruction.op) {
+                case Opcode::PUSH_CONST:
+                case Opcode::NUMBER_CMP:
+                case Opcode::TEXT_CMP:
+                    if (++depth > MAX_STACK_DEPTH) {
+                        return fail("表达式嵌套过深", 0);
+                    }
+                    break;
+                case Opcode::JUMP_IF_FALSE:
+                case Opcode::JUMP_IF_TRUE:
+                    depth--;
+                    break;
+                case Opcode::NOT:
+                    break;
+            }
+        }
+        return true;
+    }
+};
+
+// LogFilter 实现
+std::shared_ptr<const LogFilter> LogFilter::compile(const std::string& expression, std::string* error) {
+    std::shared_ptr<LogFilter> filter(new LogFilter());
+    filter->expression_ = expression;
+
+    Compiler compiler(expression, *filter);
+    if (!compiler.run()) {
+        if (error) {
+            *error = compiler.getError();
+        }
+        return nullptr;
+    }
+
+    return filter;
+}
+
+bool LogFilter::evaluate(const LogMessage& msg) const {
+    std::array<bool, MAX_STACK_DEPTH> stack;
+    size_t top = 0;
+    size_t pc = 0;
+    const size_t count = code_.size();
+
+    while (pc < count) {
+        const Instruction& instruction = code_[pc];
+
+        switch (instruction.op) {
+            case Opcode::PUSH_CONST:
+                stack[top++] = instruction.number != 0;
+                break;
+            case Opcode::NUMBER_CMP:
+                stack[top++] = evaluateNumber(msg, instruction);
+                break;
+            case Opcode::TEXT_CMP:
+                stack[top++] = evaluateText(msg, instruction);
+                break;
+            case Opcode::NOT:
+                stack[top - 1] = !stack[top - 1];
+                break;
+            case Opcode::JUMP_IF_FALSE:
+                if (!stack[top - 1]) {
+                    pc = instruction.operand;
+                    continue;
+                }
+                top--;
+                break;
+            case Opcode::JUMP_IF_TRUE:
+                if (stack[top - 1]) {
+                    pc = instruction.operand;
+                    continue;
+                }
+                top--;
+                break;
+        }
+        pc++;
+    }
+
+    return top == 0 ? true : stack[top - 1];
+}
+
+const std::string& LogFilter::getExpression() const {
+    return expression_;
+}
+
+const std::vector<LogFilter::Instruction>& LogFilter::getCode() const {
+    return code_;
+}
+
+bool LogFilter::evaluateNumber(const LogMessage& msg, const Instruction& instruction) {
+    int64_t value = 0;
+    switch (instruction.field) {
+        case Field::LEVEL:
+            value = static_cast<int64_t>(msg.level);
+            break;
+        case Field::LINE:
+            value = msg.line;
+            break;
+        case Field::THREAD:
+            value = static_cast<int64_t>(std::hash<std::thread::id>{}(msg.threadId));
+            break;
+        default:
+            break;
+    }
+
+    switch (instruction.compare) {
+        case Compare::EQ: return value == instruction.number;
+        case Compare::NE: return value != instruction.number;
+        case Compare::LT: return value < instruction.number;
+        case Compare::LE: return value <= instruction.number;
+        case Compare::GT: return value > instruction.number;
+        case Compare::GE: return value >= instruction.number;
+        default:          return false;
+    }
+}
+
+bool LogFilter::evaluateText(const LogMessage& msg, const Instruction& instruction) const {
+    static const std::string empty;
+    const std::string* text = &empty;
+
+    switch (instruction.field) {
+        case Field::FILE:
+            text = &msg.getFile();
+            break;
+        case Field::FUNCTION:
+            text = &msg.getFunction();
+            break;
+        case Field::MESSAGE:
+            text = &msg.getMessage();
+            break;
+        case Field::CONTEXT: {
+            const std::string* value = LogContext::find(msg.context, instruction.contextKey);
+            if (value) {
+                text = value;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    const std::string& operand = strings_[instruction.operand];
+    switch (instruction.compare) {
+        case Compare::EQ:       return *text == operand;
+        case Compare::NE:       return *text != operand;
+        case Compare::GLOB:     return globMatch(*text, operand);
+        case Compare::NOT_GLOB: return !globMatch(*text, operand);
+        case Compare::CONTAINS: return text->find(operand) != std::string::npos;
+        case Compare::PREFIX:   return text->compare(0, operand.size(), operand) == 0;
+        case Compare::SUFFIX:
+            return text->size() >= operand.size() &&
+                   text->compare(text->size() - operand.size(), operand.size(), operand) == 0;
+        default:                return false;
+    }
+}
+
+bool LogFilter::globMatch(const std::string& text, const std::string& pattern) {
+    // 线性回溯：只记录最近一个*的位置
+    size_t t = 0;
+    size_t p = 0;
+    size_t starPattern = std::string::npos;
+    size_t starText = 0;
+
+    while (t < text.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t])) {
+            t++;
+            p++;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            starPattern = p++;
+            starText = t;
+        } else if (starPattern != std::string::npos) {
+            p = starPattern + 1;
+            t = ++starText;
+        } else {
+            return false;
+        }
+    }
+
+    while (p < pattern.size() && pattern[p] == '*') {
+        p++;
+    }
+    return p == pattern.size();
+}
+
+} // namespace async_log
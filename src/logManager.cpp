@@ -16,18 +16,135 @@
 #include <chrono>
 #include <thread>
 #include <algorithm>
+#include <new>
+#include <utility>
+
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <pthread.h>
+#include <unistd.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#endif
 
 namespace async_log {
 
 // 静态成员初始化
 std::unique_ptr<LogManager> LogManager::instance_;
 std::mutex LogManager::instanceMutex_;
+std::atomic<LogManager*> LogManager::instancePtr_{nullptr};
+std::atomic<uint64_t> LogManager::nextInstanceId_{1};
+
+namespace {
+
+/**
+ * @brief 存活的日志管理器实例表
+ * @since 1.1.0
+ */
+struct InstanceRegistry {
+    std::mutex mutex;                       ///< 保护instances与liveIds
+    std::vector<LogManager*> instances;     ///< 按构造顺序排列的存活实例
+    std::vector<uint64_t> liveIds;          ///< 存活实例的编号
+    std::atomic<uint64_t> destroyed{0};     ///< 已析构的实例数量，线程局部表据此决定是否清理
+};
+
+InstanceRegistry& instanceRegistry() {
+    // 有意泄漏：全局或静态的实例可能在本文件的静态对象之后析构
+    static InstanceRegistry* registry = new InstanceRegistry();
+    return *registry;
+}
+
+/**
+ * @brief 清理线程局部表中已析构实例的条目
+ * @details 只在有实例析构后才加锁检查，平时只有一次原子读取
+ * @param entries 以实例编号为键的线程局部表
+ * @param seenDestroyed 该表上次清理时看到的析构数量
+ * @since 1.1.0
+ */
+template<typename Entries>
+void pruneDeadInstances(Entries& entries, uint64_t& seenDestroyed) {
+    InstanceRegistry& registry = instanceRegistry();
+    uint64_t destroyed = registry.destroyed.load(std::memory_order_acquire);
+    if (destroyed == seenDestroyed) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    seenDestroyed = registry.destroyed.load(std::memory_order_relaxed);
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [&registry](const auto& entry) {
+        return std::find(registry.liveIds.begin(), registry.liveIds.end(), entry.first) == registry.liveIds.end();
+    }), entries.end());
+}
+
+/// 同步写出等待尚未完成入队的生产者的最长时间
+constexpr std::chrono::milliseconds SYNC_WRITE_WAIT(100);
+
+/// 工作线程代为输出限流汇总的最短间隔
+constexpr std::chrono::milliseconds SUPPRESSED_REPORT_INTERVAL(1000);
+
+/// 限流汇总行的文本
+std::string suppressedSummary(uint64_t suppressedCount) {
+    return "[限流] 此调用点已抑制 " + std::to_string(suppressedCount) + " 条日志";
+}
+
+} // namespace
+
+/**
+ * @brief 消费者守卫
+ * @details 持有drainMutex_期间登记当前线程，同步写出据此识别输出内部的重入
+ * @since 1.1.0
+ */
+class LogManager::ConsumerLock {
+private:
+    LogManager& manager_;
+    
+public:
+    explicit ConsumerLock(LogManager& manager) : manager_(manager) {
+        manager_.drainMutex_.lock();
+        manager_.consumerThread_.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    }
+    
+    ~ConsumerLock() {
+        manager_.consumerThread_.store(std::thread::id(), std::memory_order_relaxed);
+        manager_.drainMutex_.unlock();
+    }
+    
+    ConsumerLock(const ConsumerLock&) = delete;
+    ConsumerLock& operator=(const ConsumerLock&) = delete;
+};
+
+/**
+ * @brief 当前线程在各实例中的暂存缓冲区
+ * @details 按实例编号区分；线程退出时把缓冲区标记为已退出，剩余的消息由对应实例的工作线程发布，
+ *          实例已经析构时缓冲区随此表一起释放
+ * @since 1.1.0
+ */
+struct LogManager::StagingHolder {
+    std::vector<std::pair<uint64_t, std::shared_ptr<StagingBuffer>>> buffers;
+    uint64_t seenDestroyed = 0;     ///< 上次清理时的实例析构数量
+    
+    ~StagingHolder() {
+        for (auto& entry : buffers) {
+            std::lock_guard<std::mutex> lock(entry.second->getMutex());
+            entry.second->retire();
+        }
+    }
+};
 
 LogManager& LogManager::getInstance() {
+    // 实例创建后每次日志调用只需一次原子读取
+    LogManager* instance = instancePtr_.load(std::memory_order_acquire);
+    if (instance) {
+        return *instance;
+    }
+    
     std::lock_guard<std::mutex> lock(instanceMutex_);
     
     if (!instance_) {
         instance_ = std::unique_ptr<LogManager>(new LogManager());
+        instancePtr_.store(instance_.get(), std::memory_order_release);
     }
     
     return *instance_;
@@ -37,29 +154,117 @@ void LogManager::destroyInstance() {
     std::lock_guard<std::mutex> lock(instanceMutex_);
     
     if (instance_) {
+        instancePtr_.store(nullptr, std::memory_order_release);
         instance_->stop();
         instance_.reset();
     }
 }
 
 LogManager::LogManager()
-    : running_(false), shouldStop_(false) {
+    : instanceId_(nextInstanceId_.fetch_add(1)), workerId_(std::thread::id()), running_(false), shouldStop_(false), workerSleeping_(false),
+      queueFootprint_(0), overflowPolicy_(OverflowPolicy::DROP_NEWEST), droppedCount_(0), blockedProducers_(0),
+      effectiveMinLevel_(LogLevel::DEBUG), degradeReset_(false), errorBacklogSize_(0), errorBacklogLevel_(LogLevel::INFO),
+      stagingBatchSize_(0), stagingMaxBytes_(0), stagingMaxDelayUs_(0),
+      syncWrite_(true), syncWriteLevel_(LogLevel::FATAL),
+      nextSequence_(0), completedSequence_(0), flushPending_(false),
+      manualDrain_(false), pollSignaled_(false), notifyReadFd_(-1), notifyWriteFd_(-1),
+      consumerThread_(std::thread::id()), forkPending_(false), workerParked_(false), forkTarget_(0) {
     
+    installForkHandlers();
     initializeDefaultConfig();
-    createDefaultOutputs();
     
     // 创建核心组件
-    messageQueue_ = std::make_unique<LockFreeQueue<LogMessage>>();
+    messageQueue_ = makeQueue<LogMessage>(QueueAlgorithm::LINKED, QueueWaitStrategy::NONE, 0);
     dispatcher_ = std::make_unique<LogDispatcher>();
+    dispatcher_->setMemoryBudget(&memoryBudget_);
+    createDefaultOutputs();
+    
+    InstanceRegistry& registry = instanceRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.instances.push_back(this);
+    registry.liveIds.push_back(instanceId_);
+}
+
+LogManager::LogManager(const LogConfig& config) : LogManager() {
+    setConfig(config);
 }
 
 LogManager::~LogManager() {
+    // 先退出登记，之后的fork不再处理正在析构的实例
+    {
+        InstanceRegistry& registry = instanceRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.instances.erase(std::remove(registry.instances.begin(), registry.instances.end(), this),
+                                 registry.instances.end());
+        registry.liveIds.erase(std::remove(registry.liveIds.begin(), registry.liveIds.end(), instanceId_),
+                               registry.liveIds.end());
+        registry.destroyed.fetch_add(1, std::memory_order_release);
+    }
+    
     stop();
+    closeNotifyFd();
+    
+    if (slotRing_) {
+        memoryBudget_.release(slotRing_->getFootprint());
+    }
+    memoryBudget_.release(queueFootprint_);
 }
 
 void LogManager::setConfig(const LogConfig& config) {
-    std::lock_guard<std::mutex> lock(configMutex_);
-    config_ = std::make_unique<LogConfig>(config);
+    std::string filterError;
+    std::string memoryError;
+    {
+        std::lock_guard<std::mutex> lock(configMutex_);
+        config_ = std::make_unique<LogConfig>(config);
+        
+        effectiveMinLevel_.store(config.minLevel); // 新配置同时清除已有的降级
+        degradeReset_ = true;
+        overflowPolicy_.store(config.overflowPolicy);
+        errorBacklogSize_.store(config.errorBacklogSize);
+        errorBacklogLevel_.store(config.errorBacklogLevel);
+        stagingBatchSize_.store(config.stagingBatchSize);
+        stagingMaxBytes_.store(config.stagingMaxBytes);
+        stagingMaxDelayUs_.store(config.stagingMaxDelayUs);
+        syncWrite_.store(config.syncWrite);
+        syncWriteLevel_.store(config.syncWriteLevel);
+        
+        if (dispatcher_) {
+            dispatcher_->setRepeatWindow(std::chrono::milliseconds(config.repeatWindowMs));
+            dispatcher_->setMemoryResource(config.memoryResource ? config.memoryResource
+                                                                 : std::pmr::get_default_resource());
+            dispatcher_->setFormatThreads(config.formatThreads);
+            
+            if (!dispatcher_->setFilterExpression(config.filterExpression, &filterError) && filterError.empty()) {
+                filterError = "过滤表达式编译失败";
+            }
+        }
+        
+        // 队列节点必须归还给分配它们的资源，只有队列为空且没有消费者时才能更换队列
+        if (!running_.load() && isQueueEmpty()) {
+            rebuildQueue(config, &memoryError);
+        }
+        
+        // 预分配的部分单独就超出上限时，任何消息都无法入队，保留原有上限
+        size_t preallocated = getPreallocatedBytes();
+        if (config.maxMemoryBytes > 0 && preallocated > config.maxMemoryBytes) {
+            memoryError += memoryError.empty() ? "" : "；";
+            memoryError += "内存上限" + std::to_string(config.maxMemoryBytes) + "字节低于队列预分配的" +
+                           std::to_string(preallocated) + "字节，继续使用原有内存上限";
+        } else {
+            memoryBudget_.setLimit(config.maxMemoryBytes);
+        }
+        
+        // 上限放宽后唤醒等待中的生产者
+        spaceCondition_.notify_all();
+    }
+    
+    // 释放configMutex_后再记录：记录可能阻塞等待空间或同步写出，而消费者会获取configMutex_
+    if (!filterError.empty()) {
+        log(LogLevel::ERROR, filterError + "，继续使用原有过滤规则");
+    }
+    if (!memoryError.empty()) {
+        log(LogLevel::ERROR, memoryError);
+    }
 }
 
 LogConfig LogManager::getConfig() const {
@@ -76,37 +281,20 @@ bool LogManager::loadConfigFromFile(const std::string& configFile) {
 void LogManager::addOutput(std::unique_ptr<ILogOutput> output) {
     std::lock_guard<std::mutex> lock(outputsMutex_);
     
-    if (output) {
-        outputs_.push_back(std::move(output));
-        
-        // 同时添加到分发器
-        if (dispatcher_) {
-            // 创建一个新的副本添加到分发器
-            auto outputCopy = std::make_unique<ConsoleOutput>(true); // 临时使用ConsoleOutput作为示例
-            dispatcher_->addOutput(std::move(outputCopy));
-        }
+    // 输出由分发器持有，下标与分发器中的顺序一致
+    if (output && dispatcher_) {
+        dispatcher_->addOutput(std::move(output));
     }
 }
 
 bool LogManager::removeOutput(size_t index) {
     std::lock_guard<std::mutex> lock(outputsMutex_);
     
-    if (index >= outputs_.size()) {
-        return false;
-    }
-    
-    // 从dispatcher中移除对应索引的输出
-    if (dispatcher_) {
-        dispatcher_->removeOutput(index);
-    }
-    
-    outputs_.erase(outputs_.begin() + index);
-    return true;
+    return dispatcher_ && dispatcher_->removeOutput(index);
 }
 
 void LogManager::clearOutputs() {
     std::lock_guard<std::mutex> lock(outputsMutex_);
-    outputs_.clear();
     
     if (dispatcher_) {
         dispatcher_->clearOutputs();
@@ -115,7 +303,7 @@ void LogManager::clearOutputs() {
 
 size_t LogManager::getOutputCount() const {
     std::lock_guard<std::mutex> lock(outputsMutex_);
-    return outputs_.size();
+    return dispatcher_ ? dispatcher_->getOutputCount() : 0;
 }
 
 void LogManager::log(LogLevel level, const std::string& message) {
@@ -123,8 +311,12 @@ void LogManager::log(LogLevel level, const std::string& message) {
         return;
     }
     
-    LogMessage msg(level, message);
-    messageQueue_->push(std::move(msg));
+    auto fill = [&](LogMessage& msg) {
+        msg.assign(level, message);
+    };
+    if (!deferToErrorBacklog(level, fill) && !writeThrough(level, fill)) {
+        enqueue(message.size(), fill);
+    }
 }
 
 void LogManager::log(LogLevel level, const std::string& message, 
@@ -133,8 +325,61 @@ void LogManager::log(LogLevel level, const std::string& message,
         return;
     }
     
-    LogMessage msg(level, message, file, line, function);
-    messageQueue_->push(std::move(msg));
+    auto fill = [&](LogMessage& msg) {
+        msg.assign(level, message, file, line, function);
+    };
+    if (!deferToErrorBacklog(level, fill) && !writeThrough(level, fill)) {
+        enqueue(message.size() + file.size() + function.size(), fill);
+    }
+}
+
+void LogManager::log(LogLevel level, const std::string& message, const LogCallSite& site) {
+    if (!shouldLog(level)) {
+        return;
+    }
+    
+    auto fill = [&](LogMessage& msg) {
+        msg.assign(level, message, "", site.line);
+        msg.fileId = site.fileId;
+        msg.functionId = site.functionId;
+    };
+    if (deferToErrorBacklog(level, fill)) {
+        return;
+    }
+    
+    if (writeThrough(level, fill) || enqueue(message.size(), fill)) {
+        CallSiteStats::getInstance().recordEmitted(site.statsIndex, message.size());
+    } else {
+        CallSiteStats::getInstance().recordDropped(site.statsIndex);
+    }
+}
+
+void LogManager::log(LogLevel level, StringId messageId, const LogCallSite& site) {
+    if (!shouldLog(level)) {
+        return;
+    }
+    
+    auto fill = [&](LogMessage& msg) {
+        msg.assign(level, "", "", site.line);
+        msg.messageId = messageId;
+        msg.fileId = site.fileId;
+        msg.functionId = site.functionId;
+    };
+    if (deferToErrorBacklog(level, fill)) {
+        return;
+    }
+    
+    if (writeThrough(level, fill) || enqueue(0, fill)) {
+        CallSiteStats::getInstance().recordEmitted(site.statsIndex,
+                                                   StringTable::getInstance().resolve(messageId).size());
+    } else {
+        CallSiteStats::getInstance().recordDropped(site.statsIndex);
+    }
+}
+
+void LogManager::logSuppressed(LogLevel level, uint64_t suppressedCount, const LogCallSite& site) {
+    CallSiteStats::getInstance().recordDropped(site.statsIndex, suppressedCount);
+    log(level, suppressedSummary(suppressedCount), site);
 }
 
 void LogManager::debug(const std::string& message) {
@@ -162,11 +407,36 @@ bool LogManager::start() {
         return true; // 已经在运行
     }
     
+    bool manual = false;
+    {
+        std::lock_guard<std::mutex> lock(configMutex_);
+        manual = config_ && config_->manualDrain;
+    }
+    
+    manualDrain_ = manual;
     shouldStop_ = false;
+    
+    // 计时起点默认是时钟纪元，不重置的话首次评估就会认为已经持续过载
+    auto now = std::chrono::steady_clock::now();
+    lastDegradeCheck_ = now;
+    pressureSince_ = now;
+    calmSince_ = now;
+    
+    if (manual) {
+        // 由宿主事件循环调用poll()消费队列，不创建工作线程
+        if (!pollBuffer_) {
+            pollBuffer_ = std::make_unique<std::pmr::vector<LogMessage>>(messageQueue_->getMemoryResource());
+        }
+        openNotifyFd();
+        running_ = true;
+        return true;
+    }
+    
     running_ = true;
     
     // 启动工作线程
     workerThread_ = std::thread(&LogManager::workerFunction, this);
+    workerId_.store(workerThread_.get_id());
     
     return true;
 }
@@ -176,6 +446,9 @@ void LogManager::stop() {
         return; // 已经停止
     }
     
+    // 暂存的日志先进入队列，由工作线程在退出前写完
+    publishAllStaged(false);
+    
     shouldStop_ = true;
     running_ = false;
     
@@ -186,20 +459,86 @@ void LogManager::stop() {
     if (workerThread_.joinable()) {
         workerThread_.join();
     }
+    workerId_.store(std::thread::id());
+    
+    // 手动驱动模式下没有工作线程，由调用者处理剩余消息
+    if (manualDrain_.load()) {
+        ConsumerLock consumer(*this);
+        while (drainBatch(*pollBuffer_, 100) > 0) {
+        }
+        serviceFlushRequests(true);
+        clearConsumerSignal();
+    }
     
     // 刷新所有输出
     flush();
 }
 
 void LogManager::flush() {
-    if (dispatcher_) {
-        dispatcher_->flush();
+    flushAsync().wait();
+}
+
+std::shared_future<void> LogManager::flushAsync(bool durable) {
+    // 输出内部调用flush()时当前线程已持有消费者锁，不能再消费队列或等待工作线程
+    bool consumer = consumerThread_.load(std::memory_order_relaxed) == std::this_thread::get_id();
+    
+    // 各线程暂存的日志同样属于调用前记录的日志；消费者自身不能等待可能正在发布的生产者
+    if (!consumer) {
+        publishAllStaged(false);
+    }
+    
+    // 手动驱动模式下由调用者处理完队列；poll()遇到尚未链入的消息会提前返回，直到取空为止
+    while (!consumer && running_.load() && manualDrain_.load()) {
+        if (poll() == 0) {
+            if (isQueueEmpty()) {
+                break;
+            }
+            std::this_thread::yield();
+        }
+    }
+    
+    // 没有工作线程时不会有人消费队列；在消费者线程中等待工作线程会死锁。两种情况都直接刷新
+    bool worker = workerId_.load() == std::this_thread::get_id();
+    if (!running_.load() || manualDrain_.load() || consumer || worker) {
+        // 正在停止时工作线程可能还在写剩余消息，等它退出后再刷新
+        if (!running_.load() && !consumer && !worker) {
+            awaitWorkerExit();
+        }
+        if (dispatcher_) {
+            durable ? dispatcher_->sync() : dispatcher_->flush();
+        }
+        std::promise<void> done;
+        done.set_value();
+        return done.get_future().share();
+    }
+    
+    std::shared_future<void> future;
+    {
+        std::lock_guard<std::mutex> lock(flushMutex_);
+        if (!pendingFlush_) {
+            pendingFlush_ = std::make_unique<FlushRequest>();
+            pendingFlush_->future = pendingFlush_->promise.get_future().share();
+        }
+        pendingFlush_->target = nextSequence_.load();
+        pendingFlush_->durable = pendingFlush_->durable || durable;
+        future = pendingFlush_->future;
+        flushPending_.store(true);
+    }
+    
+    // 持有configMutex_通知，保证工作线程不会在检查flushPending_之后、进入等待之前错过通知
+    {
+        std::lock_guard<std::mutex> lock(configMutex_);
     }
+    workerCondition_.notify_one();
     
-    // 等待队列中的消息处理完成
-    while (!messageQueue_->empty()) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    // 与stop()竞争时工作线程可能已经完成最后一次服务，等它写完剩余消息退出后由调用者自己完成请求
+    if (!running_.load()) {
+        awaitWorkerExit();
+        ConsumerLock consumerLock(*this);
+        serviceFlushRequests(true);
     }
+    
+    return future;
 }
 
 bool LogManager::isRunning() const {
@@ -207,36 +546,566 @@ bool LogManager::isRunning() const {
 }
 
 size_t LogManager::getQueueSize() const {
+    if (slotRing_) {
+        return slotRing_->getSize();
+    }
     return messageQueue_ ? messageQueue_->getSize() : 0;
 }
 
+size_t LogManager::getMemoryUsage() const {
+    return memoryBudget_.getUsage();
+}
+
+size_t LogManager::getMemoryLimit() const {
+    return memoryBudget_.getLimit();
+}
+
+uint64_t LogManager::getDroppedCount() const {
+    return droppedCount_.load(std::memory_order_relaxed);
+}
+
+MemoryBudget& LogManager::getMemoryBudget() {
+    return memoryBudget_;
+}
+
+LogLevel LogManager::getEffectiveMinLevel() const {
+    return effectiveMinLevel_.load(std::memory_order_relaxed);
+}
+
+bool LogManager::setFilterExpression(const std::string& expression, std::string* error) {
+    return dispatcher_ && dispatcher_->setFilterExpression(expression, error);
+}
+
+size_t LogManager::poll(size_t maxMessages, std::chrono::microseconds maxTime) {
+    if (!running_.load() || !manualDrain_.load()) {
+        return 0;
+    }
+    
+    ConsumerLock consumer(*this);
+    
+    auto start = std::chrono::steady_clock::now();
+    const size_t batchSize = 100;
+    
+    // 先清除通知再取消息，之后入队的消息会重新置位，不会丢失通知
+    clearConsumerSignal();
+    
+    size_t processed = 0;
+    while (processed < maxMessages) {
+        size_t count = drainBatch(*pollBuffer_, std::min(batchSize, maxMessages - processed));
+        processed += count;
+        
+        // 按微秒比较：默认的microseconds::max()换算成steady_clock的纳秒会溢出
+        if (count == 0 || std::chrono::duration_cast<std::chrono::microseconds>(
+                              std::chrono::steady_clock::now() - start) >= maxTime) {
+            break;
+        }
+    }
+    
+    if (processed > 0 && blockedProducers_.load() > 0) {
+        std::lock_guard<std::mutex> spaceLock(spaceMutex_);
+        spaceCondition_.notify_all();
+    }
+    
+    runHousekeeping();
+    
+    // 受限于数量或时间没有处理完时保持可读，宿主下一轮会再次调用
+    if (!isQueueEmpty()) {
+        signalConsumer();
+    }
+    
+    return processed;
+}
+
+int LogManager::getNotifyFd() const {
+    return manualDrain_.load() ? notifyReadFd_ : -1;
+}
+
+bool LogManager::isManualDrain() const {
+    return manualDrain_.load();
+}
+
+void LogManager::clearErrorBacklog() {
+    localErrorBacklog().clear();
+}
+
+size_t LogManager::getErrorBacklogSize() const {
+    return localErrorBacklog().size();
+}
+
+void LogManager::flushLocalStaging() {
+    if (StagingBuffer* buffer = localStagingBuffer(false)) {
+        std::lock_guard<std::mutex> lock(buffer->getMutex());
+        publishStaged(*buffer);
+    }
+}
+
 void LogManager::workerFunction() {
-    std::vector<LogMessage> messages;
+    // 批处理缓冲区与队列节点使用同一个内存资源
+    std::pmr::vector<LogMessage> messages(messageQueue_->getMemoryResource());
     const size_t batchSize = 100; // 批量处理大小
     
     while (!shouldStop_.load()) {
-        // 批量取出消息
-        size_t count = messageQueue_->popBatch(messages, batchSize);
+        if (forkPending_.load()) {
+            parkForFork(messages);
+            continue;
+        }
+        
+        // 批量取出并处理消息；同步写出的调用线程也会消费队列，两者按批互斥
+        size_t count = 0;
+        {
+            ConsumerLock consumer(*this);
+            count = drainBatch(messages, batchSize);
+            runHousekeeping();
+        }
         
         if (count > 0) {
-            // 处理消息
-            for (const auto& msg : messages) {
-                processMessage(msg);
+            // 宣告等待后又取到了消息，撤回宣告，生产者不必再唤醒
+            if (workerSleeping_.load(std::memory_order_relaxed)) {
+                workerSleeping_.store(false, std::memory_order_relaxed);
             }
-            messages.clear();
+            
+            // 只有存在阻塞的生产者时才需要通知
+            if (blockedProducers_.load() > 0) {
+                std::lock_guard<std::mutex> spaceLock(spaceMutex_);
+                spaceCondition_.notify_all();
+            }
+        } else if (!workerSleeping_.load(std::memory_order_relaxed)) {
+            // 先宣告即将等待，再回头取一次消息：宣告之前入队的消息由这次取出，
+            // 之后入队的生产者会在signalConsumer()中看到宣告并唤醒工作线程
+            workerSleeping_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
         } else {
-            // 没有消息时等待
+            // 宣告后仍没有消息时等待；超时只用于周期性任务
+            // 启用暂存时至少按最长暂存时长醒来，代为发布空闲线程的暂存
+            std::chrono::microseconds idleWait = std::chrono::milliseconds(100);
+            if (stagingBatchSize_.load(std::memory_order_relaxed) > 0) {
+                idleWait = std::min(idleWait, std::chrono::microseconds(
+                                                  std::max<size_t>(stagingMaxDelayUs_.load(), 100)));
+            }
+            
             std::unique_lock<std::mutex> lock(configMutex_);
-            workerCondition_.wait_for(lock, std::chrono::milliseconds(100));
+            if (workerSleeping_.load(std::memory_order_relaxed) && !flushPending_.load() && !forkPending_.load()) {
+                workerCondition_.wait_for(lock, idleWait);
+            }
+            workerSleeping_.store(false, std::memory_order_relaxed);
         }
     }
     
     // 处理剩余消息
-    while (messageQueue_->popBatch(messages, batchSize) > 0) {
-        for (const auto& msg : messages) {
+    {
+        ConsumerLock consumer(*this);
+        while (drainBatch(messages, batchSize) > 0) {
+        }
+        serviceFlushRequests(true);
+    }
+    
+    // 唤醒所有仍在等待的生产者，它们会发现系统已停止并丢弃消息
+    std::lock_guard<std::mutex> spaceLock(spaceMutex_);
+    spaceCondition_.notify_all();
+}
+
+size_t LogManager::drainBatch(std::pmr::vector<LogMessage>& messages, size_t maxCount) {
+    if (slotRing_) {
+        // 槽位复用模式下就地处理，不移动也不销毁槽位中的消息
+        size_t count = slotRing_->consume([this](const LogMessage& msg) {
             processMessage(msg);
+            releaseBudget(msg);
+            completeSequence(msg.sequence);
+        }, maxCount);
+        
+        // 启用并行格式化时，处理完的消息作为一个批次交给格式化线程
+        if (count > 0) {
+            dispatcher_->submitBatch();
+        }
+        return count;
+    }
+    
+    size_t count = messageQueue_->popBatch(messages, maxCount);
+    for (const auto& msg : messages) {
+        processMessage(msg);
+        releaseBudget(msg);
+        completeSequence(msg.sequence);
+    }
+    messages.clear();
+    
+    if (count > 0) {
+        updateQueueFootprint();
+        dispatcher_->submitBatch();
+    }
+    return count;
+}
+
+void LogManager::completeSequence(uint64_t sequence) {
+    // 多个生产者的入队顺序可能与取得序号的顺序不同，先到的较大序号暂存在最小堆中
+    if (sequence != completedSequence_) {
+        earlySequences_.push(sequence);
+        return;
+    }
+    
+    completedSequence_++;
+    while (!earlySequences_.empty() && earlySequences_.top() == completedSequence_) {
+        earlySequences_.pop();
+        completedSequence_++;
+    }
+}
+
+void LogManager::awaitWorkerExit() const {
+    while (workerId_.load() != std::thread::id()) {
+        std::this_thread::yield();
+    }
+}
+
+void LogManager::serviceFlushRequests(bool force) {
+    if (!flushPending_.load()) {
+        return;
+    }
+    
+    std::unique_ptr<FlushRequest> request;
+    {
+        std::lock_guard<std::mutex> lock(flushMutex_);
+        if (!pendingFlush_ || (!force && completedSequence_ < pendingFlush_->target)) {
+            return;
+        }
+        request = std::move(pendingFlush_);
+        flushPending_.store(false);
+    }
+    
+    if (dispatcher_) {
+        request->durable ? dispatcher_->sync() : dispatcher_->flush();
+    }
+    request->promise.set_value();
+}
+
+void LogManager::runHousekeeping() {
+    publishAllStaged(true);
+    serviceFlushRequests(false);
+    
+    // 输出窗口已结束的重复汇总行
+    dispatcher_->expireRepeats();
+    
+    updateLevelDegradation();
+    
+    reportCallSites();
+    reportSuppressed();
+    dispatcher_->submitBatch();
+}
+
+void LogManager::signalConsumer() {
+    // 与clearConsumerSignal()及工作线程宣告等待后的屏障配对：
+    // 要么消费者看到刚入队的消息，要么这里看到通知已被清除或工作线程即将等待
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    
+    if (!manualDrain_.load(std::memory_order_relaxed)) {
+        // 只有第一个看到宣告的生产者负责唤醒；持有configMutex_通知，工作线程不会在检查宣告之后、进入等待之前错过
+        if (workerSleeping_.load(std::memory_order_relaxed) && workerSleeping_.exchange(false)) {
+            {
+                std::lock_guard<std::mutex> lock(configMutex_);
+            }
+            workerCondition_.notify_one();
+        }
+        return;
+    }
+    
+    if (pollSignaled_.load(std::memory_order_relaxed) || pollSignaled_.exchange(true) || notifyWriteFd_ < 0) {
+        return;
+    }
+    
+#if defined(__linux__)
+    uint64_t one = 1;
+    (void)::write(notifyWriteFd_, &one, sizeof(one));
+#elif defined(__unix__) || defined(__APPLE__)
+    char byte = 1;
+    (void)::write(notifyWriteFd_, &byte, 1);
+#endif
+}
+
+void LogManager::clearConsumerSignal() {
+    bool signaled = pollSignaled_.exchange(false);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!signaled || notifyReadFd_ < 0) {
+        return;
+    }
+    
+#if defined(__linux__)
+    uint64_t value;
+    (void)::read(notifyReadFd_, &value, sizeof(value));
+#elif defined(__unix__) || defined(__APPLE__)
+    char buffer[64];
+    while (::read(notifyReadFd_, buffer, sizeof(buffer)) > 0) {
+    }
+#endif
+}
+
+bool LogManager::openNotifyFd() {
+    if (notifyReadFd_ >= 0) {
+        return true;
+    }
+    
+#if defined(__linux__)
+    int fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    notifyReadFd_ = fd;
+    notifyWriteFd_ = fd;
+#elif defined(__unix__) || defined(__APPLE__)
+    int fds[2];
+    if (::pipe(fds) != 0) {
+        return false;
+    }
+    for (int fd : fds) {
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    notifyReadFd_ = fds[0];
+    notifyWriteFd_ = fds[1];
+#else
+    return false;
+#endif
+    
+    // 启动前已入队的消息同样需要通知
+    pollSignaled_ = false;
+    if (!isQueueEmpty()) {
+        signalConsumer();
+    }
+    return true;
+}
+
+void LogManager::closeNotifyFd() {
+#if defined(__unix__) || defined(__APPLE__)
+    if (notifyWriteFd_ >= 0 && notifyWriteFd_ != notifyReadFd_) {
+        ::close(notifyWriteFd_);
+    }
+    if (notifyReadFd_ >= 0) {
+        ::close(notifyReadFd_);
+    }
+#endif
+    notifyReadFd_ = -1;
+    notifyWriteFd_ = -1;
+}
+
+bool LogManager::canBlockProducers() const {
+    return overflowPolicy_.load() == OverflowPolicy::BLOCK && !manualDrain_.load() &&
+           consumerThread_.load(std::memory_order_relaxed) != std::this_thread::get_id();
+}
+
+void LogManager::installForkHandlers() {
+#if defined(__unix__) || defined(__APPLE__)
+    static std::once_flag once;
+    std::call_once(once, [] {
+        ::pthread_atfork(&LogManager::onForkPrepare, &LogManager::onForkParent, &LogManager::onForkChild);
+    });
+#endif
+}
+
+void LogManager::onForkPrepare() {
+    InstanceRegistry& registry = instanceRegistry();
+    instanceMutex_.lock();
+    registry.mutex.lock();
+    
+    for (LogManager* instance : registry.instances) {
+        instance->prepareFork();
+    }
+    
+    // 生产者线程可能正在驻留字符串或登记调用点
+    StringTable::getInstance().lockForFork();
+    CallSiteStats::getInstance().lockForFork();
+    SuppressionRegistry::getInstance().lockForFork();
+}
+
+void LogManager::onForkParent() {
+    SuppressionRegistry::getInstance().unlockAfterFork();
+    CallSiteStats::getInstance().unlockAfterFork();
+    StringTable::getInstance().unlockAfterFork();
+    
+    InstanceRegistry& registry = instanceRegistry();
+    for (LogManager* instance : registry.instances) {
+        instance->resumeAfterFork();
+    }
+    
+    registry.mutex.unlock();
+    instanceMutex_.unlock();
+}
+
+void LogManager::onForkChild() {
+    SuppressionRegistry::getInstance().unlockAfterFork();
+    CallSiteStats::getInstance().unlockAfterFork();
+    StringTable::getInstance().unlockAfterFork();
+    
+    InstanceRegistry& registry = instanceRegistry();
+    for (LogManager* instance : registry.instances) {
+        instance->reinitializeAfterFork();
+    }
+    
+    registry.mutex.unlock();
+    instanceMutex_.unlock();
+}
+
+void LogManager::prepareFork() {
+    // 暂存缓冲区的拥有者可能正在发布，此时工作线程仍在运行，发布能够完成
+    stagingMutex_.lock();
+    for (auto& buffer : stagingBuffers_) {
+        buffer->getMutex().lock();
+    }
+    
+    // 先写完fork前入队的消息并清空输出缓冲区，子进程不会重复写出父进程的日志
+    if (running_.load() && !manualDrain_.load()) {
+        forkTarget_.store(nextSequence_.load());
+        forkPending_.store(true);
+        
+        // 工作线程退出时同样不会再写出，不必等待
+        while (!workerParked_.load() && running_.load()) {
+            {
+                std::lock_guard<std::mutex> lock(configMutex_);
+            }
+            workerCondition_.notify_one();
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+    
+    // 加锁顺序与poll()、setConfig()、addOutput()一致
+    drainMutex_.lock();
+    if (running_.load() && manualDrain_.load()) {
+        uint64_t target = nextSequence_.load();
+        while (completedSequence_ < target) {
+            if (drainBatch(*pollBuffer_, 100) == 0) {
+                std::this_thread::yield();
+            }
+        }
+        serviceFlushRequests(false);
+        dispatcher_->flush();
+    }
+    
+    configMutex_.lock();
+    flushMutex_.lock();
+    spaceMutex_.lock();
+    outputsMutex_.lock();
+    dispatcher_->lockForFork();
+}
+
+void LogManager::resumeAfterFork() {
+    dispatcher_->unlockAfterFork();
+    unlockAfterFork();
+    forkPending_.store(false);
+    
+    // 等工作线程离开暂停状态，紧接着的下一次fork才不会把上一轮的暂停当成本轮的
+    while (workerParked_.load()) {
+        std::this_thread::yield();
+    }
+}
+
+void LogManager::reinitializeAfterFork() {
+    // 文件、连接与父进程共享，换成子进程自己的；格式化线程同样需要重新创建
+    dispatcher_->reinitializeAfterFork();
+    
+    // 暂存的日志由父进程发布
+    for (auto& buffer : stagingBuffers_) {
+        buffer->clear();
+    }
+    unlockAfterFork();
+    forkPending_.store(false);
+    workerParked_.store(false);
+    
+    // 父进程的其他线程在子进程中不存在：工作线程既不能join也不能detach，直接丢弃句柄；
+    // 条件变量可能残留已不存在的等待者，析构时会一直等待它们，因此同样就地重建
+    new (&workerThread_) std::thread();
+    workerId_.store(std::thread::id());
+    new (&workerCondition_) std::condition_variable();
+    new (&spaceCondition_) std::condition_variable();
+    workerSleeping_.store(false);
+    blockedProducers_.store(0);
+    
+    // 队列中剩下的是父进程其他线程在工作线程暂停后写入的消息，由父进程写出
+    discardQueued();
+    pendingFlush_.reset();
+    flushPending_.store(false);
+    nextSequence_.store(0);
+    completedSequence_ = 0;
+    earlySequences_ = decltype(earlySequences_)();
+    
+    if (!running_.load()) {
+        return;
+    }
+    
+    if (manualDrain_.load()) {
+        // eventfd同样与父进程共享，宿主需要重新获取getNotifyFd()
+        closeNotifyFd();
+        openNotifyFd();
+        return;
+    }
+    
+    running_ = false;
+    start();
+}
+
+void LogManager::unlockAfterFork() {
+    outputsMutex_.unlock();
+    spaceMutex_.unlock();
+    flushMutex_.unlock();
+    configMutex_.unlock();
+    drainMutex_.unlock();
+    
+    for (auto& buffer : stagingBuffers_) {
+        buffer->getMutex().unlock();
+    }
+    stagingMutex_.unlock();
+}
+
+void LogManager::parkForFork(std::pmr::vector<LogMessage>& messages) {
+    // 队列暂时取空不代表已经写完：被抢占的生产者可能已取得序号但尚未链入，
+    // 其后入队的消息（包括调用fork的线程自己的）要等它完成才能取出。取得序号的消息一定会入队
+    uint64_t target = forkTarget_.load();
+    {
+        ConsumerLock consumer(*this);
+        while (completedSequence_ < target) {
+            if (drainBatch(messages, 100) == 0) {
+                std::this_thread::yield();
+            }
         }
-        messages.clear();
+        serviceFlushRequests(false);
+    }
+    dispatcher_->flush();
+    
+    // fork很少发生，暂停期间轮询即可，不使用在子进程中需要重建的同步原语
+    workerParked_.store(true);
+    while (forkPending_.load()) {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    workerParked_.store(false);
+}
+
+void LogManager::discardQueued() {
+    if (slotRing_) {
+        slotRing_->consume([this](const LogMessage& msg) {
+            releaseBudget(msg);
+        }, SIZE_MAX);
+    } else {
+        std::pmr::vector<LogMessage> messages(messageQueue_->getMemoryResource());
+        while (messageQueue_->popBatch(messages, 100) > 0) {
+            for (const auto& msg : messages) {
+                releaseBudget(msg);
+            }
+        }
+    }
+    
+    if (isQueueEmpty()) {
+        return;
+    }
+    
+    // 空洞之后的消息无法取出，其预算也无法归还；fork恰好落在入队的几条指令之间时才会发生
+    if (slotRing_) {
+        // 空洞处的消息可能只赋值了一半，不能析构，整个槽位数组有意泄漏，新数组沿用已登记的预算
+        SlotRing<LogMessage>* abandoned = slotRing_.release();
+        slotRing_ = std::make_unique<SlotRing<LogMessage>>(abandoned->getCapacity(), abandoned->getMemoryResource());
+    } else if (messageQueue_->getAlgorithm() != QueueAlgorithm::LINKED) {
+        // 有界和分段队列同样不能析构空洞处的槽位，新队列沿用已登记的预算
+        AnyQueue<LogMessage>* abandoned = messageQueue_.release();
+        messageQueue_ = makeQueue<LogMessage>(abandoned->getAlgorithm(), abandoned->getWaitStrategy(),
+                                              abandoned->getCapacity() + abandoned->getSegmentSize(),
+                                              abandoned->getMemoryResource());
+    } else {
+        messageQueue_ = makeQueue<LogMessage>(QueueAlgorithm::LINKED, messageQueue_->getWaitStrategy(), 0,
+                                              messageQueue_->getMemoryResource());
     }
 }
 
@@ -261,27 +1130,526 @@ void LogManager::createDefaultOutputs() {
     // 添加颜色装饰器
     auto colorDecorator = std::make_unique<ColorDecorator>(std::move(timestampDecorator));
     
-    // 添加到输出列表
-    outputs_.push_back(std::move(colorDecorator));
+    // 添加到分发器
+    dispatcher_->addOutput(std::move(colorDecorator));
+}
+
+bool LogManager::acquireBudget(size_t bytes) {
+    if (memoryBudget_.tryAcquire(bytes)) {
+        return true;
+    }
+    
+    // 超过整个预算的消息永远无法入队
+    if (canBlockProducers() && memoryBudget_.canEverFit(bytes) &&
+        waitForSpace([&] { return memoryBudget_.tryAcquire(bytes); })) {
+        return true;
+    }
+    
+    droppedCount_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+template<typename TryAcquire>
+bool LogManager::waitForSpace(TryAcquire&& tryAcquire) {
+    blockedProducers_.fetch_add(1);
+    
+    std::unique_lock<std::mutex> lock(spaceMutex_);
+    bool acquired = false;
+    
+    // 没有工作线程时不会有空间被释放，此时放弃等待
+    while (running_.load() && !(acquired = tryAcquire())) {
+        // 工作线程可能正在空闲等待，主动唤醒它尽快消费队列
+        workerCondition_.notify_one();
+        spaceCondition_.wait_for(lock, std::chrono::milliseconds(10));
+    }
+    
+    blockedProducers_.fetch_sub(1);
+    return acquired;
+}
+
+template<typename Fill>
+bool LogManager::enqueue(size_t payloadBytes, Fill&& fill) {
+    return stage(payloadBytes, fill) || publish(payloadBytes, fill);
+}
+
+template<typename Fill>
+bool LogManager::publish(size_t payloadBytes, Fill&& fill) {
+    size_t footprint = messageFootprint(payloadBytes);
+    if (!acquireBudget(footprint)) {
+        return false;
+    }
+    
+    // 只在消息确定入队时分配序号，被丢弃的消息不会留下永远无法完成的序号
+    auto stamp = [&](LogMessage& msg) {
+        fill(msg);
+        msg.sequence = nextSequence_.fetch_add(1);
+    };
+    
+    // 槽位复用模式：直接向空闲槽位赋值，字符串复用上一轮留下的容量；
+    // 否则交给按配置选择的队列，有界算法已满时由其等待策略先行重试
+    auto push = [&] {
+        return slotRing_ ? slotRing_->tryPush(stamp) : messageQueue_->emplace(stamp);
+    };
+    
+    if (push()) {
+        signalConsumer();
+        return true;
+    }
+    
+    if (canBlockProducers() && waitForSpace(push)) {
+        signalConsumer();
+        return true;
+    }
+    
+    memoryBudget_.release(footprint);
+    droppedCount_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+template<typename Fill>
+bool LogManager::stage(size_t payloadBytes, Fill&& fill) {
+    size_t batchSize = stagingBatchSize_.load(std::memory_order_relaxed);
+    if (batchSize == 0) {
+        return false;
+    }
+    
+    StagingBuffer* buffer = localStagingBuffer(true);
+    std::lock_guard<std::mutex> lock(buffer->getMutex());
+    buffer->push(payloadBytes, fill);
+    
+    // 以刚暂存消息的时间戳判断超时，不额外读取时钟
+    if (buffer->size() >= batchSize || buffer->getBytes() >= stagingMaxBytes_.load(std::memory_order_relaxed) ||
+        buffer->isDue(buffer->at(buffer->size() - 1).timestamp,
+                      std::chrono::microseconds(stagingMaxDelayUs_.load(std::memory_order_relaxed)))) {
+        publishStaged(*buffer);
+    }
+    return true;
+}
+
+void LogManager::publishStaged(StagingBuffer& buffer) {
+    size_t count = buffer.size();
+    if (count == 0) {
+        return;
+    }
+    
+    // 整批一次申请预算、一次入队；槽位复用模式没有批量接口，逐条发布
+    size_t published = 0;
+    if (!slotRing_ && memoryBudget_.tryAcquire(count * messageQueue_->getItemOverhead() + buffer.getBytes())) {
+        while (published < count) {
+            uint64_t base = 0;
+            size_t claimed = messageQueue_->emplaceBatch(count - published,
+                [&](LogMessage& msg, size_t index, size_t total) {
+                    if (index == 0) {
+                        base = nextSequence_.fetch_add(total);
+                    }
+                    msg = std::move(buffer.at(published + index));
+                    msg.sequence = base + index;
+                });
+            if (claimed == 0) {
+                break;
+            }
+            published += claimed;
+        }
+        
+        // 有界队列放不下的部分归还预算，下面逐条按溢出策略处理
+        for (size_t i = published; i < count; ++i) {
+            releaseBudget(buffer.at(i));
+        }
+        if (published > 0) {
+            signalConsumer();
+        }
+    }
+    
+    for (size_t i = published; i < count; ++i) {
+        LogMessage& staged = buffer.at(i);
+        publish(staged.message.size() + staged.file.size() + staged.function.size(),
+                [&](LogMessage& msg) { msg = std::move(staged); });
+    }
+    buffer.clear();
+}
+
+void LogManager::publishAllStaged(bool dueOnly) {
+    std::unique_lock<std::mutex> listLock(stagingMutex_, std::defer_lock);
+    if (dueOnly) {
+        // 工作线程不等待：持有者可能是正在准备fork的线程
+        if (!listLock.try_lock()) {
+            return;
+        }
+    } else {
+        listLock.lock();
+    }
+    
+    bool enabled = stagingBatchSize_.load(std::memory_order_relaxed) > 0;
+    auto now = std::chrono::system_clock::now();
+    auto maxDelay = std::chrono::microseconds(stagingMaxDelayUs_.load(std::memory_order_relaxed));
+    
+    for (auto it = stagingBuffers_.begin(); it != stagingBuffers_.end();) {
+        StagingBuffer& buffer = **it;
+        std::unique_lock<std::mutex> lock(buffer.getMutex(), std::defer_lock);
+        if (dueOnly && !lock.try_lock()) {
+            // 拥有者正在写入，它会自己按条件发布
+            ++it;
+            continue;
+        }
+        if (!dueOnly) {
+            lock.lock();
+        }
+        
+        if (!dueOnly || !enabled || buffer.isRetired() || buffer.isDue(now, maxDelay)) {
+            publishStaged(buffer);
+        }
+        
+        bool retired = buffer.isRetired();
+        lock.unlock();
+        it = retired ? stagingBuffers_.erase(it) : it + 1;
+    }
+}
+
+StagingBuffer* LogManager::localStagingBuffer(bool create) {
+    // 与错误回溯相同，按实例编号区分，线性查找即可
+    thread_local StagingHolder holder;
+    
+    for (auto& entry : holder.buffers) {
+        if (entry.first == instanceId_) {
+            return entry.second.get();
+        }
+    }
+    
+    if (!create) {
+        return nullptr;
+    }
+    
+    // 已析构实例的缓冲区只剩此表持有，新增条目前顺带释放，避免长期线程的表无限增长
+    pruneDeadInstances(holder.buffers, holder.seenDestroyed);
+    
+    auto buffer = std::make_shared<StagingBuffer>();
+    {
+        std::lock_guard<std::mutex> lock(stagingMutex_);
+        stagingBuffers_.push_back(buffer);
+    }
+    holder.buffers.emplace_back(instanceId_, buffer);
+    return buffer.get();
+}
+
+template<typename Fill>
+bool LogManager::deferToErrorBacklog(LogLevel level, Fill&& fill) {
+    size_t capacity = errorBacklogSize_.load(std::memory_order_relaxed);
+    if (capacity == 0) {
+        return false;
+    }
+    
+    ErrorBacklog& backlog = localErrorBacklog();
+    if (level <= errorBacklogLevel_.load(std::memory_order_relaxed)) {
+        backlog.setCapacity(capacity);
+        backlog.push(fill);
+        return true;
+    }
+    
+    if (level >= LogLevel::ERROR) {
+        // 缓存的消息保留原来的时间戳、线程和上下文，按原顺序写在错误之前
+        backlog.drain([this](const LogMessage& buffered) {
+            enqueue(buffered.message.size() + buffered.file.size() + buffered.function.size(),
+                    [&](LogMessage& msg) { msg = buffered; });
+        });
+    }
+    return false;
+}
+
+template<typename Fill>
+bool LogManager::writeThrough(LogLevel level, Fill&& fill) {
+    if (!syncWrite_.load(std::memory_order_relaxed) || level < syncWriteLevel_.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    
+    // 输出内部记录同步级别的日志时本线程已持有消费者锁，改走队列避免自锁
+    if (consumerThread_.load(std::memory_order_relaxed) == std::this_thread::get_id()) {
+        return false;
+    }
+    
+    // 本线程暂存的日志先于本条取得序号
+    flushLocalStaging();
+    
+    ConsumerLock consumer(*this);
+    
+    // 本条占用一个序号但不入队，由这里直接完成，异步刷新的目标照常推进
+    uint64_t sequence = nextSequence_.fetch_add(1);
+    
+    // 已取得更小序号的生产者一定会入队，只是可能还没链入，队列暂时取空时稍等
+    std::pmr::vector<LogMessage> messages(messageQueue_->getMemoryResource());
+    auto deadline = std::chrono::steady_clock::now() + SYNC_WRITE_WAIT;
+    while (completedSequence_ < sequence) {
+        if (drainBatch(messages, 100) > 0) {
+            continue;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+        std::this_thread::yield();
+    }
+    
+    if (blockedProducers_.load() > 0) {
+        std::lock_guard<std::mutex> spaceLock(spaceMutex_);
+        spaceCondition_.notify_all();
+    }
+    
+    LogMessage msg;
+    fill(msg);
+    msg.sequence = sequence;
+    processMessage(msg);
+    completeSequence(sequence);
     
-    // 同时添加到分发器
     if (dispatcher_) {
-        // 创建一个新的副本添加到分发器
-        auto consoleOutput2 = std::make_unique<ConsoleOutput>(true);
-        auto timestampDecorator2 = std::make_unique<TimestampDecorator>(std::move(consoleOutput2));
-        auto colorDecorator2 = std::make_unique<ColorDecorator>(std::move(timestampDecorator2));
-        dispatcher_->addOutput(std::move(colorDecorator2));
+        dispatcher_->sync();
     }
+    return true;
 }
 
-bool LogManager::shouldLog(LogLevel level) const {
-    std::lock_guard<std::mutex> lock(configMutex_);
+ErrorBacklog& LogManager::localErrorBacklog() const {
+    // 一个线程通常只向一两个实例写日志，线性查找即可；按编号而不是地址区分，新实例不会继承旧实例的缓存
+    thread_local std::vector<std::pair<uint64_t, std::unique_ptr<ErrorBacklog>>> backlogs;
+    thread_local uint64_t seenDestroyed = 0;
     
-    if (!config_) {
-        return true; // 没有配置时默认记录所有日志
+    for (auto& entry : backlogs) {
+        if (entry.first == instanceId_) {
+            return *entry.second;
+        }
     }
     
-    return static_cast<int>(level) >= static_cast<int>(config_->minLevel);
+    pruneDeadInstances(backlogs, seenDestroyed);
+    backlogs.emplace_back(instanceId_, std::make_unique<ErrorBacklog>());
+    return *backlogs.back().second;
+}
+
+void LogManager::releaseBudget(const LogMessage& msg) {
+    memoryBudget_.release(messageFootprint(msg.message.size() + msg.file.size() + msg.function.size()));
+}
+
+void LogManager::updateQueueFootprint() {
+    size_t footprint = messageQueue_->getFootprint();
+    if (footprint > queueFootprint_) {
+        memoryBudget_.acquire(footprint - queueFootprint_);
+    } else {
+        memoryBudget_.release(queueFootprint_ - footprint);
+    }
+    queueFootprint_ = footprint;
+}
+
+size_t LogManager::messageFootprint(size_t payloadBytes) const {
+    // 槽位数组在创建时已整体登记，每条消息只计入其文本；链表队列另计节点开销
+    return slotRing_ ? payloadBytes : messageQueue_->getItemOverhead() + payloadBytes;
+}
+
+bool LogManager::isQueueEmpty() const {
+    return slotRing_ ? slotRing_->empty() : messageQueue_->empty();
+}
+
+bool LogManager::rebuildQueue(const LogConfig& config, std::string* error) {
+    std::pmr::memory_resource* resource = config.memoryResource ? config.memoryResource
+                                                                : std::pmr::get_default_resource();
+    
+    // 有界算法的容量取决于maxQueueSize，分段算法按queueSegmentSize分段，链表算法无界
+    size_t capacity = 0;
+    size_t segmentSize = 0;
+    if (config.queueAlgorithm == QueueAlgorithm::SEGMENTED) {
+        segmentSize = RuntimeCapacity::roundUpToPowerOfTwo(config.queueSegmentSize);
+    } else if (config.queueAlgorithm != QueueAlgorithm::LINKED) {
+        capacity = RuntimeCapacity::roundUpToPowerOfTwo(config.maxQueueSize);
+    }
+    std::unique_ptr<AnyQueue<LogMessage>> queue;
+    if (resource != messageQueue_->getMemoryResource() || config.queueAlgorithm != messageQueue_->getAlgorithm() ||
+        config.queueWaitStrategy != messageQueue_->getWaitStrategy() || capacity != messageQueue_->getCapacity() ||
+        segmentSize != messageQueue_->getSegmentSize()) {
+        queue = makeQueue<LogMessage>(config.queueAlgorithm, config.queueWaitStrategy, capacity + segmentSize, resource);
+    }
+    
+    // 现有槽位数组满足配置时保留，避免丢弃已经预热的字符串容量
+    bool keepRing = slotRing_ ? slotRing_->getMemoryResource() == resource &&
+                                    slotRing_->getCapacity() ==
+                                        SlotRing<LogMessage>::roundUpToPowerOfTwo(config.recycledSlotCount)
+                              : config.recycledSlotCount == 0;
+    std::unique_ptr<SlotRing<LogMessage>> ring;
+    if (!keepRing && config.recycledSlotCount > 0) {
+        ring = std::make_unique<SlotRing<LogMessage>>(config.recycledSlotCount, resource);
+    }
+    
+    // 有界队列的槽位数组、分段队列的段目录和消息槽位数组都是预先分配的，单独就超出上限时拒绝
+    size_t preallocated = (queue ? queue->getFootprint() : messageQueue_->getFootprint()) +
+                          (keepRing ? (slotRing_ ? slotRing_->getFootprint() : 0) : (ring ? ring->getFootprint() : 0));
+    if (config.maxMemoryBytes > 0 && preallocated > config.maxMemoryBytes) {
+        if (error) {
+            *error = "队列预分配的" + std::to_string(preallocated) + "字节超出内存上限" +
+                     std::to_string(config.maxMemoryBytes) + "字节，继续使用原有队列";
+        }
+        return false;
+    }
+    
+    if (queue) {
+        memoryBudget_.release(queueFootprint_);
+        queueFootprint_ = 0;
+        messageQueue_ = std::move(queue);
+        // 预分配的部分已经存在，无法拒绝，只做登记
+        updateQueueFootprint();
+    }
+    
+    if (!keepRing) {
+        if (slotRing_) {
+            memoryBudget_.release(slotRing_->getFootprint());
+        }
+        slotRing_ = std::move(ring);
+        if (slotRing_) {
+            memoryBudget_.acquire(slotRing_->getFootprint());
+        }
+    }
+    return true;
+}
+
+size_t LogManager::getPreallocatedBytes() const {
+    return messageQueue_->getFootprint() + (slotRing_ ? slotRing_->getFootprint() : 0);
+}
+
+void LogManager::updateLevelDegradation() {
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastDegradeCheck_ < std::chrono::milliseconds(10)) {
+        return;
+    }
+    lastDegradeCheck_ = now;
+    
+    size_t depthLimit = 0;
+    size_t bytesLimit = 0;
+    double recoverRatio = 0.5;
+    std::chrono::milliseconds sustain(0);
+    LogLevel configuredLevel = LogLevel::DEBUG;
+    LogLevel maxLevel = LogLevel::WARN;
+    {
+        std::lock_guard<std::mutex> lock(configMutex_);
+        if (config_) {
+            depthLimit = config_->degradeQueueDepth;
+            bytesLimit = config_->degradeMemoryBytes;
+            recoverRatio = config_->degradeRecoverRatio;
+            sustain = std::chrono::milliseconds(config_->degradeSustainMs);
+            configuredLevel = config_->minLevel;
+            maxLevel = config_->degradeMaxLevel;
+        }
+        
+        // 降级被新配置清除后，压力与恢复都从现在重新计时
+        if (degradeReset_) {
+            pressureSince_ = now;
+            calmSince_ = now;
+            degradeReset_ = false;
+        }
+    }
+    
+    if (depthLimit == 0 && bytesLimit == 0) {
+        return;
+    }
+    
+    size_t depth = getQueueSize();
+    size_t bytes = memoryBudget_.getUsage();
+    bool overloaded = (depthLimit > 0 && depth >= depthLimit) ||
+                      (bytesLimit > 0 && bytes >= bytesLimit);
+    bool relieved = (depthLimit == 0 || depth <= static_cast<size_t>(depthLimit * recoverRatio)) &&
+                    (bytesLimit == 0 || bytes <= static_cast<size_t>(bytesLimit * recoverRatio));
+    
+    // 条件不成立时计时起点不断前移，因此 now - since 就是条件连续成立的时长
+    if (!overloaded) {
+        pressureSince_ = now;
+    }
+    if (!relieved) {
+        calmSince_ = now;
+    }
+    
+    LogLevel current = effectiveMinLevel_.load(std::memory_order_relaxed);
+    int currentValue = static_cast<int>(current);
+    
+    if (overloaded && now - pressureSince_ >= sustain && currentValue < static_cast<int>(maxLevel)) {
+        LogLevel raised = static_cast<LogLevel>(currentValue + 1);
+        effectiveMinLevel_.store(raised);
+        pressureSince_ = now;
+        writeInternal(LogLevel::WARN, "[降级] 队列深度 " + std::to_string(depth) + "，内存使用 " +
+                      std::to_string(bytes) + " 字节，最低日志级别由 " + levelToString(current) +
+                      " 提升为 " + levelToString(raised));
+    } else if (relieved && now - calmSince_ >= sustain && currentValue > static_cast<int>(configuredLevel)) {
+        LogLevel restored = static_cast<LogLevel>(currentValue - 1);
+        effectiveMinLevel_.store(restored);
+        calmSince_ = now;
+        writeInternal(LogLevel::WARN, "[恢复] 队列深度 " + std::to_string(depth) + "，内存使用 " +
+                      std::to_string(bytes) + " 字节，最低日志级别由 " + levelToString(current) +
+                      " 恢复为 " + levelToString(restored));
+    }
+}
+
+void LogManager::reportCallSites() {
+    size_t interval = 0;
+    size_t topN = 0;
+    {
+        std::lock_guard<std::mutex> lock(configMutex_);
+        if (config_) {
+            interval = config_->callSiteReportIntervalMs;
+            topN = config_->callSiteReportTopN;
+        }
+    }
+    
+    if (interval == 0 || topN == 0) {
+        lastCallSiteReportTime_ = std::chrono::steady_clock::time_point();
+        return;
+    }
+    
+    // 启用后先记下基线，第一份排行只覆盖一个完整周期
+    auto now = std::chrono::steady_clock::now();
+    if (lastCallSiteReportTime_ == std::chrono::steady_clock::time_point()) {
+        lastCallSiteReportTime_ = now;
+        lastCallSiteReport_ = CallSiteStats::getInstance().snapshot();
+        return;
+    }
+    
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastCallSiteReportTime_);
+    if (elapsed < std::chrono::milliseconds(interval)) {
+        return;
+    }
+    lastCallSiteReportTime_ = now;
+    
+    auto current = CallSiteStats::getInstance().snapshot();
+    auto talkers = CallSiteStats::top(CallSiteStats::delta(current, lastCallSiteReport_), topN);
+    lastCallSiteReport_ = std::move(current);
+    
+    for (size_t i = 0; i < talkers.size(); ++i) {
+        const auto& entry = talkers[i];
+        writeInternal(LogLevel::INFO, "[统计] 最近 " + std::to_string(elapsed.count()) + " ms 第 " +
+                      std::to_string(i + 1) + " 名 " + entry.location() + "：" +
+                      std::to_string(entry.messages) + " 条，" + std::to_string(entry.bytes) +
+                      " 字节，丢弃 " + std::to_string(entry.drops) + " 条");
+    }
+}
+
+void LogManager::reportSuppressed() {
+    if (instancePtr_.load(std::memory_order_acquire) != this) {
+        return;
+    }
+    
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastSuppressedReport_ < SUPPRESSED_REPORT_INTERVAL) {
+        return;
+    }
+    lastSuppressedReport_ = now;
+    
+    for (const auto& pending : SuppressionRegistry::getInstance().takePending()) {
+        CallSiteStats::getInstance().recordDropped(pending.site.statsIndex, pending.count);
+        if (!shouldLog(pending.level)) {
+            continue;
+        }
+        
+        LogMessage msg;
+        msg.assign(pending.level, suppressedSummary(pending.count), "", pending.site.line);
+        msg.fileId = pending.site.fileId;
+        msg.functionId = pending.site.functionId;
+        processMessage(msg);
+    }
+}
+
+void LogManager::writeInternal(LogLevel level, const std::string& message) {
+    LogMessage msg;
+    msg.assign(level, message);
+    processMessage(msg);
 }
 
 } // namespace async_log
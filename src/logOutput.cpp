@@ -11,6 +11,7 @@
 
 #include "logOutput.hpp"
 #include "logTypes.hpp"
+#include "logContext.hpp"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -18,13 +19,54 @@
 #include <chrono>
 #include <filesystem>
 #include <algorithm>
+#include <charconv>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace async_log {
 
+void formatLogLine(const LogMessage& msg, std::pmr::string& out) {
+    // 数字转换使用栈上缓冲区，避免临时字符串
+    char digits[24];
+    
+    out.clear();
+    out += '[';
+    out += levelToString(msg.level);
+    out += "] ";
+    
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(
+        msg.timestamp.time_since_epoch()).count();
+    out.append(digits, std::to_chars(digits, digits + sizeof(digits), seconds).ptr);
+    
+    out += ' ';
+    out += msg.getFile();
+    out += ':';
+    out.append(digits, std::to_chars(digits, digits + sizeof(digits), msg.line).ptr);
+    
+    const std::string& function = msg.getFunction();
+    if (!function.empty()) {
+        out += ' ';
+        out += function;
+    }
+    
+    out += " - ";
+    out += msg.getMessage();
+    
+    // 诊断上下文在工作线程上展开
+    if (msg.context) {
+        out += ' ';
+        LogContext::format(msg.context, out);
+    }
+}
+
 // FileOutput 实现
-FileOutput::FileOutput(const std::string& path, size_t maxSize, int maxCount)
+FileOutput::FileOutput(const std::string& path, size_t maxSize, int maxCount,
+                       std::pmr::memory_resource* resource)
     : filePath_(path), currentFileSize_(0), maxFileSize_(maxSize), 
-      maxFileCount_(maxCount), isOpen_(false) {
+      maxFileCount_(maxCount), isOpen_(false), lineBuffer_(resource) {
     openFile();
 }
 
@@ -38,7 +80,8 @@ FileOutput::FileOutput(FileOutput&& other) noexcept
       currentFileSize_(other.currentFileSize_),
       maxFileSize_(other.maxFileSize_),
       maxFileCount_(other.maxFileCount_),
-      isOpen_(other.isOpen_) {
+      isOpen_(other.isOpen_),
+      lineBuffer_(std::move(other.lineBuffer_)) {
     other.isOpen_ = false;
     other.currentFileSize_ = 0;
 }
@@ -66,7 +109,7 @@ void FileOutput::write(const LogMessage& msg) {
         return;
     }
     
-    std::string formattedMsg = formatMessage(msg);
+    const std::pmr::string& formattedMsg = formatMessage(msg);
     fileStream_ << formattedMsg << std::endl;
     currentFileSize_ += formattedMsg.length() + 1; // +1 for newline
     
@@ -76,6 +119,30 @@ void FileOutput::write(const LogMessage& msg) {
     }
 }
 
+bool FileOutput::format(const LogMessage& msg, std::pmr::string& out) const {
+    formatLogLine(msg, out);
+    out += '\n';
+    return true;
+}
+
+void FileOutput::writeFormatted(const std::pmr::string& text) {
+    std::lock_guard<std::mutex> lock(fileMutex_);
+    
+    if (!isOpen_ && !openFile()) {
+        return;
+    }
+    
+    // 整批文本一次写入，只在批次末尾刷新流
+    fileStream_.write(text.data(), static_cast<std::streamsize>(text.size()));
+    fileStream_.flush();
+    currentFileSize_ += text.size();
+    
+    // 轮转以批次为单位，文件可能略微超过上限
+    if (currentFileSize_ >= maxFileSize_) {
+        rotateFile();
+    }
+}
+
 void FileOutput::flush() {
     std::lock_guard<std::mutex> lock(fileMutex_);
     if (isOpen_) {
@@ -83,6 +150,36 @@ void FileOutput::flush() {
     }
 }
 
+void FileOutput::sync() {
+    std::lock_guard<std::mutex> lock(fileMutex_);
+    if (!isOpen_) {
+        return;
+    }
+    
+    fileStream_.flush();
+    
+#if defined(__unix__) || defined(__APPLE__)
+    // ofstream不暴露文件描述符；fsync作用于文件本身，另开一个描述符同样能落盘
+    int fd = ::open(filePath_.c_str(), O_WRONLY);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+#endif
+}
+
+void FileOutput::reopen() {
+    std::lock_guard<std::mutex> lock(fileMutex_);
+    if (!isOpen_) {
+        return;
+    }
+    
+    // 父进程在fork前已经刷新，缓冲区为空，关闭不会重复写出内容
+    fileStream_.close();
+    isOpen_ = false;
+    openFile();
+}
+
 void FileOutput::close() {
     std::lock_guard<std::mutex> lock(fileMutex_);
     if (isOpen_) {
@@ -164,30 +261,20 @@ void FileOutput::rotateFile() {
     }
 }
 
-std::string FileOutput::formatMessage(const LogMessage& msg) {
-    std::ostringstream oss;
-    oss << "[" << levelToString(msg.level) << "] "
-        << std::chrono::duration_cast<std::chrono::seconds>(
-               msg.timestamp.time_since_epoch()).count()
-        << " " << msg.file << ":" << msg.line;
-    
-    if (!msg.function.empty()) {
-        oss << " " << msg.function;
-    }
-    
-    oss << " - " << msg.message;
-    return oss.str();
+const std::pmr::string& FileOutput::formatMessage(const LogMessage& msg) {
+    formatLogLine(msg, lineBuffer_);
+    return lineBuffer_;
 }
 
 // ConsoleOutput 实现
-ConsoleOutput::ConsoleOutput(bool enableColor)
-    : enableColor_(enableColor) {
+ConsoleOutput::ConsoleOutput(bool enableColor, std::pmr::memory_resource* resource)
+    : enableColor_(enableColor), lineBuffer_(resource) {
 }
 
 void ConsoleOutput::write(const LogMessage& msg) {
     std::lock_guard<std::mutex> lock(consoleMutex_);
     
-    std::string formattedMsg = formatMessage(msg);
+    const std::pmr::string& formattedMsg = formatMessage(msg);
     
     if (enableColor_) {
         std::cout << getColorCode(msg.level) << formattedMsg << getResetCode() << std::endl;
@@ -196,6 +283,23 @@ void ConsoleOutput::write(const LogMessage& msg) {
     }
 }
 
+bool ConsoleOutput::format(const LogMessage& msg, std::pmr::string& out) const {
+    formatLogLine(msg, out);
+    
+    if (enableColor_) {
+        out.insert(0, getColorCode(msg.level));
+        out += getResetCode();
+    }
+    out += '\n';
+    return true;
+}
+
+void ConsoleOutput::writeFormatted(const std::pmr::string& text) {
+    std::lock_guard<std::mutex> lock(consoleMutex_);
+    std::cout.write(text.data(), static_cast<std::streamsize>(text.size()));
+    std::cout.flush();
+}
+
 void ConsoleOutput::flush() {
     std::lock_guard<std::mutex> lock(consoleMutex_);
     std::cout.flush();
@@ -213,7 +317,7 @@ void ConsoleOutput::setColorEnabled(bool enable) {
     enableColor_ = enable;
 }
 
-std::string ConsoleOutput::getColorCode(LogLevel level) {
+std::string ConsoleOutput::getColorCode(LogLevel level) const {
     switch (level) {
         case LogLevel::DEBUG: return "\033[36m"; // 青色
         case LogLevel::INFO:  return "\033[32m"; // 绿色
@@ -224,28 +328,18 @@ std::string ConsoleOutput::getColorCode(LogLevel level) {
     }
 }
 
-std::string ConsoleOutput::getResetCode() {
+std::string ConsoleOutput::getResetCode() const {
     return "\033[0m";
 }
 
-std::string ConsoleOutput::formatMessage(const LogMessage& msg) {
-    std::ostringstream oss;
-    oss << "[" << levelToString(msg.level) << "] "
-        << std::chrono::duration_cast<std::chrono::seconds>(
-               msg.timestamp.time_since_epoch()).count()
-        << " " << msg.file << ":" << msg.line;
-    
-    if (!msg.function.empty()) {
-        oss << " " << msg.function;
-    }
-    
-    oss << " - " << msg.message;
-    return oss.str();
+const std::pmr::string& ConsoleOutput::formatMessage(const LogMessage& msg) {
+    formatLogLine(msg, lineBuffer_);
+    return lineBuffer_;
 }
 
 // NetworkOutput 实现
-NetworkOutput::NetworkOutput(const std::string& host, int port)
-    : host_(host), port_(port), isConnected_(false) {
+NetworkOutput::NetworkOutput(const std::string& host, int port, std::pmr::memory_resource* resource)
+    : host_(host), port_(port), isConnected_(false), lineBuffer_(resource) {
     // 这里应该实现实际的网络连接逻辑
     // 暂时只是模拟
 }
@@ -258,8 +352,25 @@ void NetworkOutput::write(const LogMessage& msg) {
     }
     
     if (isConnected_) {
-        std::string formattedMsg = formatMessage(msg);
-        sendData(formattedMsg);
+        sendData(formatMessage(msg));
+    }
+}
+
+bool NetworkOutput::format(const LogMessage& msg, std::pmr::string& out) const {
+    formatLogLine(msg, out);
+    out += '\n';
+    return true;
+}
+
+void NetworkOutput::writeFormatted(const std::pmr::string& text) {
+    std::lock_guard<std::mutex> lock(networkMutex_);
+    
+    if (!isConnected_) {
+        connect();
+    }
+    
+    if (isConnected_) {
+        sendData(text);
     }
 }
 
@@ -267,6 +378,12 @@ void NetworkOutput::flush() {
     // 网络输出通常不需要flush
 }
 
+void NetworkOutput::reopen() {
+    // 与父进程共用一条连接会使两边的数据交错，断开后由下一次写入建立自己的连接
+    std::lock_guard<std::mutex> lock(networkMutex_);
+    disconnect();
+}
+
 void NetworkOutput::close() {
     std::lock_guard<std::mutex> lock(networkMutex_);
     disconnect();
@@ -293,25 +410,15 @@ bool NetworkOutput::isConnected() const {
     return isConnected_;
 }
 
-bool NetworkOutput::sendData(const std::string& data) {
+bool NetworkOutput::sendData(const std::pmr::string& data) {
     // 这里应该实现实际的网络发送逻辑
     // 暂时只是模拟
     return true;
 }
 
-std::string NetworkOutput::formatMessage(const LogMessage& msg) {
-    std::ostringstream oss;
-    oss << "[" << levelToString(msg.level) << "] "
-        << std::chrono::duration_cast<std::chrono::seconds>(
-               msg.timestamp.time_since_epoch()).count()
-        << " " << msg.file << ":" << msg.line;
-    
-    if (!msg.function.empty()) {
-        oss << " " << msg.function;
-    }
-    
-    oss << " - " << msg.message;
-    return oss.str();
+const std::pmr::string& NetworkOutput::formatMessage(const LogMessage& msg) {
+    formatLogLine(msg, lineBuffer_);
+    return lineBuffer_;
 }
 
 } // namespace async_log
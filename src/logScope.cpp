@@ -0,0 +1,87 @@
+/**
+ * @file logScope.cpp
+ * @brief 作用域计时与跨度事件实现
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 实现跨度ID分配、活动跨度栈和耗时日志输出
+ * @see logScope.hpp
+ * @since 1.1.0
+ */
+
+#include "logScope.hpp"
+#include "logManager.hpp"
+#include <atomic>
+#include <string>
+
+namespace async_log {
+
+LogScope::LogScope(const LogCallSite& site, const char* name,
+                   std::chrono::nanoseconds threshold, LogLevel level)
+    : site_(site), name_(name), threshold_(threshold), level_(level),
+      spanId_(nextSpanId()), parentSpanId_(activeSpan()) {
+    activeSpan() = spanId_;
+    start_ = std::chrono::steady_clock::now();
+}
+
+LogScope::~LogScope() {
+    auto elapsed = std::chrono::steady_clock::now() - start_;
+    activeSpan() = parentSpanId_;
+
+    if (elapsed < threshold_) {
+        return;
+    }
+
+    LogManager& manager = LogManager::getInstance();
+    if (!manager.isEnabled(level_)) {
+        return;
+    }
+
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    manager.log(level_, std::string(name_) + " 耗时 " + std::to_string(micros) + " us (span=" +
+                std::to_string(spanId_) + " parent=" + std::to_string(parentSpanId_) + ")", site_);
+}
+
+uint64_t LogScope::getSpanId() const {
+    return spanId_;
+}
+
+uint64_t LogScope::getParentSpanId() const {
+    return parentSpanId_;
+}
+
+uint64_t LogScope::currentSpanId() {
+    return activeSpan();
+}
+
+namespace {
+
+/**
+ * @brief 线程本地的跨度状态
+ * @details 只包含平凡类型，线程局部变量无需动态初始化检查
+ * @since 1.1.0
+ */
+struct SpanState {
+    uint64_t prefix;        ///< 线程序号左移32位，0表示尚未分配
+    uint32_t counter;       ///< 线程内计数
+    uint64_t active;        ///< 活动跨度ID
+};
+
+thread_local SpanState spanState = {0, 0, 0};
+
+std::atomic<uint32_t> threadCounter{0};
+
+} // namespace
+
+uint64_t LogScope::nextSpanId() {
+    if (spanState.prefix == 0) {
+        spanState.prefix = static_cast<uint64_t>(threadCounter.fetch_add(1) + 1) << 32;
+    }
+    return spanState.prefix | ++spanState.counter;
+}
+
+uint64_t& LogScope::activeSpan() {
+    return spanState.active;
+}
+
+} // namespace async_log
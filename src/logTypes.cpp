@@ -10,6 +10,9 @@
  */
 
 #include "logTypes.hpp"
+#include "stringTable.hpp"
+#include "logContext.hpp"
+#include "callSiteStats.hpp"
 #include <sstream>
 #include <iomanip>
 #include <thread>
@@ -38,4 +41,43 @@ LogLevel stringToLevel(const std::string& levelStr) {
     return LogLevel::INFO;
 }
 
+void LogMessage::assign(LogLevel lvl, const std::string& msg,
+                        const std::string& f, int ln, const std::string& func) {
+    level = lvl;
+    message.assign(msg);
+    file.assign(f);
+    line = ln;
+    function.assign(func);
+    timestamp = std::chrono::system_clock::now();
+    threadId = std::this_thread::get_id();
+    fileId = 0;
+    functionId = 0;
+    messageId = 0;
+    context = LogContext::current();
+}
+
+const std::string& LogMessage::getMessage() const {
+    return messageId != 0 ? StringTable::getInstance().resolve(messageId) : message;
+}
+
+const std::string& LogMessage::getFile() const {
+    return fileId != 0 ? StringTable::getInstance().resolve(fileId) : file;
+}
+
+const std::string& LogMessage::getFunction() const {
+    return functionId != 0 ? StringTable::getInstance().resolve(functionId) : function;
+}
+
+void LogMessage::setMessage(std::string text) {
+    message = std::move(text);
+    messageId = 0;
+}
+
+LogCallSite::LogCallSite(const char* file, int ln, const char* function)
+    : fileId(StringTable::getInstance().intern(file ? file : "")),
+      functionId(StringTable::getInstance().intern(function ? function : "")),
+      line(ln),
+      statsIndex(CallSiteStats::getInstance().registerSite(fileId, ln, functionId)) {
+}
+
 } // namespace async_log
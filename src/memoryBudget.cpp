@@ -0,0 +1,76 @@
+/**
+ * @file memoryBudget.cpp
+ * @brief 日志内存预算实现
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 实现基于原子计数器的字节预算
+ * @see memoryBudget.hpp
+ * @since 1.1.0
+ */
+
+#include "memoryBudget.hpp"
+
+namespace async_log {
+
+MemoryBudget::MemoryBudget(size_t limit)
+    : used_(0), peak_(0), limit_(limit) {
+}
+
+bool MemoryBudget::tryAcquire(size_t bytes) {
+    size_t limit = limit_.load(std::memory_order_relaxed);
+
+    if (limit == 0) {
+        updatePeak(used_.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+        return true;
+    }
+
+    // CAS循环保证并发申请时不会越过上限
+    size_t current = used_.load(std::memory_order_relaxed);
+    do {
+        if (bytes > limit || current > limit - bytes) {
+            return false;
+        }
+    } while (!used_.compare_exchange_weak(current, current + bytes, std::memory_order_relaxed));
+
+    updatePeak(current + bytes);
+    return true;
+}
+
+void MemoryBudget::acquire(size_t bytes) {
+    updatePeak(used_.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+}
+
+void MemoryBudget::release(size_t bytes) {
+    used_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+size_t MemoryBudget::getUsage() const {
+    return used_.load(std::memory_order_relaxed);
+}
+
+size_t MemoryBudget::getPeakUsage() const {
+    return peak_.load(std::memory_order_relaxed);
+}
+
+size_t MemoryBudget::getLimit() const {
+    return limit_.load(std::memory_order_relaxed);
+}
+
+void MemoryBudget::setLimit(size_t limit) {
+    limit_.store(limit, std::memory_order_relaxed);
+}
+
+bool MemoryBudget::canEverFit(size_t bytes) const {
+    size_t limit = limit_.load(std::memory_order_relaxed);
+    return limit == 0 || bytes <= limit;
+}
+
+void MemoryBudget::updatePeak(size_t current) {
+    size_t peak = peak_.load(std::memory_order_relaxed);
+    while (current > peak && !peak_.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {
+        // peak已被更新为最新值，继续比较
+    }
+}
+
+} // namespace async_log
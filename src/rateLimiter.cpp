@@ -0,0 +1,111 @@
+/**
+ * @file rateLimiter.cpp
+ * @brief 调用点限流与采样策略实现
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 实现按N取一采样、窗口前N条、GCRA令牌桶以及限流调用点表
+ * @see rateLimiter.hpp
+ * @since 1.1.0
+ */
+
+#include "rateLimiter.hpp"
+#include <algorithm>
+
+namespace async_log {
+
+// EveryNSampler 实现
+EveryNSampler::EveryNSampler(uint64_t n)
+    : counter_(0), n_(n == 0 ? 1 : n) {
+}
+
+bool EveryNSampler::allow() {
+    return counter_.fetch_add(1, std::memory_order_relaxed) % n_ == 0;
+}
+
+// FirstNPerIntervalLimiter 实现
+FirstNPerIntervalLimiter::FirstNPerIntervalLimiter(uint64_t n, std::chrono::milliseconds interval)
+    : windowStart_(nowNanos()), count_(0), n_(n),
+      intervalNanos_(std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count()) {
+}
+
+bool FirstNPerIntervalLimiter::allow() {
+    int64_t now = nowNanos();
+    int64_t start = windowStart_.load(std::memory_order_relaxed);
+
+    // 只有赢得CAS的线程负责开启新窗口
+    if (now - start >= intervalNanos_ &&
+        windowStart_.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+        count_.store(0, std::memory_order_relaxed);
+    }
+
+    return record(count_.fetch_add(1, std::memory_order_relaxed) < n_);
+}
+
+// TokenBucketLimiter 实现
+TokenBucketLimiter::TokenBucketLimiter(double ratePerSecond, uint64_t burst)
+    : theoreticalArrival_(0),
+      emissionInterval_(std::max<int64_t>(1, static_cast<int64_t>(1e9 / ratePerSecond))),
+      burstTolerance_(0) {
+    burstTolerance_ = emissionInterval_ * static_cast<int64_t>((burst == 0 ? 1 : burst) - 1);
+}
+
+bool TokenBucketLimiter::allow() {
+    int64_t now = nowNanos();
+    int64_t arrival = theoreticalArrival_.load(std::memory_order_relaxed);
+
+    for (;;) {
+        int64_t next = std::max(arrival, now) + emissionInterval_;
+
+        // 理论到达时间超前当前时间太多，说明桶中已无令牌
+        if (next - now > burstTolerance_ + emissionInterval_) {
+            return record(false);
+        }
+
+        if (theoreticalArrival_.compare_exchange_weak(arrival, next, std::memory_order_relaxed)) {
+            return record(true);
+        }
+    }
+}
+
+// SuppressionRegistry 实现
+SuppressionRegistry& SuppressionRegistry::getInstance() {
+    // 有意泄漏：调用点的静态登记对象在程序退出时注销，可能晚于本文件的静态对象析构
+    static SuppressionRegistry* instance = new SuppressionRegistry();
+    return *instance;
+}
+
+void SuppressionRegistry::add(RateLimiterBase& limiter, LogLevel level, const LogCallSite& site) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.push_back({&limiter, level, &site});
+}
+
+void SuppressionRegistry::remove(const RateLimiterBase& limiter) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                                  [&limiter](const Entry& entry) { return entry.limiter == &limiter; }),
+                   entries_.end());
+}
+
+std::vector<SuppressionRegistry::Pending> SuppressionRegistry::takePending() {
+    std::vector<Pending> pending;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const Entry& entry : entries_) {
+        // 与调用点放行时的取出竞争也没有关系，每个抑制只会被其中一方取走
+        uint64_t count = entry.limiter->takeSuppressed();
+        if (count > 0) {
+            pending.push_back({entry.level, *entry.site, count});
+        }
+    }
+    return pending;
+}
+
+void SuppressionRegistry::lockForFork() {
+    mutex_.lock();
+}
+
+void SuppressionRegistry::unlockAfterFork() {
+    mutex_.unlock();
+}
+
+} // namespace async_log
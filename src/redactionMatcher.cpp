@@ -0,0 +1,387 @@
+/**
+ * @file redactionMatcher.cpp
+ * @brief 敏感信息多模式匹配器实现
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 实现Aho-Corasick自动机的构建、前缀预过滤、卡号检测和就地打码。
+ *          预过滤在支持SSE2的平台上每次比较16字节，其他平台使用首字节查表的标量实现
+ * @see redactionMatcher.hpp
+ * @since 1.1.0
+ */
+
+#include "redactionMatcher.hpp"
+#include <algorithm>
+#include <cctype>
+#include <queue>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ASYNC_LOG_HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace async_log {
+
+namespace {
+
+constexpr size_t CARD_MIN_DIGITS = 13;   ///< 卡号最少位数
+constexpr size_t CARD_MAX_DIGITS = 19;   ///< 卡号最多位数
+constexpr size_t CARD_KEEP_DIGITS = 4;   ///< 卡号保留的末尾位数
+
+uint8_t foldCase(uint8_t c) {
+    return static_cast<uint8_t>(std::tolower(c));
+}
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+bool isAlnum(char c) {
+    return isDigit(c) || ((static_cast<uint8_t>(c) | 0x20) >= 'a' && (static_cast<uint8_t>(c) | 0x20) <= 'z');
+}
+
+#if defined(ASYNC_LOG_HAS_SSE2)
+size_t lowestBit(int mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, static_cast<unsigned long>(mask));
+    return index;
+#else
+    return static_cast<size_t>(__builtin_ctz(static_cast<unsigned int>(mask)));
+#endif
+}
+#endif
+
+bool passesLuhn(const uint8_t* digits, size_t count) {
+    int sum = 0;
+    bool doubleIt = false;
+    while (count > 0) {
+        int d = digits[--count];
+        if (doubleIt) {
+            d *= 2;
+            if (d > 9) {
+                d -= 9;
+            }
+        }
+        sum += d;
+        doubleIt = !doubleIt;
+    }
+    return sum % 10 == 0;
+}
+
+} // namespace
+
+RedactionMatcher::RedactionMatcher(std::vector<RedactionRule> rules, bool detectCardNumbers)
+    : byteClass_{}, classCount_(1), firstByte_{}, detectCardNumbers_(detectCardNumbers) {
+    rules.erase(std::remove_if(rules.begin(), rules.end(),
+                               [](const RedactionRule& rule) { return rule.pattern.empty(); }),
+                rules.end());
+    rules_ = std::move(rules);
+
+    // 为规则中出现的每个字节（大小写合并）分配一个等价类，其余字节共用类0
+    for (const auto& rule : rules_) {
+        for (unsigned char c : rule.pattern) {
+            uint8_t folded = foldCase(c);
+            if (byteClass_[folded] == 0) {
+                uint8_t cls = static_cast<uint8_t>(classCount_++);
+                byteClass_[folded] = cls;
+                byteClass_[static_cast<uint8_t>(std::toupper(folded))] = cls;
+            }
+        }
+    }
+
+    // 构建字典树，-1表示没有边
+    std::vector<std::vector<int32_t>> trie(1, std::vector<int32_t>(classCount_, -1));
+    outputs_.assign(1, {});
+    for (uint32_t ruleIndex = 0; ruleIndex < rules_.size(); ++ruleIndex) {
+        uint32_t state = 0;
+        for (unsigned char c : rules_[ruleIndex].pattern) {
+            uint8_t cls = byteClass_[c];
+            if (trie[state][cls] < 0) {
+                trie[state][cls] = static_cast<int32_t>(trie.size());
+                trie.emplace_back(classCount_, -1);
+                outputs_.emplace_back();
+            }
+            state = static_cast<uint32_t>(trie[state][cls]);
+        }
+        outputs_[state].push_back(ruleIndex);
+    }
+
+    // 按广度优先顺序计算失败链接，同时把转移补全为完整的DFA
+    const size_t stateCount = trie.size();
+    transitions_.assign(stateCount * classCount_, 0);
+    std::vector<uint32_t> fail(stateCount, 0);
+    std::queue<uint32_t> pending;
+
+    for (size_t cls = 0; cls < classCount_; ++cls) {
+        if (trie[0][cls] > 0) {
+            uint32_t next = static_cast<uint32_t>(trie[0][cls]);
+            transitions_[cls] = next;
+            pending.push(next);
+        }
+    }
+
+    while (!pending.empty()) {
+        uint32_t state = pending.front();
+        pending.pop();
+
+        const auto& inherited = outputs_[fail[state]];
+        outputs_[state].insert(outputs_[state].end(), inherited.begin(), inherited.end());
+
+        for (size_t cls = 0; cls < classCount_; ++cls) {
+            uint32_t fallback = transitions_[fail[state] * classCount_ + cls];
+            if (trie[state][cls] > 0) {
+                uint32_t next = static_cast<uint32_t>(trie[state][cls]);
+                fail[next] = fallback;
+                transitions_[state * classCount_ + cls] = next;
+                pending.push(next);
+            } else {
+                transitions_[state * classCount_ + cls] = fallback;
+            }
+        }
+    }
+
+    for (size_t b = 0; b < 256; ++b) {
+        firstByte_[b] = byteClass_[b] != 0 && transitions_[byteClass_[b]] != 0;
+    }
+
+    for (const auto& rule : rules_) {
+        PrefixNeedle prefix{};
+        prefix.length = static_cast<uint8_t>(std::min<size_t>(rule.pattern.size(), prefix.bytes.size()));
+        for (size_t i = 0; i < prefix.length; ++i) {
+            prefix.bytes[i] = static_cast<uint8_t>(rule.pattern[i]) | 0x20;
+        }
+
+        // 已有的更短前缀或相同前缀能覆盖这一条时无需重复检查
+        bool covered = std::any_of(prefixes_.begin(), prefixes_.end(), [&](const PrefixNeedle& other) {
+            return other.length <= prefix.length &&
+                   std::equal(other.bytes.begin(), other.bytes.begin() + other.length, prefix.bytes.begin());
+        });
+        if (!covered) {
+            prefixes_.push_back(prefix);
+        }
+    }
+}
+
+size_t RedactionMatcher::redact(std::string& text) const {
+    std::vector<MaskRange> ranges;
+    findRanges(text, ranges, false);
+
+    size_t masked = 0;
+    for (const auto& range : ranges) {
+        size_t end = range.end;
+
+        if (range.keepLastDigits) {
+            // 从末尾向前跳过需要保留的数字
+            size_t kept = 0;
+            while (end > range.begin && kept < CARD_KEEP_DIGITS) {
+                if (isDigit(text[--end])) {
+                    kept++;
+                }
+            }
+        }
+
+        for (size_t i = range.begin; i < end; ++i) {
+            if (text[i] != MASK_CHAR && (!range.keepLastDigits || isDigit(text[i]))) {
+                text[i] = MASK_CHAR;
+                masked++;
+            }
+        }
+    }
+
+    return masked;
+}
+
+bool RedactionMatcher::matches(const std::string& text) const {
+    std::vector<MaskRange> ranges;
+    findRanges(text, ranges, true);
+    return !ranges.empty();
+}
+
+size_t RedactionMatcher::getRuleCount() const {
+    return rules_.size();
+}
+
+size_t RedactionMatcher::getStateCount() const {
+    return outputs_.size();
+}
+
+void RedactionMatcher::findRanges(const std::string& text, std::vector<MaskRange>& ranges,
+                                  bool stopAtFirst) const {
+    const char* data = text.data();
+    const size_t size = text.size();
+
+    if (!rules_.empty()) {
+        uint32_t state = 0;
+        size_t pos = 0;
+
+        while (pos < size) {
+            // 在根状态时，不能开始任何规则的字节都可以直接跳过
+            if (state == 0) {
+                pos = nextCandidate(data, pos, size);
+                if (pos >= size) {
+                    break;
+                }
+            }
+
+            state = transitions_[state * classCount_ + byteClass_[static_cast<uint8_t>(data[pos])]];
+            pos++;
+
+            for (uint32_t ruleIndex : outputs_[state]) {
+                const RedactionRule& rule = rules_[ruleIndex];
+
+                if (rule.kind == RedactionRule::Kind::LITERAL) {
+                    ranges.push_back({pos - rule.pattern.size(), pos, false});
+                } else {
+                    size_t begin = pos;
+                    while (begin < size && data[begin] == ' ') {
+                        begin++;
+                    }
+                    size_t end = begin;
+                    while (end < size && !isValueTerminator(data[end])) {
+                        end++;
+                    }
+                    if (end == begin) {
+                        continue;
+                    }
+                    ranges.push_back({begin, end, false});
+                }
+
+                if (stopAtFirst) {
+                    return;
+                }
+            }
+        }
+    }
+
+    if (detectCardNumbers_) {
+        findCardNumbers(text, ranges, stopAtFirst);
+    }
+}
+
+size_t RedactionMatcher::nextCandidate(const char* data, size_t pos, size_t size) const {
+#if defined(ASYNC_LOG_HAS_SSE2)
+    // 逐16字节把每个位置起的3个字节与所有前缀并行比较；前缀太多时比较次数超过查表，退回标量实现
+    const size_t prefixCount = prefixes_.size();
+    if (prefixCount > 0 && prefixCount <= MAX_SIMD_PREFIXES) {
+        __m128i needles[MAX_SIMD_PREFIXES][3];
+        for (size_t i = 0; i < prefixCount; ++i) {
+            for (size_t j = 0; j < prefixes_[i].length; ++j) {
+                needles[i][j] = _mm_set1_epi8(static_cast<char>(prefixes_[i].bytes[j]));
+            }
+        }
+
+        const __m128i fold = _mm_set1_epi8(0x20);
+        while (pos + 18 <= size) {
+            __m128i at0 = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos)), fold);
+            __m128i at1 = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + 1)), fold);
+            __m128i at2 = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + 2)), fold);
+
+            __m128i hits = _mm_setzero_si128();
+            for (size_t i = 0; i < prefixCount; ++i) {
+                __m128i hit = _mm_cmpeq_epi8(at0, needles[i][0]);
+                if (prefixes_[i].length > 1) {
+                    hit = _mm_and_si128(hit, _mm_cmpeq_epi8(at1, needles[i][1]));
+                }
+                if (prefixes_[i].length > 2) {
+                    hit = _mm_and_si128(hit, _mm_cmpeq_epi8(at2, needles[i][2]));
+                }
+                hits = _mm_or_si128(hits, hit);
+            }
+
+            int mask = _mm_movemask_epi8(hits);
+            if (mask != 0) {
+                return pos + lowestBit(mask);
+            }
+            pos += 16;
+        }
+    }
+#endif
+
+    while (pos < size && !firstByte_[static_cast<uint8_t>(data[pos])]) {
+        pos++;
+    }
+    return pos;
+}
+
+size_t RedactionMatcher::nextDigit(const char* data, size_t pos, size_t size) {
+#if defined(ASYNC_LOG_HAS_SSE2)
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i nine = _mm_set1_epi8(9);
+
+    while (pos + 16 <= size) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        // (c - '0') 按无符号饱和减去9后为0，当且仅当c是数字
+        __m128i offset = _mm_subs_epu8(_mm_sub_epi8(block, zero), nine);
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(offset, _mm_setzero_si128()));
+        if (mask != 0) {
+            return pos + lowestBit(mask);
+        }
+        pos += 16;
+    }
+#endif
+
+    while (pos < size && !isDigit(data[pos])) {
+        pos++;
+    }
+    return pos;
+}
+
+void RedactionMatcher::findCardNumbers(const std::string& text, std::vector<MaskRange>& ranges,
+                                       bool stopAtFirst) const {
+    const char* data = text.data();
+    const size_t size = text.size();
+    uint8_t digits[CARD_MAX_DIGITS + 1];
+    size_t pos = 0;
+
+    while ((pos = nextDigit(data, pos, size)) < size) {
+        // 数字串必须从单词边界开始，避免命中更长标识符中的一段
+        if (pos > 0 && isAlnum(data[pos - 1])) {
+            while (pos < size && isAlnum(data[pos])) {
+                pos++;
+            }
+            continue;
+        }
+
+        size_t count = 0;
+        size_t begin = pos;
+        size_t end = pos;
+        while (end < size && count <= CARD_MAX_DIGITS) {
+            if (isDigit(data[end])) {
+                digits[count++] = static_cast<uint8_t>(data[end] - '0');
+                end++;
+            } else if ((data[end] == ' ' || data[end] == '-') && end + 1 < size && isDigit(data[end + 1])) {
+                end++; // 组间分隔符
+            } else {
+                break;
+            }
+        }
+
+        bool boundary = end >= size || !isAlnum(data[end]);
+        if (boundary && count >= CARD_MIN_DIGITS && count <= CARD_MAX_DIGITS && passesLuhn(digits, count)) {
+            ranges.push_back({begin, end, true});
+            if (stopAtFirst) {
+                return;
+            }
+        }
+
+        pos = end;
+    }
+}
+
+bool RedactionMatcher::isValueTerminator(char c) {
+    switch (c) {
+        case ' ': case '\t': case '\r': case '\n':
+        case ',': case ';': case '&': case '"': case '\'':
+        case ')': case ']': case '}': case '<': case '>':
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace async_log
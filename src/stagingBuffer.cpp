@@ -0,0 +1,57 @@
+/**
+ * @file stagingBuffer.cpp
+ * @brief 线程局部暂存缓冲区实现
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 实现暂存缓冲区的计数、超时判断与回收标记
+ * @see stagingBuffer.hpp
+ * @since 1.1.0
+ */
+
+#include "stagingBuffer.hpp"
+
+namespace async_log {
+
+StagingBuffer::StagingBuffer() : count_(0), bytes_(0), retired_(false) {
+}
+
+std::mutex& StagingBuffer::getMutex() {
+    return mutex_;
+}
+
+LogMessage& StagingBuffer::at(size_t index) {
+    return slots_[index];
+}
+
+size_t StagingBuffer::size() const {
+    return count_;
+}
+
+size_t StagingBuffer::getBytes() const {
+    return bytes_;
+}
+
+bool StagingBuffer::isDue(std::chrono::system_clock::time_point now, std::chrono::microseconds maxDelay) const {
+    if (count_ == 0) {
+        return false;
+    }
+
+    auto age = now - slots_[0].timestamp;
+    return age < std::chrono::system_clock::duration::zero() || age >= maxDelay;
+}
+
+void StagingBuffer::clear() {
+    count_ = 0;
+    bytes_ = 0;
+}
+
+void StagingBuffer::retire() {
+    retired_ = true;
+}
+
+bool StagingBuffer::isRetired() const {
+    return retired_;
+}
+
+} // namespace async_log
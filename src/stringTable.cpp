@@ -0,0 +1,112 @@
+/**
+ * @file stringTable.cpp
+ * @brief 字符串驻留表实现
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 实现分块存储的字符串驻留表
+ * @see stringTable.hpp
+ * @since 1.1.0
+ */
+
+#include "stringTable.hpp"
+#include <mutex>
+
+namespace async_log {
+
+namespace {
+    const std::string emptyString;
+}
+
+StringTable& StringTable::getInstance() {
+    // 有意泄漏：日志管理器析构时工作线程仍可能解析ID，驻留表必须比它活得更久
+    static StringTable* instance = new StringTable();
+    return *instance;
+}
+
+StringTable::StringTable() : nextId_(1) {
+    for (auto& chunk : chunks_) {
+        chunk.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+StringTable::~StringTable() {
+    for (auto& chunk : chunks_) {
+        delete[] chunk.load(std::memory_order_relaxed);
+    }
+}
+
+StringId StringTable::intern(std::string_view text) {
+    if (text.empty()) {
+        return 0;
+    }
+
+    {
+        std::shared_lock<std::shared_mutex> lock(indexMutex_);
+        auto it = index_.find(text);
+        if (it != index_.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(indexMutex_);
+
+    // 获取写锁期间可能已被其他线程插入
+    auto it = index_.find(text);
+    if (it != index_.end()) {
+        return it->second;
+    }
+
+    StringId id = nextId_.load(std::memory_order_relaxed);
+    size_t chunkIndex = id / CHUNK_SIZE;
+    if (chunkIndex >= MAX_CHUNKS) {
+        return 0;
+    }
+
+    std::string* chunk = chunks_[chunkIndex].load(std::memory_order_relaxed);
+    if (!chunk) {
+        chunk = new std::string[CHUNK_SIZE];
+        chunks_[chunkIndex].store(chunk, std::memory_order_release);
+    }
+
+    std::string& slot = chunk[id % CHUNK_SIZE];
+    slot.assign(text.data(), text.size());
+    index_.emplace(std::string_view(slot), id);
+
+    // 发布ID：解析方通过日志队列获得ID，队列的同步保证能看到上面写入的字符串
+    nextId_.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+StringId StringTable::find(std::string_view text) const {
+    if (text.empty()) {
+        return 0;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(indexMutex_);
+    auto it = index_.find(text);
+    return it != index_.end() ? it->second : 0;
+}
+
+const std::string& StringTable::resolve(StringId id) const {
+    if (id == 0 || id >= nextId_.load(std::memory_order_acquire)) {
+        return emptyString;
+    }
+
+    const std::string* chunk = chunks_[id / CHUNK_SIZE].load(std::memory_order_acquire);
+    return chunk ? chunk[id % CHUNK_SIZE] : emptyString;
+}
+
+size_t StringTable::size() const {
+    return nextId_.load(std::memory_order_acquire) - 1;
+}
+
+void StringTable::lockForFork() {
+    indexMutex_.lock();
+}
+
+void StringTable::unlockAfterFork() {
+    indexMutex_.unlock();
+}
+
+} // namespace async_log
@@ -0,0 +1,313 @@
+/**
+ * @file formatPipelineTest.cpp
+ * @brief 并行格式化流水线测试
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 经过装饰器的输出在开启和关闭格式化线程时都应按分发顺序写出全部消息
+ * @since 1.1.0
+ */
+
+#include "logDecorator.hpp"
+#include "formatPipeline.hpp"
+#include "logDispatcher.hpp"
+#include "memoryBudget.hpp"
+#include "testSupport.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace async_log;
+
+namespace {
+
+/**
+ * @brief 记录写出内容的输出
+ * @since 1.1.0
+ */
+class CaptureOutput : public ILogOutput {
+public:
+    struct State {
+        std::mutex mutex;
+        std::vector<std::string> lines;
+    };
+
+    explicit CaptureOutput(std::shared_ptr<State> state) : state_(std::move(state)) {
+    }
+
+    void write(const LogMessage& msg) override {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->lines.push_back(msg.getMessage());
+    }
+
+    bool format(const LogMessage& msg, std::pmr::string& out) const override {
+        out.assign(msg.getMessage());
+        out.push_back('\n');
+        return true;
+    }
+
+    void writeFormatted(const std::pmr::string& text) override {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        size_t begin = 0;
+        while (begin < text.size()) {
+            size_t end = text.find('\n', begin);
+            state_->lines.emplace_back(text.substr(begin, end - begin));
+            begin = end + 1;
+        }
+    }
+
+    void flush() override {
+    }
+
+    void close() override {
+    }
+
+    bool isAvailable() const override {
+        return true;
+    }
+
+private:
+    std::shared_ptr<State> state_;
+};
+
+void runDecorated(size_t formatThreads) {
+    const int count = 500;
+    auto state = std::make_shared<CaptureOutput::State>();
+
+    LogDispatcher dispatcher;
+    dispatcher.setRepeatWindow(std::chrono::milliseconds(0));
+    dispatcher.addOutput(std::make_unique<TimestampDecorator>(std::make_unique<CaptureOutput>(state)));
+    dispatcher.setFormatThreads(formatThreads);
+
+    for (int i = 0; i < count; ++i) {
+        dispatcher.dispatch(LogMessage(LogLevel::INFO, "line " + std::to_string(i)));
+        if (i % 64 == 63) {
+            dispatcher.submitBatch();
+        }
+    }
+    dispatcher.flush();
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    TEST_CHECK(state->lines.size() == static_cast<size_t>(count));
+    for (size_t i = 0; i < state->lines.size(); ++i) {
+        const std::string& line = state->lines[i];
+        std::string suffix = "] line " + std::to_string(i);
+        TEST_CHECK(!line.empty() && line[0] == '[');
+        TEST_CHECK(line.size() >= suffix.size() &&
+                   line.compare(line.size() - suffix.size(), suffix.size(), suffix) == 0);
+    }
+}
+
+/**
+ * @brief 格式化期间阻塞直到被放行的输出
+ * @details format()进入后通知测试线程，再等待放行；等待超时说明分发线程在格式化期间无法推进
+ */
+class GateOutput : public ILogOutput {
+public:
+    struct State {
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool entered = false;
+        bool released = false;
+        bool timedOut = false;
+        size_t written = 0;
+    };
+
+    explicit GateOutput(std::shared_ptr<State> state) : state_(std::move(state)) {
+    }
+
+    void write(const LogMessage&) override {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->written++;
+    }
+
+    bool format(const LogMessage& msg, std::pmr::string& out) const override {
+        std::unique_lock<std::mutex> lock(state_->mutex);
+        state_->entered = true;
+        state_->condition.notify_all();
+        if (!state_->condition.wait_for(lock, std::chrono::seconds(5), [this] { return state_->released; })) {
+            state_->timedOut = true;
+        }
+        out.assign(msg.getMessage());
+        out.push_back('\n');
+        return true;
+    }
+
+    void writeFormatted(const std::pmr::string& text) override {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->written += static_cast<size_t>(std::count(text.begin(), text.end(), '\n'));
+    }
+
+    void flush() override {
+    }
+
+    void close() override {
+    }
+
+    bool isAvailable() const override {
+        return true;
+    }
+
+private:
+    std::shared_ptr<State> state_;
+};
+
+/**
+ * @brief 格式化线程工作时，分发线程仍能为新消息路由并加入下一个批次
+ */
+void testRoutingDuringFormatting() {
+    auto state = std::make_shared<GateOutput::State>();
+
+    LogDispatcher dispatcher;
+    dispatcher.setRepeatWindow(std::chrono::milliseconds(0));
+    dispatcher.addOutput(std::make_unique<GateOutput>(state));
+    dispatcher.setFormatThreads(2);
+
+    dispatcher.dispatch(LogMessage(LogLevel::INFO, "first"));
+    dispatcher.submitBatch();
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->condition.wait(lock, [&] { return state->entered; });
+    }
+
+    // 格式化线程正共享持有输出列表锁，路由不能因此等待
+    dispatcher.dispatch(LogMessage(LogLevel::INFO, "second"));
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->released = true;
+    }
+    state->condition.notify_all();
+    dispatcher.flush();
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    TEST_CHECK(!state->timedOut);
+    TEST_CHECK(state->written == 2);
+}
+
+/**
+ * @brief 复制进批次的消息与格式化文本在写出前一直登记在内存预算中
+ */
+void testBatchesStayCharged() {
+    auto state = std::make_shared<GateOutput::State>();
+    MemoryBudget budget;
+
+    LogDispatcher dispatcher;
+    dispatcher.setRepeatWindow(std::chrono::milliseconds(0));
+    dispatcher.setMemoryBudget(&budget);
+    dispatcher.addOutput(std::make_unique<GateOutput>(state));
+    dispatcher.setFormatThreads(1);
+
+    dispatcher.dispatch(LogMessage(LogLevel::INFO, "charged until written"));
+    dispatcher.submitBatch();
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->condition.wait(lock, [&] { return state->entered; });
+    }
+    TEST_CHECK(budget.getUsage() >= sizeof(LogMessage));
+
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->released = true;
+    }
+    state->condition.notify_all();
+    dispatcher.flush();
+
+    TEST_CHECK(budget.getUsage() == 0);
+    TEST_CHECK(budget.getPeakUsage() >= sizeof(LogMessage) + std::string("charged until written\n").size());
+}
+
+/**
+ * @brief 格式化阶段中途抛出异常时，已写了一部分的文本被丢弃，所有输出改为逐条写出
+ */
+void testFailedFormatFallsBack() {
+    std::vector<uint8_t> fallback;
+    std::vector<std::string> texts;
+
+    FormatPipeline pipeline(
+        [](FormatBatch& batch) {
+            batch.texts.resize(2);
+            batch.fallback.assign(2, 0);
+            batch.texts[0] = "partial\n";
+            throw std::runtime_error("format failed");
+        },
+        [&](FormatBatch& batch) {
+            fallback = batch.fallback;
+            texts.assign(batch.texts.begin(), batch.texts.end());
+        });
+    pipeline.setThreadCount(1);
+
+    TEST_CHECK(pipeline.append(LogMessage(LogLevel::INFO, "first"), {0}));
+    TEST_CHECK(pipeline.append(LogMessage(LogLevel::INFO, "second"), {0, 2}));
+    pipeline.drain();
+
+    TEST_CHECK(fallback.size() == 3);
+    TEST_CHECK(std::count(fallback.begin(), fallback.end(), 1) == 3);
+    TEST_CHECK(std::all_of(texts.begin(), texts.end(), [](const std::string& text) { return text.empty(); }));
+}
+
+/**
+ * @brief 统计分配次数的内存资源
+ */
+class CountingResource : public std::pmr::memory_resource {
+public:
+    std::atomic<size_t> allocations{0};
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        allocations++;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+/**
+ * @brief 批次的消息槽位和格式化文本从分发器设置的内存资源分配
+ */
+void testBatchesUseMemoryResource() {
+    auto state = std::make_shared<GateOutput::State>();
+    state->released = true;
+    CountingResource resource;
+
+    {
+        LogDispatcher dispatcher;
+        dispatcher.setRepeatWindow(std::chrono::milliseconds(0));
+        dispatcher.setMemoryResource(&resource);
+        dispatcher.addOutput(std::make_unique<GateOutput>(state));
+        dispatcher.setFormatThreads(1);
+
+        for (int i = 0; i < 8; ++i) {
+            dispatcher.dispatch(LogMessage(LogLevel::INFO, "a message long enough to leave the small string buffer"));
+        }
+        dispatcher.flush();
+    }
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    TEST_CHECK(state->written == 8);
+    TEST_CHECK(resource.allocations.load() > 0);
+}
+
+} // namespace
+
+int main() {
+    runDecorated(0);
+    runDecorated(2);
+    testRoutingDuringFormatting();
+    testBatchesStayCharged();
+    testFailedFormatFallsBack();
+    testBatchesUseMemoryResource();
+    return test::testResult();
+}
@@ -0,0 +1,184 @@
+/**
+ * @file lockFreeQueueTest.cpp
+ * @brief 消息队列算法测试
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 多个生产者并发入队、单个消费者出队，验证每种算法既不丢失也不重复元素，
+ *          且同一生产者的元素保持入队顺序。生产者入队失败时让出CPU后重试，单核环境下同样能推进
+ * @since 1.1.0
+ */
+
+#include "lockFreeQueue.hpp"
+#include "testSupport.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory_resource>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace async_log;
+
+namespace {
+
+/**
+ * @brief 测试元素：生产者编号与该生产者内的序号
+ */
+struct Item {
+    uint32_t producer = 0;
+    uint32_t sequence = 0;
+};
+
+/**
+ * @brief 多生产者入队测试的参数
+ */
+struct Scenario {
+    QueueAlgorithm algorithm;   ///< 队列算法
+    size_t capacity;            ///< 有界算法的槽位数量，分段算法每段的槽位数量
+    size_t producers;           ///< 生产者数量
+    size_t itemsPerProducer;    ///< 每个生产者入队的元素数量
+    size_t batchSize;           ///< 每次入队的元素数量，1表示逐个入队
+};
+
+/**
+ * @brief 生产者：按序号入队，队列已满时让出CPU后重试
+ */
+void produce(AnyQueue<Item>& queue, uint32_t producer, const Scenario& scenario) {
+    uint32_t next = 0;
+    const uint32_t total = static_cast<uint32_t>(scenario.itemsPerProducer);
+
+    while (next < total) {
+        if (scenario.batchSize > 1) {
+            size_t want = std::min<size_t>(scenario.batchSize, total - next);
+            size_t claimed = queue.emplaceBatch(want, [&](Item& item, size_t index, size_t) {
+                item.producer = producer;
+                item.sequence = next + static_cast<uint32_t>(index);
+            });
+            next += static_cast<uint32_t>(claimed);
+            if (claimed == 0) {
+                std::this_thread::yield();
+            }
+        } else if (queue.emplace([&](Item& item) { item.producer = producer; item.sequence = next; })) {
+            next++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+/**
+ * @brief 运行一个场景：消费者在当前线程出队，检查数量与每个生产者内的顺序
+ */
+void runScenario(const std::string& name, const Scenario& scenario) {
+    auto queue = makeQueue<Item>(scenario.algorithm, QueueWaitStrategy::NONE, scenario.capacity);
+    TEST_CHECK(queue->getAlgorithm() == scenario.algorithm);
+
+    std::vector<std::thread> producers;
+    for (size_t p = 0; p < scenario.producers; ++p) {
+        producers.emplace_back(produce, std::ref(*queue), static_cast<uint32_t>(p), std::cref(scenario));
+    }
+
+    const size_t total = scenario.producers * scenario.itemsPerProducer;
+    std::vector<uint32_t> expected(scenario.producers, 0);
+    std::pmr::vector<Item> batch;
+    size_t received = 0;
+    bool ordered = true;
+
+    while (received < total) {
+        if (queue->popBatch(batch, 64) == 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (const Item& item : batch) {
+            if (item.producer >= scenario.producers || item.sequence != expected[item.producer]) {
+                ordered = false;
+                break;
+            }
+            expected[item.producer]++;
+        }
+        if (!ordered) {
+            break;
+        }
+        received += batch.size();
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    Item extra;
+    bool drained = !queue->pop(extra);
+    if (!ordered || !drained) {
+        std::fprintf(stderr, "%s: ordered=%d drained=%d received=%zu\n", name.c_str(), ordered, drained, received);
+    }
+    TEST_CHECK(ordered);
+    TEST_CHECK(drained);
+    TEST_CHECK(received == total);
+}
+
+/**
+ * @brief 链表、有界多生产者多消费者与多生产者单消费者环形队列
+ * @details 有界算法使用很小的容量，生产者频繁遇到队列已满的路径
+ */
+void testRingAndLinkedQueues() {
+    runScenario("linked", {QueueAlgorithm::LINKED, 0, 4, 20000, 1});
+    runScenario("linked batch", {QueueAlgorithm::LINKED, 0, 4, 20000, 7});
+    runScenario("bounded mpmc", {QueueAlgorithm::BOUNDED_MPMC, 1024, 4, 20000, 1});
+    runScenario("bounded mpmc full", {QueueAlgorithm::BOUNDED_MPMC, 4, 4, 20000, 1});
+    runScenario("bounded mpmc full batch", {QueueAlgorithm::BOUNDED_MPMC, 8, 4, 20000, 3});
+    runScenario("mpsc ring", {QueueAlgorithm::MPSC_RING, 1024, 4, 20000, 1});
+    runScenario("mpsc ring full", {QueueAlgorithm::MPSC_RING, 4, 4, 20000, 1});
+    runScenario("mpsc ring full batch", {QueueAlgorithm::MPSC_RING, 8, 4, 20000, 3});
+}
+
+/**
+ * @brief 票号环形队列
+ * @details 容量远小于生产者数量，生产者在检查队列已满与领取票号之间被抢占时会放弃票号，
+ *          消费者需要跳过这些空洞；多核环境下这一交错经常发生，单核环境下较少出现
+ */
+void testTicketRingQueue() {
+    runScenario("ticket ring", {QueueAlgorithm::TICKET_RING, 1024, 4, 20000, 1});
+    runScenario("ticket ring full", {QueueAlgorithm::TICKET_RING, 2, 8, 10000, 1});
+    runScenario("ticket ring full batch", {QueueAlgorithm::TICKET_RING, 4, 8, 10000, 3});
+}
+
+/**
+ * @brief 分段队列
+ * @details 每段只有2个或4个槽位，段编号多次绕过段目录，消费者取空的段被回收后再分配给生产者；
+ *          批量入队的元素跨越多个段。占用的字节数随段的分配和释放变化
+ */
+void testSegmentedQueue() {
+    auto queue = makeQueue<Item>(QueueAlgorithm::SEGMENTED, QueueWaitStrategy::NONE, 3);
+    TEST_CHECK(queue->getSegmentSize() == 4);
+    TEST_CHECK(queue->getCapacity() == 0);
+    TEST_CHECK(queue->getItemOverhead() == 0);
+
+    // 占用随段的分配增长，取空后段放回池中或释放，不会继续增长
+    const size_t initial = queue->getFootprint();
+    for (uint32_t i = 0; i < 64; ++i) {
+        TEST_CHECK(queue->emplace([&](Item& item) { item.sequence = i; }));
+    }
+    const size_t grown = queue->getFootprint();
+    TEST_CHECK(grown > initial);
+    Item item;
+    while (queue->pop(item)) {
+    }
+    TEST_CHECK(queue->getFootprint() >= initial);
+    TEST_CHECK(queue->getFootprint() < grown);
+
+    runScenario("segmented", {QueueAlgorithm::SEGMENTED, 4096, 4, 20000, 1});
+    runScenario("segmented tiny", {QueueAlgorithm::SEGMENTED, 2, 4, 20000, 1});
+    runScenario("segmented tiny batch", {QueueAlgorithm::SEGMENTED, 4, 4, 20000, 7});
+}
+
+} // namespace
+
+int main() {
+    testRingAndLinkedQueues();
+    testTicketRingQueue();
+    testSegmentedQueue();
+    return test::testResult();
+}
@@ -0,0 +1,433 @@
+/**
+ * @file logManagerTest.cpp
+ * @brief 日志管理器测试
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 使用独立的LogManager实例验证配置、消费与刷新的行为，不依赖全局单例
+ * @since 1.1.0
+ */
+
+#include "logManager.hpp"
+#include "testSupport.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace async_log;
+
+namespace {
+
+/**
+ * @brief 记录收到的消息文本的输出
+ */
+class CaptureOutput : public ILogOutput {
+public:
+    struct State {
+        std::mutex mutex;
+        std::vector<std::string> messages;
+    };
+
+    explicit CaptureOutput(std::shared_ptr<State> state) : state_(std::move(state)) {
+    }
+
+    void write(const LogMessage& msg) override {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->messages.push_back(msg.getMessage());
+    }
+
+    void flush() override {
+    }
+
+    void close() override {
+    }
+
+    bool isAvailable() const override {
+        return true;
+    }
+
+private:
+    std::shared_ptr<State> state_;
+};
+
+/**
+ * @brief 每写一条消息就调用所属管理器flush()的输出，模拟在输出内部刷新
+ */
+class FlushingOutput : public CaptureOutput {
+public:
+    FlushingOutput(LogManager& manager, std::shared_ptr<State> state)
+        : CaptureOutput(std::move(state)), manager_(manager) {
+    }
+
+    void write(const LogMessage& msg) override {
+        CaptureOutput::write(msg);
+        manager_.flush();
+    }
+
+private:
+    LogManager& manager_;
+};
+
+/**
+ * @brief 每写一条消息都稍作停顿的输出，让工作线程收尾需要一段时间
+ */
+class SlowOutput : public CaptureOutput {
+public:
+    using CaptureOutput::CaptureOutput;
+
+    void write(const LogMessage& msg) override {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        CaptureOutput::write(msg);
+    }
+};
+
+/**
+ * @brief 过滤表达式编译失败时报告错误不能持有configMutex_
+ * @details ERROR同步写出时，调用线程需要消费者锁，而工作线程持有消费者锁时会获取configMutex_
+ */
+void testInvalidFilterDoesNotDeadlock() {
+    LogManager manager;
+    manager.removeOutput(0);
+    manager.start();
+
+    LogConfig config;
+    config.syncWriteLevel = LogLevel::ERROR;
+    config.callSiteReportIntervalMs = 1;
+    config.filterExpression = "level >= (";
+
+    // 持续写入让工作线程频繁持有消费者锁执行周期性任务
+    std::atomic<bool> done(false);
+    std::thread producer([&] {
+        while (!done.load()) {
+            manager.log(LogLevel::INFO, "background");
+        }
+    });
+
+    for (int i = 0; i < 20000; ++i) {
+        manager.setConfig(config);
+    }
+    done.store(true);
+    producer.join();
+
+    TEST_CHECK(manager.getConfig().filterExpression == "level >= (");
+    manager.stop();
+}
+
+/**
+ * @brief 手动驱动模式下默认参数的poll()和flush()处理完全部消息
+ */
+void testManualDrainProcessesEverything() {
+    LogConfig config;
+    config.manualDrain = true;
+    LogManager manager(config);
+    manager.removeOutput(0);
+    manager.start();
+
+    for (int i = 0; i < 1000; ++i) {
+        manager.log(LogLevel::INFO, "queued " + std::to_string(i));
+    }
+    TEST_CHECK(manager.poll() == 1000);
+    TEST_CHECK(manager.getQueueSize() == 0);
+
+    for (int i = 0; i < 1000; ++i) {
+        manager.log(LogLevel::INFO, "flushed " + std::to_string(i));
+    }
+    manager.flush();
+    TEST_CHECK(manager.getQueueSize() == 0);
+    TEST_CHECK(manager.poll() == 0);
+
+    manager.stop();
+}
+
+/**
+ * @brief addOutput添加的输出本身接收消息，输出数量与下标在增删后保持一致
+ */
+void testAddedOutputReceivesMessages() {
+    LogManager manager;
+    TEST_CHECK(manager.getOutputCount() == 1);
+    manager.removeOutput(0);
+    TEST_CHECK(manager.getOutputCount() == 0);
+
+    auto first = std::make_shared<CaptureOutput::State>();
+    auto second = std::make_shared<CaptureOutput::State>();
+    manager.addOutput(std::make_unique<CaptureOutput>(first));
+    manager.addOutput(std::make_unique<CaptureOutput>(second));
+    TEST_CHECK(manager.getOutputCount() == 2);
+    manager.start();
+
+    manager.log(LogLevel::INFO, "both");
+    manager.flush();
+
+    TEST_CHECK(manager.removeOutput(0));
+    TEST_CHECK(!manager.removeOutput(1));
+    TEST_CHECK(manager.getOutputCount() == 1);
+
+    manager.log(LogLevel::INFO, "second only");
+    manager.flush();
+    manager.stop();
+
+    TEST_CHECK(first->messages == std::vector<std::string>{"both"});
+    TEST_CHECK((second->messages == std::vector<std::string>{"both", "second only"}));
+}
+
+/**
+ * @brief 短生命周期的实例析构后，长期线程中的线程局部条目不会随实例数量增长
+ * @details 条目不可直接观测，这里验证反复创建实例时错误回溯与暂存缓冲区仍各自独立且正常工作
+ */
+void testShortLivedInstancesStayIndependent() {
+    LogConfig config;
+    config.manualDrain = true;
+    config.stagingBatchSize = 4;
+    config.errorBacklogSize = 8;
+    config.errorBacklogLevel = LogLevel::DEBUG;
+
+    for (int i = 0; i < 200; ++i) {
+        LogManager manager(config);
+        manager.removeOutput(0);
+        auto state = std::make_shared<CaptureOutput::State>();
+        manager.addOutput(std::make_unique<CaptureOutput>(state));
+        manager.start();
+
+        TEST_CHECK(manager.getErrorBacklogSize() == 0);
+        manager.log(LogLevel::DEBUG, "held");
+        TEST_CHECK(manager.getErrorBacklogSize() == 1);
+        manager.clearErrorBacklog();
+
+        manager.log(LogLevel::INFO, "staged " + std::to_string(i));
+        manager.flush();
+        manager.stop();
+        TEST_CHECK(state->messages == std::vector<std::string>{"staged " + std::to_string(i)});
+    }
+}
+
+/**
+ * @brief 消费者线程在输出内部调用flush()时直接刷新，不再嵌套消费或等待工作线程
+ * @details 覆盖手动驱动模式的poll()和工作线程模式下调用线程的同步写出
+ */
+void testFlushFromOutputDoesNotDeadlock() {
+    {
+        LogConfig config;
+        config.manualDrain = true;
+        LogManager manager(config);
+        manager.removeOutput(0);
+        auto state = std::make_shared<CaptureOutput::State>();
+        manager.addOutput(std::make_unique<FlushingOutput>(manager, state));
+        manager.start();
+
+        for (int i = 0; i < 10; ++i) {
+            manager.log(LogLevel::INFO, "polled " + std::to_string(i));
+        }
+        TEST_CHECK(manager.poll() == 10);
+        manager.stop();
+        TEST_CHECK(state->messages.size() == 10);
+    }
+
+    {
+        LogConfig config;
+        config.syncWriteLevel = LogLevel::ERROR;
+        LogManager manager(config);
+        manager.removeOutput(0);
+        auto state = std::make_shared<CaptureOutput::State>();
+        manager.addOutput(std::make_unique<FlushingOutput>(manager, state));
+        manager.start();
+
+        for (int i = 0; i < 10; ++i) {
+            manager.log(LogLevel::INFO, "queued " + std::to_string(i));
+            manager.log(LogLevel::ERROR, "synchronous " + std::to_string(i));
+        }
+        manager.flush();
+        manager.stop();
+        TEST_CHECK(state->messages.size() == 20);
+    }
+}
+
+/**
+ * @brief 降级需要过载持续degradeSustainMs，启动后与重新配置后的首次评估都不会立即降级
+ */
+void testDegradationWaitsForSustainedPressure() {
+    LogConfig config;
+    config.manualDrain = true;
+    config.degradeQueueDepth = 10;
+    config.degradeSustainMs = 5000;
+
+    LogManager manager(config);
+    manager.removeOutput(0);
+    manager.start();
+    for (int i = 0; i < 100; ++i) {
+        manager.log(LogLevel::INFO, "pressure " + std::to_string(i));
+    }
+
+    // 评估每10毫秒最多一次，先越过启动时的节流间隔
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    manager.poll(1);
+    TEST_CHECK(manager.getEffectiveMinLevel() == LogLevel::DEBUG);
+
+    // 新配置同样从现在重新计时
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    manager.setConfig(config);
+    manager.poll(1);
+    TEST_CHECK(manager.getEffectiveMinLevel() == LogLevel::DEBUG);
+    manager.stop();
+
+    // 持续时间为0时同样的压力立即降级
+    config.degradeSustainMs = 0;
+    LogManager immediate(config);
+    immediate.removeOutput(0);
+    immediate.start();
+    for (int i = 0; i < 100; ++i) {
+        immediate.log(LogLevel::INFO, "pressure " + std::to_string(i));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    immediate.poll(1);
+    TEST_CHECK(immediate.getEffectiveMinLevel() == LogLevel::INFO);
+    immediate.stop();
+}
+
+/**
+ * @brief 线程局部暂存的消息全部发布，同一线程的消息保持顺序
+ * @details 每个线程的消息数量不是批大小的整数倍，线程退出时剩余的暂存由工作线程代为发布；
+ *          仍存活但空闲的线程的暂存在超过stagingMaxDelayUs后同样由工作线程发布
+ */
+void testStagedMessagesArePublished() {
+    LogConfig config;
+    config.stagingBatchSize = 16;
+    config.stagingMaxDelayUs = 1000;
+    LogManager manager(config);
+    manager.removeOutput(0);
+    auto state = std::make_shared<CaptureOutput::State>();
+    manager.addOutput(std::make_unique<CaptureOutput>(state));
+    manager.start();
+
+    const int threads = 4;
+    const int perThread = 1000;
+    std::vector<std::thread> producers;
+    for (int t = 0; t < threads; ++t) {
+        producers.emplace_back([&manager, t] {
+            for (int i = 0; i < perThread; ++i) {
+                manager.log(LogLevel::INFO, std::to_string(t) + " " + std::to_string(i));
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    manager.flush();
+
+    std::vector<int> expected(threads, 0);
+    bool ordered = true;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        for (const auto& message : state->messages) {
+            size_t space = message.find(' ');
+            int t = std::stoi(message.substr(0, space));
+            int i = std::stoi(message.substr(space + 1));
+            ordered = ordered && t >= 0 && t < threads && i == expected[t];
+            if (t >= 0 && t < threads) {
+                expected[t]++;
+            }
+        }
+        TEST_CHECK(ordered);
+        TEST_CHECK(state->messages.size() == static_cast<size_t>(threads * perThread));
+    }
+
+    // 不调用flush()，空闲线程的暂存也会被发布
+    std::atomic<bool> release(false);
+    std::thread idle([&] {
+        manager.log(LogLevel::INFO, "idle 0");
+        manager.log(LogLevel::INFO, "idle 1");
+        while (!release.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    bool published = false;
+    for (int attempt = 0; attempt < 500 && !published; ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        std::lock_guard<std::mutex> lock(state->mutex);
+        published = state->messages.size() == static_cast<size_t>(threads * perThread + 2);
+    }
+    release.store(true);
+    idle.join();
+    TEST_CHECK(published);
+
+    manager.stop();
+}
+
+/**
+ * @brief stop()清除运行标志后、工作线程写完剩余消息前调用的flush()，要等剩余消息写完才返回
+ */
+void testFlushDuringStopWaitsForWorker() {
+    LogManager manager;
+    manager.removeOutput(0);
+    auto state = std::make_shared<CaptureOutput::State>();
+    manager.addOutput(std::make_unique<SlowOutput>(state));
+    manager.start();
+
+    const size_t total = 200;
+    for (size_t i = 0; i < total; ++i) {
+        manager.log(LogLevel::INFO, "slow");
+    }
+
+    std::thread stopper([&] { manager.stop(); });
+    while (manager.isRunning()) {
+        std::this_thread::yield();
+    }
+    manager.flush();
+
+    size_t written = 0;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        written = state->messages.size();
+    }
+    stopper.join();
+    TEST_CHECK(written == total);
+}
+
+/**
+ * @brief 消息槽位数组单独就超出内存上限时保留原有队列，并记录错误
+ */
+void testOversizedRingIsRejected() {
+    LogManager manager;
+    manager.removeOutput(0);
+    auto state = std::make_shared<CaptureOutput::State>();
+    manager.addOutput(std::make_unique<CaptureOutput>(state));
+
+    LogConfig config = manager.getConfig();
+    config.recycledSlotCount = 1024;
+    config.maxMemoryBytes = 4096;
+    manager.setConfig(config);
+    // 原有的链表队列没有预分配的部分，新上限照常生效
+    TEST_CHECK(manager.getMemoryLimit() == 4096);
+    TEST_CHECK(manager.getMemoryUsage() < 4096);
+
+    manager.start();
+    manager.log(LogLevel::INFO, "still accepted");
+    manager.flush();
+    manager.stop();
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    bool reported = false;
+    for (const auto& message : state->messages) {
+        reported = reported || message.find("超出内存上限4096字节") != std::string::npos;
+    }
+    TEST_CHECK(reported);
+    TEST_CHECK(!state->messages.empty() && state->messages.back() == "still accepted");
+}
+
+} // namespace
+
+int main() {
+    testInvalidFilterDoesNotDeadlock();
+    testManualDrainProcessesEverything();
+    testAddedOutputReceivesMessages();
+    testShortLivedInstancesStayIndependent();
+    testFlushFromOutputDoesNotDeadlock();
+    testDegradationWaitsForSustainedPressure();
+    testStagedMessagesArePublished();
+    testFlushDuringStopWaitsForWorker();
+    testOversizedRingIsRejected();
+    return test::testResult();
+}
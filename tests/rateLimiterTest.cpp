@@ -0,0 +1,115 @@
+/**
+ * @file rateLimiterTest.cpp
+ * @brief 限流与采样测试
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 验证限流策略的抑制计数，以及调用点不再放行时汇总行由工作线程代为输出。
+ *          限流宏只使用全局实例，测试在全局实例上挂接记录输出
+ * @since 1.1.0
+ */
+
+#include "logManager.hpp"
+#include "testSupport.hpp"
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace async_log;
+
+namespace {
+
+/**
+ * @brief 记录收到的消息文本的输出
+ */
+class CaptureOutput : public ILogOutput {
+public:
+    struct State {
+        std::mutex mutex;
+        std::vector<std::string> messages;
+    };
+
+    explicit CaptureOutput(std::shared_ptr<State> state) : state_(std::move(state)) {
+    }
+
+    void write(const LogMessage& msg) override {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->messages.push_back(msg.getMessage());
+    }
+
+    void flush() override {
+    }
+
+    void close() override {
+    }
+
+    bool isAvailable() const override {
+        return true;
+    }
+
+private:
+    std::shared_ptr<State> state_;
+};
+
+/**
+ * @brief 按N取一采样不输出汇总行，也不累计抑制数量
+ */
+void testSamplerDoesNotCountSuppressed() {
+    EveryNSampler sampler(4);
+    int allowed = 0;
+    for (int i = 0; i < 100; ++i) {
+        allowed += sampler.allow() ? 1 : 0;
+    }
+    TEST_CHECK(allowed == 25);
+    TEST_CHECK(sampler.takeSuppressed() == 0);
+
+    FirstNPerIntervalLimiter limiter(2, std::chrono::minutes(1));
+    for (int i = 0; i < 10; ++i) {
+        limiter.allow();
+    }
+    TEST_CHECK(limiter.takeSuppressed() == 8);
+    TEST_CHECK(limiter.takeSuppressed() == 0);
+}
+
+/**
+ * @brief 调用点在一次突发后不再放行，汇总行仍会由工作线程输出
+ */
+void testQuietCallSiteIsSummarised() {
+    LogManager& manager = LogManager::getInstance();
+    manager.removeOutput(0);
+    auto state = std::make_shared<CaptureOutput::State>();
+    manager.addOutput(std::make_unique<CaptureOutput>(state));
+    manager.start();
+
+    for (int i = 0; i < 10; ++i) {
+        LOG_FIRST_N(INFO, 1, 60000, "burst");
+    }
+
+    // 工作线程每秒最多代为输出一次，flush()唤醒工作线程执行周期性任务
+    const std::string summary = "[限流] 此调用点已抑制 9 条日志";
+    bool found = false;
+    for (int attempt = 0; attempt < 50 && !found; ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        manager.flush();
+        std::lock_guard<std::mutex> lock(state->mutex);
+        for (const auto& message : state->messages) {
+            found = found || message == summary;
+        }
+    }
+    TEST_CHECK(found);
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    TEST_CHECK(!state->messages.empty() && state->messages.front() == "burst");
+}
+
+} // namespace
+
+int main() {
+    testSamplerDoesNotCountSuppressed();
+    testQuietCallSiteIsSummarised();
+    LogManager::destroyInstance();
+    return test::testResult();
+}
@@ -0,0 +1,127 @@
+/**
+ * @file redactionTest.cpp
+ * @brief 打码装饰器测试
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 验证消息内容与诊断上下文在逐条写出和格式化两条路径上都会被打码
+ * @since 1.1.0
+ */
+
+#include "logDecorator.hpp"
+#include "logContext.hpp"
+#include "testSupport.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace async_log;
+
+namespace {
+
+/**
+ * @brief 记录"消息 上下文"形式文本的输出
+ */
+class CaptureOutput : public ILogOutput {
+public:
+    explicit CaptureOutput(std::vector<std::string>& lines) : lines_(lines) {
+    }
+
+    void write(const LogMessage& msg) override {
+        lines_.push_back(msg.getMessage() + ' ' + LogContext::toString(msg.context));
+    }
+
+    bool format(const LogMessage& msg, std::pmr::string& out) const override {
+        out.assign(msg.getMessage());
+        out += ' ';
+        LogContext::format(msg.context, out);
+        return true;
+    }
+
+    void flush() override {
+    }
+
+    void close() override {
+    }
+
+    bool isAvailable() const override {
+        return true;
+    }
+
+private:
+    std::vector<std::string>& lines_;
+};
+
+std::shared_ptr<const RedactionMatcher> makeMatcher() {
+    std::vector<RedactionRule> rules = {
+        {"password=", RedactionRule::Kind::KEY_VALUE},
+        {"token=", RedactionRule::Kind::KEY_VALUE},
+        {"hunter2", RedactionRule::Kind::LITERAL},
+    };
+    return std::make_shared<const RedactionMatcher>(std::move(rules));
+}
+
+/**
+ * @brief 上下文的键按"键=值"匹配键规则，值中的敏感内容同样打码，未命中的条目原样保留
+ */
+void testContextValuesAreRedacted() {
+    std::vector<std::string> lines;
+    RedactionDecorator decorator(std::make_unique<CaptureOutput>(lines), makeMatcher());
+
+    LogMessage msg;
+    {
+        LOG_CONTEXT("tenant", "acme");
+        LOG_CONTEXT("password", "swordfish");
+        LOG_CONTEXT("note", "retry token=abc123");
+        LOG_CONTEXT("requestId", "42");
+        msg.assign(LogLevel::INFO, "login password=hunter2");
+    }
+
+    decorator.write(msg);
+    std::pmr::string formatted;
+    TEST_CHECK(decorator.format(msg, formatted));
+
+    const std::string expected =
+        "login password=******* {tenant=acme password=********* note=retry token=****** requestId=42}";
+    TEST_CHECK(lines.size() == 1);
+    TEST_CHECK(!lines.empty() && lines[0] == expected);
+    TEST_CHECK(std::string(formatted) == expected);
+
+    // 原消息和共享的上下文节点不被修改
+    TEST_CHECK(msg.getMessage() == "login password=hunter2");
+    TEST_CHECK(LogContext::toString(msg.context) ==
+               "{tenant=acme password=swordfish note=retry token=abc123 requestId=42}");
+}
+
+/**
+ * @brief 只有上下文命中时消息内容不变，没有任何命中时直接转发
+ */
+void testContextOnlyAndCleanMessages() {
+    std::vector<std::string> lines;
+    RedactionDecorator decorator(std::make_unique<CaptureOutput>(lines), makeMatcher());
+
+    {
+        LOG_CONTEXT("user", "hunter2");
+        LogMessage msg;
+        msg.assign(LogLevel::INFO, "signed in");
+        decorator.write(msg);
+    }
+    {
+        LOG_CONTEXT("user", "alice");
+        LogMessage msg;
+        msg.assign(LogLevel::INFO, "signed in");
+        decorator.write(msg);
+    }
+
+    TEST_CHECK(lines.size() == 2);
+    TEST_CHECK(lines.size() == 2 && lines[0] == "signed in {user=*******}");
+    TEST_CHECK(lines.size() == 2 && lines[1] == "signed in {user=alice}");
+}
+
+} // namespace
+
+int main() {
+    testContextValuesAreRedacted();
+    testContextOnlyAndCleanMessages();
+    return test::testResult();
+}
@@ -0,0 +1,54 @@
+/**
+ * @file testSupport.hpp
+ * @brief 测试辅助宏
+ * @author Gamma
+ * @date 2026-10-18 10:00:00
+ * @version 1.1.0
+ * @details 不依赖测试框架的最小断言：失败时打印位置并把测试标记为失败，由main()返回testResult()
+ * @since 1.1.0
+ */
+
+#pragma once
+
+#include <cstdio>
+
+namespace async_log {
+namespace test {
+
+/**
+ * @brief 获取失败的断言数量
+ * @return 计数器引用
+ * @since 1.1.0
+ */
+inline int& failureCount() {
+    static int failures = 0;
+    return failures;
+}
+
+/**
+ * @brief 获取测试进程的退出码
+ * @return 0表示全部通过
+ * @since 1.1.0
+ */
+inline int testResult() {
+    if (failureCount() > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failureCount());
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace test
+} // namespace async_log
+
+/**
+ * @brief 检查条件，失败时记录并继续执行
+ * @since 1.1.0
+ */
+#define TEST_CHECK(condition)                                                           \
+    do {                                                                                \
+        if (!(condition)) {                                                             \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ::async_log::test::failureCount()++;                                        \
+        }                                                                               \
+    } while (0)